@@ -0,0 +1,105 @@
+// BigInt 微基准：64 位 limb 的 BigInt 与旧版十进制 DecimalBigInt 对比。
+// 用法：bigint_bench [位数...]，默认 10 1000 100000。
+// 旧版 Karatsuba 对较长的操作数会算错，两者结果不同时只做标注；BigInt 自身的除法校验失败时返回非零
+#include "bigint.hpp"
+#include "bigint_decimal.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+// 旧版除法逐位反复相减，超过该位数时不再测量
+constexpr size_t decimal_division_limit = 10000;
+
+std::string random_digits(size_t n, std::mt19937_64& rng) {
+    std::string s(n, '0');
+    std::uniform_int_distribution<int> digit(0, 9);
+    for (auto& c: s) c = static_cast<char>('0' + digit(rng));
+    s[0] = static_cast<char>('1' + digit(rng) % 9);
+    return s;
+}
+
+// 每次调用的平均耗时（微秒）；至少运行 0.2 秒或 1 次
+double time_us(const std::function<void()>& op) {
+    using clock = std::chrono::steady_clock;
+    const auto start = clock::now();
+    size_t runs = 0;
+    double elapsed;
+    do {
+        op();
+        ++runs;
+        elapsed = std::chrono::duration<double, std::micro>(clock::now() - start).count();
+    } while (elapsed < 2e5);
+    return elapsed / static_cast<double>(runs);
+}
+
+struct Case {
+    const char* name;
+    std::function<void()> limb;
+    std::function<void()> decimal;// 为空表示旧版太慢不测
+};
+
+bool run(size_t digits) {
+    std::mt19937_64 rng(digits);
+    const std::string sa = random_digits(digits, rng);
+    const std::string sb = random_digits(digits, rng);
+    const std::string sd = random_digits(std::max<size_t>(1, digits / 2), rng);
+    const BigInt a(sa), b(sb), d(sd);
+    const DecimalBigInt da(sa), db(sb), dd(sd);
+
+    // 计时只包含运算本身，结果在计时结束后转成字符串比对
+    BigInt lr;
+    DecimalBigInt dr;
+    std::string ls, ds;
+    std::vector<Case> cases = {
+            {"parse", [&] { lr = BigInt(sa); }, [&] { dr = DecimalBigInt(sa); }},
+            {"to_string", [&] { ls = a.to_string(); }, [&] { ds = da.to_string(); }},
+            {"add", [&] { lr = a + b; }, [&] { dr = da + db; }},
+            {"sub", [&] { lr = b - a; }, [&] { dr = db - da; }},
+            {"mul", [&] { lr = a * b; }, [&] { dr = da * db; }},
+            {"div", [&] { lr = a / d; }, nullptr},
+            {"mod", [&] { lr = a % d; }, nullptr},
+    };
+    if (digits <= decimal_division_limit) {
+        cases[5].decimal = [&] { dr = da / dd; };
+        cases[6].decimal = [&] { dr = da % dd; };
+    }
+
+    bool ok = true;
+    for (const auto& c: cases) {
+        ls.clear();
+        ds.clear();
+        const double lt = time_us(c.limb);
+        if (c.decimal) {
+            const double dt = time_us(c.decimal);
+            const bool same = ls.empty() ? lr.to_string() == dr.to_string() : ls == ds;
+            std::printf("%9zu  %-10s %14.2f %14.2f %9.1fx%s\n", digits, c.name, lt, dt, dt / lt, same ? "" : "  (results differ)");
+        } else {
+            std::printf("%9zu  %-10s %14.2f %14s %10s\n", digits, c.name, lt, "-", "-");
+        }
+    }
+    // 旧版不测的除法用恒等式 a = (a / d)·d + a % d 校验
+    if ((a / d) * d + a % d != a) {
+        std::printf("%9zu  %-10s MISMATCH\n", digits, "divmod");
+        ok = false;
+    }
+    return ok;
+}
+}// namespace
+
+int main(int argc, char** argv) {
+    std::vector<size_t> sizes;
+    for (int i = 1; i < argc; ++i) sizes.push_back(std::strtoull(argv[i], nullptr, 10));
+    if (sizes.empty()) sizes = {10, 1000, 100000};
+
+    std::printf("%9s  %-10s %14s %14s %10s\n", "digits", "op", "limb (us)", "decimal (us)", "speedup");
+    bool ok = true;
+    for (size_t n: sizes) ok = run(n) && ok;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,256 @@
+// AST 节点分派微基准：按 NodeKind 的 switch 与旧版逐个 dynamic_cast 的 if 链对比。
+// 用法：dispatch_bench [脚本.lm]，默认使用内置的循环脚本。
+// 先解析脚本并按先序收集全部节点，再反复对每个节点分派到同一组处理函数，
+// 两种方式只有分派不同；旧版的 if 链按原 Interpreter::execute / eval 的顺序排列
+#include "parser.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+// 默认脚本：while 循环每轮约 15 个节点，外加递归的 fib
+const char* default_script = R"(
+var i = 0;
+var sum = 0;
+while (i < 200000) {
+    var x = i * 2 + 1;
+    if (x > 100) { sum = sum + x; } else { sum = sum - 1; }
+    i = i + 1;
+}
+func fib(n) {
+    if (n < 2) { return n; }
+    return fib(n - 1) + fib(n - 2);
+}
+print(sum, fib(20));
+)";
+
+// 每次调用的平均耗时（微秒）；至少运行 0.2 秒或 1 次
+double time_us(const std::function<void()>& op) {
+    using clock = std::chrono::steady_clock;
+    const auto start = clock::now();
+    size_t runs = 0;
+    double elapsed;
+    do {
+        op();
+        ++runs;
+        elapsed = std::chrono::duration<double, std::micro>(clock::now() - start).count();
+    } while (elapsed < 2e5);
+    return elapsed / static_cast<double>(runs);
+}
+
+// 先序收集节点
+void collect(const ASTNode* n, std::vector<const ASTNode*>& out) {
+    if (!n) return;
+    out.push_back(n);
+    auto list = [&out](const auto& nodes) {
+        for (const auto& child: nodes) collect(child.get(), out);
+    };
+    switch (n->kind) {
+        case NodeKind::BinaryExpr: {
+            auto* bin = static_cast<const BinaryExpr*>(n);
+            collect(bin->left.get(), out);
+            collect(bin->right.get(), out);
+            break;
+        }
+        case NodeKind::UnaryExpr:
+            collect(static_cast<const UnaryExpr*>(n)->operand.get(), out);
+            break;
+        case NodeKind::CallExpr:
+            list(static_cast<const CallExpr*>(n)->args);
+            break;
+        case NodeKind::NamespaceCallExpr:
+            list(static_cast<const NamespaceCallExpr*>(n)->args);
+            break;
+        case NodeKind::ArrayExpr:
+            list(static_cast<const ArrayExpr*>(n)->elements);
+            break;
+        case NodeKind::VarDeclStmt:
+            collect(static_cast<const VarDeclStmt*>(n)->expr.get(), out);
+            break;
+        case NodeKind::AssignStmt:
+            collect(static_cast<const AssignStmt*>(n)->expr.get(), out);
+            break;
+        case NodeKind::BlockStmt:
+            list(static_cast<const BlockStmt*>(n)->statements);
+            break;
+        case NodeKind::IfStmt: {
+            auto* ifs = static_cast<const IfStmt*>(n);
+            collect(ifs->condition.get(), out);
+            collect(ifs->thenBlock.get(), out);
+            collect(ifs->elseBlock.get(), out);
+            break;
+        }
+        case NodeKind::WhileStmt: {
+            auto* ws = static_cast<const WhileStmt*>(n);
+            collect(ws->condition.get(), out);
+            collect(ws->body.get(), out);
+            break;
+        }
+        case NodeKind::FuncDefStmt:
+            collect(static_cast<const FuncDefStmt*>(n)->body.get(), out);
+            break;
+        case NodeKind::ReturnStmt:
+            collect(static_cast<const ReturnStmt*>(n)->expr.get(), out);
+            break;
+        case NodeKind::ExprStmt:
+            collect(static_cast<const ExprStmt*>(n)->expr.get(), out);
+            break;
+        case NodeKind::StructDeclStmt:
+            for (const auto& [name, expr]: static_cast<const StructDeclStmt*>(n)->init_vec) collect(expr.get(), out);
+            break;
+        case NodeKind::DefineStmt:
+            collect(static_cast<const DefineStmt*>(n)->value.get(), out);
+            break;
+        case NodeKind::BigIntDeclStmt:
+            collect(static_cast<const BigIntDeclStmt*>(n)->init_value.get(), out);
+            break;
+        default:
+            break;
+    }
+}
+
+// 处理函数：读取节点自身的字段，两种分派共用
+size_t on_name(const std::string& name) { return name.size(); }
+size_t on_literal(const LiteralExpr* n) { return static_cast<size_t>(n->type) + n->value.size(); }
+size_t on_binary(const BinaryExpr* n) { return static_cast<size_t>(n->op) + 1; }
+size_t on_unary(const UnaryExpr* n) { return static_cast<size_t>(n->op) + 2; }
+size_t on_call(const CallExpr* n) { return n->callee.size() + n->args.size(); }
+size_t on_array(const ArrayExpr* n) { return n->elements.size(); }
+size_t on_block(const BlockStmt* n) { return n->statements.size(); }
+size_t on_if(const IfStmt* n) { return n->elseBlock ? 2 : 1; }
+size_t on_while(const WhileStmt* n) { return n->body ? 3 : 0; }
+size_t on_return(const ReturnStmt* n) { return n->tail_call ? 5 : 4; }
+
+size_t dispatch_switch(const ASTNode* n) {
+    switch (n->kind) {
+        case NodeKind::LiteralExpr:
+            return on_literal(static_cast<const LiteralExpr*>(n));
+        case NodeKind::IdentifierExpr:
+            return on_name(static_cast<const IdentifierExpr*>(n)->name);
+        case NodeKind::VarExpr:
+            return on_name(static_cast<const VarExpr*>(n)->name);
+        case NodeKind::BinaryExpr:
+            return on_binary(static_cast<const BinaryExpr*>(n));
+        case NodeKind::UnaryExpr:
+            return on_unary(static_cast<const UnaryExpr*>(n));
+        case NodeKind::CallExpr:
+            return on_call(static_cast<const CallExpr*>(n));
+        case NodeKind::ArrayExpr:
+            return on_array(static_cast<const ArrayExpr*>(n));
+        case NodeKind::VarDeclStmt:
+            return on_name(static_cast<const VarDeclStmt*>(n)->name);
+        case NodeKind::DefineStmt:
+            return on_name(static_cast<const DefineStmt*>(n)->name);
+        case NodeKind::BigIntDeclStmt:
+            return on_name(static_cast<const BigIntDeclStmt*>(n)->name);
+        case NodeKind::AssignStmt:
+            return on_name(static_cast<const AssignStmt*>(n)->name);
+        case NodeKind::StructDeclStmt:
+            return on_name(static_cast<const StructDeclStmt*>(n)->name);
+        case NodeKind::IfStmt:
+            return on_if(static_cast<const IfStmt*>(n));
+        case NodeKind::WhileStmt:
+            return on_while(static_cast<const WhileStmt*>(n));
+        case NodeKind::FuncDefStmt:
+            return on_name(static_cast<const FuncDefStmt*>(n)->name);
+        case NodeKind::BlockStmt:
+            return on_block(static_cast<const BlockStmt*>(n));
+        case NodeKind::ReturnStmt:
+            return on_return(static_cast<const ReturnStmt*>(n));
+        case NodeKind::IncludeStmt:
+            return on_name(static_cast<const IncludeStmt*>(n)->module);
+        case NodeKind::BreakStmt:
+        case NodeKind::ContinueStmt:
+        case NodeKind::ExprStmt:
+        case NodeKind::NullStmt:
+        case NodeKind::NamespaceCallExpr:
+            return 1;
+    }
+    return 0;
+}
+
+// 旧版：语句与表达式各自一条 dynamic_cast 链，顺序与原实现相同
+size_t dispatch_dynamic_cast(const ASTNode* n) {
+    if (auto* s = dynamic_cast<const Statement*>(n)) {
+        if (auto* v = dynamic_cast<const VarDeclStmt*>(s)) return on_name(v->name);
+        if (auto* d = dynamic_cast<const DefineStmt*>(s)) return on_name(d->name);
+        if (auto* bi = dynamic_cast<const BigIntDeclStmt*>(s)) return on_name(bi->name);
+        if (auto* a = dynamic_cast<const AssignStmt*>(s)) return on_name(a->name);
+        if (auto* st = dynamic_cast<const StructDeclStmt*>(s)) return on_name(st->name);
+        if (auto* ifs = dynamic_cast<const IfStmt*>(s)) return on_if(ifs);
+        if (auto* ws = dynamic_cast<const WhileStmt*>(s)) return on_while(ws);
+        if (auto* func = dynamic_cast<const FuncDefStmt*>(s)) return on_name(func->name);
+        if (auto* block = dynamic_cast<const BlockStmt*>(s)) return on_block(block);
+        if (auto* ret = dynamic_cast<const ReturnStmt*>(s)) return on_return(ret);
+        if (dynamic_cast<const BreakStmt*>(s)) return 1;
+        if (dynamic_cast<const ContinueStmt*>(s)) return 1;
+        if (auto* inc = dynamic_cast<const IncludeStmt*>(s)) return on_name(inc->module);
+        if (dynamic_cast<const ExprStmt*>(s)) return 1;
+        if (dynamic_cast<const NullStmt*>(s)) return 1;
+        return 0;
+    }
+    if (auto* lit = dynamic_cast<const LiteralExpr*>(n)) return on_literal(lit);
+    if (auto* id = dynamic_cast<const IdentifierExpr*>(n)) return on_name(id->name);
+    if (auto* var = dynamic_cast<const VarExpr*>(n)) return on_name(var->name);
+    if (auto* bin = dynamic_cast<const BinaryExpr*>(n)) return on_binary(bin);
+    if (auto* unary = dynamic_cast<const UnaryExpr*>(n)) return on_unary(unary);
+    if (auto* call = dynamic_cast<const CallExpr*>(n)) return on_call(call);
+    if (auto* arr = dynamic_cast<const ArrayExpr*>(n)) return on_array(arr);
+    return 1;
+}
+
+}// namespace
+
+int main(int argc, char** argv) {
+    auto source = std::make_shared<std::string>(default_script);
+    if (argc > 1) {
+        std::ifstream in(argv[1], std::ios::binary);
+        if (!in) {
+            std::fprintf(stderr, "cannot open %s\n", argv[1]);
+            return 1;
+        }
+        source = std::make_shared<std::string>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    SyntaxTree tree = Parser::parse_tree(source, *source);
+    if (!tree.root) {
+        std::fprintf(stderr, "parse failed\n");
+        return 1;
+    }
+    std::vector<const ASTNode*> nodes;
+    collect(tree.root.get(), nodes);
+
+    // 结果累加到 volatile 中，防止分派被整体优化掉
+    volatile size_t sink = 0;
+    size_t switch_sum = 0, cast_sum = 0;
+    const double switch_us = time_us([&] {
+        size_t sum = 0;
+        for (const ASTNode* n: nodes) sum += dispatch_switch(n);
+        switch_sum = sum;
+        sink = sink + sum;
+    });
+    const double cast_us = time_us([&] {
+        size_t sum = 0;
+        for (const ASTNode* n: nodes) sum += dispatch_dynamic_cast(n);
+        cast_sum = sum;
+        sink = sink + sum;
+    });
+
+    const double per_node = 1000.0 / static_cast<double>(nodes.size());
+    std::printf("%zu nodes\n", nodes.size());
+    std::printf("%-14s %12s %12s\n", "dispatch", "ns/node", "speedup");
+    std::printf("%-14s %12.2f %12s\n", "dynamic_cast", cast_us * per_node, "1.0x");
+    std::printf("%-14s %12.2f %11.1fx\n", "switch", switch_us * per_node, cast_us / switch_us);
+    // 两种分派必须落到同一组处理函数
+    if (switch_sum != cast_sum) {
+        std::printf("MISMATCH: %zu vs %zu\n", switch_sum, cast_sum);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,87 @@
+// 词法分析吞吐量微基准：生成约 50 MB 的脚本，测量 Lexer::tokenize 的 MB/s。
+// 用法：lexer_bench [MB] [--write 文件]，默认 50；--write 同时把生成的脚本写入文件，可用于测量完整的解析与执行。
+// 脚本由函数定义、关键字、标识符、带下划线的数字、含转义的字符串、运算符和注释组成，取 5 次中最快的一次；
+// 出现 Unknown 记号或记号个数不稳定时返回非零
+#include "lexer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+namespace {
+constexpr int runs = 5;
+
+// 生成至少 bytes 字节的脚本；每段用不同的后缀编号，避免标识符全部相同
+std::string generate(size_t bytes) {
+    std::string src;
+    src.reserve(bytes + 1024);
+    for (size_t n = 0; src.size() < bytes; ++n) {
+        const std::string id = std::to_string(n);
+        src += "// block " + id + ": generated for lexer_bench\n";
+        src += "func compute_" + id + "(alpha, beta_value, gamma) {\n";
+        src += "    var total = 1_000_000 + alpha * 3.25 - beta_value / 7;\n";
+        src += "    bigint big_" + id + " = 123456789012345678901234567890 + 25!;\n";
+        src += "    var items = [1, 2.5, \"text\\twith\\nescapes\", true, false, null];\n";
+        src += "    while (total >= 0) {\n";
+        src += "        if (total % 2 == 0) { total = total - 1; continue; }\n";
+        src += "        else { total = (total ^ 2) - gamma; break; }\n";
+        src += "    }\n";
+        src += "    define limit_" + id + " 42;\n";
+        src += "    if (gamma != 1) { return alpha <= total; }\n";
+        src += "    return -(total - gamma);\n";
+        src += "}\n";
+        src += "print(\"result \" + compute_" + id + "(" + id + ", 2, 3), sqrt(2));\n";
+    }
+    return src;
+}
+
+}// namespace
+
+int main(int argc, char** argv) {
+    size_t megabytes = 50;
+    const char* write_path = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--write" && i + 1 < argc) write_path = argv[++i];
+        else megabytes = std::strtoull(argv[i], nullptr, 10);
+    }
+
+    const std::string src = generate(megabytes << 20);
+    if (write_path) {
+        std::ofstream out(write_path, std::ios::binary);
+        out << src;
+        if (!out) {
+            std::fprintf(stderr, "cannot write %s\n", write_path);
+            return 1;
+        }
+    }
+
+    using clock = std::chrono::steady_clock;
+    double best = 1e300;
+    size_t tokens = 0;
+    bool ok = true;
+    for (int run = 0; run < runs; ++run) {
+        const auto start = clock::now();
+        const TokenList list = Lexer::tokenize(src);
+        best = std::min(best, std::chrono::duration<double>(clock::now() - start).count());
+
+        if (run > 0 && list.tokens.size() != tokens) ok = false;
+        tokens = list.tokens.size();
+        if (std::any_of(list.tokens.begin(), list.tokens.end(), [](const Token& t) { return t.type == TokenType::Unknown; })) ok = false;
+    }
+
+    const double mb = static_cast<double>(src.size()) / (1 << 20);
+    std::printf("%-12s %10.1f\n", "source (MB)", mb);
+    std::printf("%-12s %10zu\n", "tokens", tokens);
+    std::printf("%-12s %10.1f\n", "best (ms)", best * 1e3);
+    std::printf("%-12s %10.1f\n", "MB/s", mb / best);
+    std::printf("%-12s %10.1f\n", "Mtokens/s", tokens / best / 1e6);
+    if (!ok) {
+        std::printf("FAILED: unknown tokens or unstable token count\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,64 @@
+#!/bin/bash
+# 运行 benchmarks/scripts 下的 .lm 脚本并计时，每个脚本在各执行引擎上取 RUNS 次（默认 3）中最快的一次。
+# 用法：benchmarks/run_scripts.sh <lamina> [对比用的 lamina]
+# 列出树遍历解释器（ast）、闭包编译层（closure）和字节码虚拟机（vm）的耗时；
+# 第二个解释器（如旧版本的构建）给出时另起一列按默认引擎运行。所有输出须与 ast 一致
+
+if [ $# -lt 1 ]; then
+    echo "usage: $0 <lamina> [baseline-lamina]" >&2
+    exit 1
+fi
+
+SCRIPT_DIR=$(cd "$(dirname "${BASH_SOURCE[0]}")" &>/dev/null && pwd)
+LAMINA=$1
+BASELINE=$2
+RUNS=${RUNS:-3}
+ENGINES=(ast closure vm)
+# 不读写解析缓存，每次都包含解析时间
+export LAMINA_NO_CACHE=1
+TIMEFORMAT=%R
+
+# best_time <命令...>：输出最快一次的秒数；命令的输出写入 $OUT
+best_time() {
+    local best= t
+    for ((run = 0; run < RUNS; run++)); do
+        t=$( { time "$@" > "$OUT" 2>&1; } 2>&1 )
+        if [ -z "$best" ] || awk "BEGIN { exit !($t < $best) }"; then
+            best=$t
+        fi
+    done
+    echo "$best"
+}
+
+OUT=$(mktemp)
+REF_OUT=$(mktemp)
+trap 'rm -f "$OUT" "$REF_OUT"' EXIT
+status=0
+
+header=$(printf "%-16s" script)
+for engine in "${ENGINES[@]}"; do header+=$(printf " %10s" "$engine"); done
+[ -n "$BASELINE" ] && header+=$(printf " %10s" baseline)
+echo "$header"
+
+for script in "$SCRIPT_DIR"/scripts/*.lm; do
+    name=$(basename "$script" .lm)
+    line=$(printf "%-16s" "$name")
+    columns=("${ENGINES[@]}")
+    [ -n "$BASELINE" ] && columns+=(baseline)
+    for column in "${columns[@]}"; do
+        if [ "$column" = baseline ]; then
+            t=$(best_time "$BASELINE" "$script")
+        else
+            t=$(best_time "$LAMINA" "--engine=$column" "$script")
+        fi
+        line+=$(printf " %10s" "$t")
+        if [ "$column" = "${ENGINES[0]}" ]; then
+            cp "$OUT" "$REF_OUT"
+        elif ! cmp -s "$OUT" "$REF_OUT"; then
+            echo "$name: $column output differs from ${ENGINES[0]}" >&2
+            status=1
+        fi
+    done
+    echo "$line"
+done
+exit $status
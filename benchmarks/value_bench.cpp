@@ -0,0 +1,84 @@
+// Value 布局微基准：16 字节的 Value 与旧版内联 std::variant 的 LegacyValue 对比。
+// 用法：value_bench [元素个数]，默认 5000000。
+// 测量 sizeof、逐个 push_back 构造整数数组、按 is_int + get<int> 扫描求和 10 遍，以及整个数组的复制；
+// 两种布局的扫描结果不同时返回非零
+#include "value.hpp"
+#include "value_legacy.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+namespace {
+constexpr int scan_passes = 10;
+
+// 每次调用的平均耗时（微秒）；至少运行 0.2 秒或 1 次
+double time_us(const std::function<void()>& op) {
+    using clock = std::chrono::steady_clock;
+    const auto start = clock::now();
+    size_t runs = 0;
+    double elapsed;
+    do {
+        op();
+        ++runs;
+        elapsed = std::chrono::duration<double, std::micro>(clock::now() - start).count();
+    } while (elapsed < 2e5);
+    return elapsed / static_cast<double>(runs);
+}
+
+template<typename V>
+std::vector<V> build(size_t n) {
+    std::vector<V> arr;
+    for (size_t i = 0; i < n; ++i) arr.push_back(V(static_cast<int>(i % 1000)));
+    return arr;
+}
+
+template<typename V>
+long long scan(const std::vector<V>& arr) {
+    long long sum = 0;
+    for (int pass = 0; pass < scan_passes; ++pass) {
+        for (const V& v: arr) {
+            if (v.is_int()) sum += v.template get<int>();
+        }
+    }
+    return sum;
+}
+
+}// namespace
+
+int main(int argc, char** argv) {
+    const size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 5000000;
+
+    std::printf("%-22s %12s %12s\n", "", "Value", "LegacyValue");
+    std::printf("%-22s %12zu %12zu\n", "sizeof (bytes)", sizeof(Value), sizeof(LegacyValue));
+    std::printf("%-22s %12.1f %12.1f\n", "array (MB)", n * sizeof(Value) / 1e6, n * sizeof(LegacyValue) / 1e6);
+
+    // 结果写入 volatile 中，防止计算被整体优化掉
+    volatile long long sink = 0;
+    const double build_new = time_us([&] { sink = sink + static_cast<long long>(build<Value>(n).size()); });
+    const double build_old = time_us([&] { sink = sink + static_cast<long long>(build<LegacyValue>(n).size()); });
+
+    const std::vector<Value> arr = build<Value>(n);
+    const std::vector<LegacyValue> legacy = build<LegacyValue>(n);
+    long long sum_new = 0, sum_old = 0;
+    const double scan_new = time_us([&] { sum_new = scan(arr); });
+    const double scan_old = time_us([&] { sum_old = scan(legacy); });
+    const double copy_new = time_us([&] { sink = sink + static_cast<long long>(std::vector<Value>(arr).size()); });
+    const double copy_old = time_us([&] { sink = sink + static_cast<long long>(std::vector<LegacyValue>(legacy).size()); });
+
+    std::printf("%-22s %12s %12s %8s\n", "(ms)", "Value", "LegacyValue", "speedup");
+    auto row = [](const char* name, double now, double old) {
+        std::printf("%-22s %12.2f %12.2f %7.1fx\n", name, now / 1e3, old / 1e3, old / now);
+    };
+    row("build (push_back)", build_new, build_old);
+    row("scan x10", scan_new, scan_old);
+    row("copy", copy_new, copy_old);
+
+    if (sum_new != sum_old) {
+        std::printf("MISMATCH: %lld vs %lld\n", sum_new, sum_old);
+        return 1;
+    }
+    return 0;
+}
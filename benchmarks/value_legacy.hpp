@@ -0,0 +1,68 @@
+#pragma once
+// 旧版 Value 的内存布局（虚析构函数、type 字段加内联全部负载的 std::variant），仅作为 value_bench 的对照。
+// BigInt、Rational、Irrational 按当时的成员布局复刻，只保留扫描数组用到的接口
+#include "bigint_decimal.hpp"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+class SymbolicExpr;
+class lStruct;
+
+struct LegacyRational {
+    DecimalBigInt numerator;
+    DecimalBigInt denominator;
+};
+
+struct LegacyIrrational {
+    enum class Type { SQRT, PI, E, LOG, COMPLEX } type;
+    double coefficient;
+    long long radicand;
+    std::map<std::string, double> coefficients;
+    double constant_term;
+};
+
+class LegacyValue {
+public:
+    enum class Type { Null,
+                      Infinity,
+                      Bool,
+                      Int,
+                      Float,
+                      String,
+                      Array,
+                      Matrix,
+                      BigInt,
+                      Rational,
+                      Irrational,
+                      lStruct,
+                      Symbolic };
+    Type type;
+
+    using DataType = std::variant<
+            std::nullptr_t,
+            bool, int, double, std::string,
+            std::vector<LegacyValue>,
+            std::vector<std::vector<LegacyValue>>,
+            std::vector<std::pair<std::string, LegacyValue>>,
+            DecimalBigInt, LegacyRational, LegacyIrrational,
+            std::shared_ptr<SymbolicExpr>,
+            std::shared_ptr<lStruct>>;
+    DataType data;
+
+    virtual ~LegacyValue() = default;
+
+    LegacyValue() : type(Type::Null), data(std::in_place_index<0>, nullptr) {}
+    LegacyValue(int i) : type(Type::Int), data(std::in_place_index<2>, i) {}
+    LegacyValue(double f) : type(Type::Float), data(std::in_place_index<3>, f) {}
+    LegacyValue(const std::string& s) : type(Type::String), data(s) {}
+    // 与旧版相同：声明了虚析构函数，没有隐式移动构造，vector 扩容时逐个复制
+
+    bool is_int() const { return type == Type::Int; }
+    template<typename T>
+    const T& get() const { return std::get<T>(data); }
+};
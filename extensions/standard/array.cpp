@@ -4,13 +4,13 @@ Value range(const std::vector<Value>& args) {
     if (args.empty()) return LAMINA_NULL;
 
     const int start = args.size() > 1
-                              ? std::get<int>(args[0].data)
+                              ? args[0].get<int>()
                               : 0;
     const int end = args.size() > 1
-                            ? std::get<int>(args[1].data)
-                            : std::get<int>(args[0].data);
+                            ? args[1].get<int>()
+                            : args[0].get<int>();
     const int sep = args.size() > 2
-                            ? std::get<int>(args[2].data)
+                            ? args[2].get<int>()
                             : 1;
     std::vector<Value> vec;
     for (auto i = start; i < end; i += sep) {
@@ -32,14 +32,14 @@ Value visit_array_by_int(const std::vector<Value>& args) {
             L_ERR("Index argument must be an integer");
             return LAMINA_NULL;
         }
-        int index = std::get<int>(args[i].data);
+        int index = args[i].get<int>();
 
         if (!current->is_array()) {
             L_ERR("Cannot index non-array value at level " + std::to_string(i));
             return LAMINA_NULL;
         }
 
-        const auto& arr = std::get<std::vector<Value>>(current->data);
+        const auto& arr = current->get<std::vector<Value>>();
 
         if (index < 0 || static_cast<size_t>(index) >= arr.size()) {
             L_ERR("Array Index Out Of Range at level " + std::to_string(i));
@@ -58,8 +58,8 @@ Value visit_array_by_str(const std::vector<Value>& args) {
         return LAMINA_NULL;
     }
 
-    const std::string target_key = std::get<std::string>(args[1].data);
-    const auto& arr = std::get<std::vector<Value>>(args[0].data);
+    const std::string target_key = args[1].get<std::string>();
+    const auto& arr = args[0].get<std::vector<Value>>();
     Value result = LAMINA_NULL;
     bool found = false;
 
@@ -73,7 +73,7 @@ Value visit_array_by_str(const std::vector<Value>& args) {
 
             if (!key_elem.is_string()) continue;
 
-            const std::string current_key = std::get<std::string>(key_elem.data);
+            const std::string current_key = key_elem.get<std::string>();
             if (current_key == target_key) {
                 result = value_elem;
                 found = true;
@@ -18,11 +18,11 @@ static std::map<std::string, ExprPtr> stored_expressions;
 // 辅助函数：将Lamina Value转换为Expression
 ExprPtr valueToExpression(const Value& value) {
     if (value.is_int()) {
-        return std::make_unique<Number>(static_cast<double>(std::get<int>(value.data)));
+        return std::make_unique<Number>(static_cast<double>(value.get<int64_t>()));
     } else if (value.is_float()) {
-        return std::make_unique<Number>(std::get<double>(value.data));
+        return std::make_unique<Number>(value.get<double>());
     } else if (value.is_string()) {
-        std::string str = std::get<std::string>(value.data);
+        std::string str = value.get<std::string>();
         try {
             Parser parser(str);
             return parser.parse();
@@ -51,7 +51,7 @@ Value cas_parse(const std::vector<Value>& args) {
     }
 
     try {
-        std::string expr_str = std::get<std::string>(args[0].data);
+        std::string expr_str = args[0].get<std::string>();
         Parser parser(expr_str);
         auto expr = parser.parse();
         auto simplified = expr->simplify();
@@ -86,7 +86,7 @@ Value cas_differentiate(const std::vector<Value>& args) {
 
     try {
         auto expr = valueToExpression(args[0]);
-        std::string variable = std::get<std::string>(args[1].data);
+        std::string variable = args[1].get<std::string>();
         auto derivative = expr->differentiate(variable);
         auto simplified = derivative->simplify();
         return expressionToValue(*simplified);
@@ -109,7 +109,7 @@ Value cas_evaluate(const std::vector<Value>& args) {
         // 处理变量赋值
         for (size_t i = 1; i < args.size(); i++) {
             if (args[i].is_string()) {
-                std::string assignment = std::get<std::string>(args[i].data);
+                std::string assignment = args[i].get<std::string>();
                 size_t eq_pos = assignment.find('=');
                 if (eq_pos != std::string::npos) {
                     std::string var_name = assignment.substr(0, eq_pos);
@@ -136,7 +136,7 @@ Value cas_store(const std::vector<Value>& args) {
     }
 
     try {
-        std::string name = std::get<std::string>(args[0].data);
+        std::string name = args[0].get<std::string>();
         auto expr = valueToExpression(args[1]);
         stored_expressions[name] = std::move(expr);
         return Value("Expression stored as: " + name);
@@ -154,7 +154,7 @@ Value cas_load(const std::vector<Value>& args) {
     }
 
     try {
-        std::string name = std::get<std::string>(args[0].data);
+        std::string name = args[0].get<std::string>();
         auto it = stored_expressions.find(name);
         if (it != stored_expressions.end()) {
             return expressionToValue(*it->second);
@@ -176,13 +176,13 @@ Value cas_evaluate_at(const std::vector<Value>& args) {
 
     try {
         auto expr = valueToExpression(args[0]);
-        std::string variable = std::get<std::string>(args[1].data);
+        std::string variable = args[1].get<std::string>();
 
         double point;
         if (args[2].is_int()) {
-            point = static_cast<double>(std::get<int>(args[2].data));
+            point = static_cast<double>(args[2].get<int64_t>());
         } else if (args[2].is_float()) {
-            point = std::get<double>(args[2].data);
+            point = args[2].get<double>();
         } else {
             throw std::runtime_error("Point must be a number");
         }
@@ -205,7 +205,7 @@ Value cas_solve_linear(const std::vector<Value>& args) {
 
     try {
         auto expr = valueToExpression(args[0]);
-        std::string variable = std::get<std::string>(args[1].data);
+        std::string variable = args[1].get<std::string>();
 
         // 简单的线性方程求解：ax + b = 0 的解为 x = -b/a
         // 计算 f(0) 和 f(1) 来估算线性系数
@@ -244,13 +244,13 @@ Value cas_numerical_derivative(const std::vector<Value>& args) {
 
     try {
         auto expr = valueToExpression(args[0]);
-        std::string variable = std::get<std::string>(args[1].data);
+        std::string variable = args[1].get<std::string>();
         double point;
 
         if (args[2].is_int()) {
-            point = static_cast<double>(std::get<int>(args[2].data));
+            point = static_cast<double>(args[2].get<int64_t>());
         } else if (args[2].is_float()) {
-            point = std::get<double>(args[2].data);
+            point = args[2].get<double>();
         } else {
             throw std::runtime_error("Point must be a number");
         }
@@ -3,10 +3,28 @@
 
 Value __hash_symbolic(const std::vector<Value>& args) {
 	auto hd = SymbolicExpr::HashData(args[0].as_symbolic());
-	std::vector<Value> val = {Value(hd.k), Value(hd.ksqrt), Value(BigInt(hd.hash)), Value(hd.hash_obj), Value(BigInt(hd.to_single_hash()))}; //???
-	return Value(val);
+	std::vector<Value> val = {Value(hd.k), Value(hd.ksqrt), Value(BigInt(static_cast<int>(hd.hash))), Value(hd.hash_obj), Value(BigInt(static_cast<int>(hd.to_single_hash())))}; //???
+	return Value(std::move(val));
 }
 
 namespace Lamina {
 	LAMINA_FUNC("__hash_symbolic", __hash_symbolic, 1);
+}
+
+// 调用帧分配区统计：[已分配帧数, 分配区的堆分配次数, 当前槽位容量]
+void __frame_arena_entry(Interpreter& interpreter);
+namespace {
+	struct __frame_arena_registrar {
+		__frame_arena_registrar() {
+			Interpreter::register_entry(&__frame_arena_entry);
+		}
+	} __frame_arena_instance;
+}
+
+void __frame_arena_entry(Interpreter& interpreter) {
+	interpreter.builtin_functions["__frame_arena"] = [&interpreter](const std::vector<Value>&) -> Value {
+		const FrameArena& arena = interpreter.get_frame_arena();
+		std::vector<Value> val = {Value(static_cast<int64_t>(arena.frames_allocated)), Value(static_cast<int64_t>(arena.allocations)), Value(static_cast<int64_t>(arena.values.capacity()))};
+		return Value(std::move(val));
+	};
 }
\ No newline at end of file
@@ -118,8 +118,8 @@ Value getattr_raw(const std::shared_ptr<lStruct>& lstruct_, const std::string& a
 }
 
 Value getattr(const std::vector<Value>& args) {
-    const auto& lstruct_ = std::get<std::shared_ptr<lStruct>>(args[0].data);
-    const auto& attr_name = std::get<std::string>(args[1].data);
+    const auto& lstruct_ = args[0].get<std::shared_ptr<lStruct>>();
+    const auto& attr_name = args[1].get<std::string>();
     return getattr_raw(lstruct_, attr_name);
 }
 
@@ -128,16 +128,16 @@ void setattr_raw(std::shared_ptr<lStruct> lstruct_, const std::string& attr_name
 }
 
 Value setattr(const std::vector<Value>& args) {
-    std::shared_ptr<lStruct> lstruct_ = std::get<std::shared_ptr<lStruct>>(args[0].data);
-    const auto& attr_name = std::get<std::string>(args[1].data);
+    std::shared_ptr<lStruct> lstruct_ = args[0].get<std::shared_ptr<lStruct>>();
+    const auto& attr_name = args[1].get<std::string>();
     Value value = args[2];
 	setattr_raw(lstruct_, attr_name, value);
     return LAMINA_NULL;
 }
 
 Value update(const std::vector<Value>& args) {
-    std::shared_ptr<lStruct> lstruct_a = std::get<std::shared_ptr<lStruct>>(args[0].data);
-    const auto& lstruct_b = std::get<std::shared_ptr<lStruct>>(args[1].data);
+    std::shared_ptr<lStruct> lstruct_a = args[0].get<std::shared_ptr<lStruct>>();
+    const auto& lstruct_b = args[1].get<std::shared_ptr<lStruct>>();
     auto vec = lstruct_b->to_vector();
     for (auto& [key, val]: vec) {
         lstruct_a->insert(key, val);
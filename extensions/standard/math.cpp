@@ -29,7 +29,7 @@ inline Value sqrt(const std::vector<Value>& args) {
 
     // Handle integer case - return symbolic result
     if (args[0].is_int()) {
-        int val = std::get<int>(args[0].data);
+        int val = args[0].get<int>();
         if (val == 0 || val == 1) {
             return Value(val);  // sqrt(0) = 0, sqrt(1) = 1
         }
@@ -48,7 +48,7 @@ inline Value sqrt(const std::vector<Value>& args) {
 
     // Handle BigInt case - return symbolic result
     if (args[0].is_bigint()) {
-        const auto& bi = std::get<::BigInt>(args[0].data);
+        const auto& bi = args[0].get<::BigInt>();
         if (bi.is_zero()) {
             return Value(0);
         }
@@ -66,7 +66,7 @@ inline Value sqrt(const std::vector<Value>& args) {
 
     // Handle rational case
     if (args[0].is_rational()) {
-        const auto& rat = std::get<::Rational>(args[0].data);
+        const auto& rat = args[0].get<::Rational>();
         auto num = rat.get_numerator();
         auto den = rat.get_denominator();
 
@@ -122,7 +122,7 @@ inline Value abs(const std::vector<Value>& args) {
 
     // Handle BigInt specifically
     if (args[0].is_bigint()) {
-        const auto& bigint_val = std::get<::BigInt>(args[0].data);
+        const auto& bigint_val = args[0].get<::BigInt>();
         return Value(bigint_val.abs());
     }
 
@@ -287,13 +287,13 @@ inline Value det(const std::vector<Value>& args) {
  */
 inline Value size(const std::vector<Value>& args) {
     if (args[0].is_array()) {
-        const auto& arr = std::get<std::vector<Value>>(args[0].data);
+        const auto& arr = args[0].get<std::vector<Value>>();
         return Value(static_cast<int>(arr.size()));
     } else if (args[0].is_matrix()) {
-        const auto& mat = std::get<std::vector<std::vector<Value>>>(args[0].data);
+        const auto& mat = args[0].get<Value::MatrixRows>();
         return Value(static_cast<int>(mat.size()));
     } else if (args[0].is_string()) {
-        const auto& str = std::get<std::string>(args[0].data);
+        const auto& str = args[0].get<std::string>();
         return Value(static_cast<int>(str.length()));
     }
     return Value(1);// Scalar values have size 1
@@ -338,7 +338,7 @@ inline Value fraction(const std::vector<Value>& args) {
     double val = args[0].as_number();
     try {
         Rational rat = Rational::from_double(val);
-        return Value(rat);
+        return Value(std::move(rat));
     } catch (const std::exception& e) {
         std::cerr << "Error: Cannot convert to fraction: " << e.what() << std::endl;
         return Value();
@@ -381,13 +381,13 @@ inline Value pow(const std::vector<Value>& args) {
 
     // Handle BigInt base with integer exponent
     if (args[0].is_bigint() && (args[1].is_int() || args[1].is_bigint())) {
-        const auto& base = std::get<::BigInt>(args[0].data);
+        const auto& base = args[0].get<::BigInt>();
 
         ::BigInt exponent;
         if (args[1].is_int()) {
-            exponent = ::BigInt(std::get<int>(args[1].data));
+            exponent = ::BigInt(args[1].get<int64_t>());
         } else {
-            exponent = std::get<::BigInt>(args[1].data);
+            exponent = args[1].get<::BigInt>();
         }
 
         try {
@@ -429,22 +429,25 @@ inline Value gcd(const std::vector<Value>& args) {
 
     // Handle BigInt case
     if (args[0].is_bigint() || args[1].is_bigint()) {
-        ::BigInt a = args[0].is_bigint() ? std::get<::BigInt>(args[0].data) : ::BigInt(std::get<int>(args[0].data));
-        ::BigInt b = args[1].is_bigint() ? std::get<::BigInt>(args[1].data) : ::BigInt(std::get<int>(args[1].data));
+        ::BigInt a = args[0].as_bigint();
+        ::BigInt b = args[1].as_bigint();
 
         return Value(::BigInt::gcd(a, b));
     }
 
     // Handle regular integer case
     if (args[0].is_int() && args[1].is_int()) {
-        int a = std::get<int>(args[0].data);
-        int b = std::get<int>(args[1].data);
+        int64_t a = args[0].get<int64_t>();
+        int64_t b = args[1].get<int64_t>();
+        if (a == INT64_MIN || b == INT64_MIN) {
+            return Value(::BigInt::gcd(::BigInt(a), ::BigInt(b)));
+        }
 
         // Simple GCD algorithm for integers
         a = std::abs(a);
         b = std::abs(b);
         while (b != 0) {
-            int temp = b;
+            int64_t temp = b;
             b = a % b;
             a = temp;
         }
@@ -483,31 +486,40 @@ inline Value lcm(const std::vector<Value>& args) {
 
     // Handle BigInt case
     if (args[0].is_bigint() || args[1].is_bigint()) {
-        ::BigInt a = args[0].is_bigint() ? std::get<::BigInt>(args[0].data) : ::BigInt(std::get<int>(args[0].data));
-        ::BigInt b = args[1].is_bigint() ? std::get<::BigInt>(args[1].data) : ::BigInt(std::get<int>(args[1].data));
+        ::BigInt a = args[0].as_bigint();
+        ::BigInt b = args[1].as_bigint();
 
         return Value(::BigInt::lcm(a, b));
     }
 
     // Handle regular integer case
     if (args[0].is_int() && args[1].is_int()) {
-        int a = std::abs(std::get<int>(args[0].data));
-        int b = std::abs(std::get<int>(args[1].data));
+        int64_t a = args[0].get<int64_t>();
+        int64_t b = args[1].get<int64_t>();
 
         if (a == 0 || b == 0) {
             return Value(0);
         }
+        if (a == INT64_MIN || b == INT64_MIN) {
+            return Value(::BigInt::lcm(::BigInt(a), ::BigInt(b)));
+        }
+        a = std::abs(a);
+        b = std::abs(b);
 
         // LCM = |a * b| / GCD(a, b)
-        int gcd_val = a;
-        int temp_b = b;
+        int64_t gcd_val = a;
+        int64_t temp_b = b;
         while (temp_b != 0) {
-            int temp = temp_b;
+            int64_t temp = temp_b;
             temp_b = gcd_val % temp_b;
             gcd_val = temp;
         }
 
-        return Value((a / gcd_val) * b);
+        int64_t result;
+        if (bigint_detail::mul_overflow(a / gcd_val, b, result)) {
+            return Value(::BigInt::lcm(::BigInt(a), ::BigInt(b)));
+        }
+        return Value(result);
     }
 
     // For floating point, warn about precision loss
@@ -51,5 +51,5 @@ Value randstr(const std::vector<Value>& args) {
         result += charset[dis(gen)];
     }
 
-    return LAMINA_STRING(result.c_str());
+    return Value(std::move(result));
 }
@@ -136,7 +136,7 @@ std::string Range::BasicRange::to_string() const {
 
 Range::Range(Value lamina_value) {
 	if (!lamina_value.is_lstruct()) return;
-	auto lamina_val = std::get<std::shared_ptr<lStruct> >(lamina_value.data);
+	auto lamina_val = lamina_value.get<std::shared_ptr<lStruct> >();
 	int sz = getattr_raw(lamina_val, "size").as_number();
 	for (int i = 1; i <= sz; i++) {
 		Value l = getattr_raw(lamina_val, "l_" + std::to_string(i));
@@ -161,7 +161,7 @@ Value Range::lamina() const {
 		tmp = Value(i.r_incl), ls->insert("r_inc_" + std::to_string(it), tmp);
 		it++;
 	}
-	return Value(ls);
+	return Value(std::move(ls));
 }
 	
 bool Range::in_range(const RangeValue& val) const {
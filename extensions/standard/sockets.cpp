@@ -289,7 +289,7 @@ namespace lamina::net {
 
         Socket* socket = it->second;
         std::string data = socket->get_queued_data();
-        return Value(data);
+        return Value(std::move(data));
     }
 
     Value socket_get_state(const std::vector<Value>& args) {
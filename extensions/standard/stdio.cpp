@@ -24,7 +24,7 @@ inline Value input(const std::vector<Value>& args) {
             }
         } catch (...) {
             // Return as string if not a number
-            return Value(input_line);
+            return Value(std::move(input_line));
         }
     }
 
@@ -111,7 +111,7 @@ inline Value file_get_content(const std::vector<Value>& args) {
         L_ERR("Failed to read from file: " + args[0].to_string());
     }
 
-    return Value(content);
+    return Value(std::move(content));
 }
 
 /**
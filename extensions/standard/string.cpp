@@ -4,17 +4,22 @@
  * 拼接多个字符串，并返回一个新字符串
  */
 Value concat(const std::vector<Value>& args) {
-    std::string str = "";
+    size_t total = 0;
     for (size_t i = 0; i < args.size(); i++) {
         if (!args[i].is_string()) {
             L_ERR("Args Must Be String");
             return LAMINA_NULL;
         }
-        const std::string arg_str = std::get<std::string>(args[i].data);
-        str += arg_str;
+        total += args[i].get<std::string>().size();
+    }
+    // 一次分配结果缓冲区，逐个追加时不再重复扩容
+    std::string str;
+    str.reserve(total);
+    for (const auto& arg: args) {
+        str += arg.get<std::string>();
     }
 
-    return Value(str);
+    return Value(std::move(str));
 }
 
 /**
@@ -30,8 +35,8 @@ Value char_at(const std::vector<Value>& args) {
         return LAMINA_NULL;
     }
 
-    const std::string str = std::get<std::string>(args[0].data);
-    const int index = std::get<int>(args[1].data);
+    const std::string str = args[0].get<std::string>();
+    const int index = args[1].get<int>();
 
     if (index < 0 || static_cast<size_t>(index) >= str.length()) {
         L_ERR("Char Index Out Of Range");
@@ -49,7 +54,7 @@ Value length(const std::vector<Value>& args) {
         return LAMINA_NULL;
     }
 
-    const std::string str = std::get<std::string>(args[0].data);
+    const std::string str = args[0].get<std::string>();
 
     return Value(static_cast<int>(str.length()));
 }
@@ -76,9 +81,9 @@ Value find(const std::vector<Value>& args) {
         return LAMINA_NULL;
     }
 
-    const std::string str = std::get<std::string>(args[0].data);
-    const int start_index = std::get<int>(args[1].data);
-    const std::string sub_str = std::get<std::string>(args[2].data);
+    const std::string str = args[0].get<std::string>();
+    const int start_index = args[1].get<int>();
+    const std::string sub_str = args[2].get<std::string>();
 
     if (start_index < 0 || static_cast<size_t>(start_index) >= str.length()) {
         L_ERR("Start Index Out Of Range");
@@ -113,9 +118,9 @@ Value sub_string(const std::vector<Value>& args) {
         return LAMINA_NULL;
     }
 
-    const std::string str = std::get<std::string>(args[0].data);
-    const int start_index = std::get<int>(args[1].data);
-    const int len = std::get<int>(args[2].data);
+    const std::string str = args[0].get<std::string>();
+    const int start_index = args[1].get<int>();
+    const int len = args[2].get<int>();
 
     if (start_index < 0 || static_cast<size_t>(start_index) >= str.length()) {
         L_ERR("Start Index Out Of Range");
@@ -123,7 +128,7 @@ Value sub_string(const std::vector<Value>& args) {
 
     std::string sub_str = str.substr(start_index, len);
 
-    return Value(sub_str);
+    return Value(std::move(sub_str));
 }
 
 /**
@@ -146,9 +151,9 @@ Value replace_by_index(const std::vector<Value>& args) {
         return LAMINA_NULL;
     }
 
-    const std::string str = std::get<std::string>(args[0].data);
-    const int start_index = std::get<int>(args[1].data);
-    const std::string sub_str = std::get<std::string>(args[2].data);
+    const std::string str = args[0].get<std::string>();
+    const int start_index = args[1].get<int>();
+    const std::string sub_str = args[2].get<std::string>();
 
     if (start_index < 0 || static_cast<size_t>(start_index) >= str.length()) {
         L_ERR("Start Index Out Of Range");
@@ -164,5 +169,5 @@ Value replace_by_index(const std::vector<Value>& args) {
     }
 
     std::string result_str = prefix + sub_str + sufix;
-    return Value(result_str);
+    return Value(std::move(result_str));
 }
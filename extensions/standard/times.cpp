@@ -17,7 +17,7 @@ Value get_date(const std::vector<Value>& /* args */) {
     oss << std::put_time(localTime, "%Y-%m-%d");
     std::string dateStr = oss.str();
 
-    return Value(dateStr);
+    return Value(std::move(dateStr));
 }
 
 Value get_format_date(const std::vector<Value>& args) {
@@ -67,5 +67,5 @@ Value get_format_date(const std::vector<Value>& args) {
     oss << std::put_time(localTime, stdFormat.c_str());
     std::string result = oss.str();
 
-    return Value(result);
+    return Value(std::move(result));
 }
@@ -0,0 +1,61 @@
+#include "ast.hpp"
+
+namespace {
+// 每块 64 KB，超过块大小的节点单独分配一块
+constexpr size_t arena_block_size = 64 * 1024;
+constexpr size_t node_alignment = alignof(std::max_align_t);
+
+thread_local AstArena* current_arena = nullptr;
+}// namespace
+
+void* AstArena::allocate(size_t size) {
+    size = (size + node_alignment - 1) & ~(node_alignment - 1);
+    if (size > left) {
+        const size_t block_size = size > arena_block_size ? size : arena_block_size;
+        // operator new[] 返回的内存满足 max_align_t 对齐
+        blocks.push_back({std::unique_ptr<std::byte[]>(new std::byte[block_size]), block_size});
+        next = blocks.back().data.get();
+        left = block_size;
+    }
+    void* p = next;
+    next += size;
+    left -= size;
+    used += size;
+    return p;
+}
+
+bool AstArena::owns(const void* p) const {
+    auto* b = static_cast<const std::byte*>(p);
+    for (const auto& block: blocks) {
+        if (b >= block.data.get() && b < block.data.get() + block.size) return true;
+    }
+    return false;
+}
+
+AstArena::Scope::Scope(AstArena& arena) : previous(current_arena) {
+    current_arena = &arena;
+}
+
+AstArena::Scope::~Scope() {
+    current_arena = previous;
+}
+
+AstArena* AstArena::current() {
+    return current_arena;
+}
+
+void* ASTNode::operator new(size_t size) {
+    if (current_arena) return current_arena->allocate(size);
+    return ::operator new(size);
+}
+
+void ASTNode::operator delete(ASTNode* node, std::destroying_delete_t) {
+    const bool in_arena = node->in_arena;
+    node->~ASTNode();
+    if (!in_arena) ::operator delete(node);
+}
+
+void ASTNode::operator delete(void* p) {
+    if (current_arena && current_arena->owns(p)) return;
+    ::operator delete(p);
+}
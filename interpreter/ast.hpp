@@ -1,78 +1,258 @@
 #pragma once
 #include "value.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <new>
 #include <string>
-#include "value.hpp"
+#include <string_view>
+#include <vector>
+
+struct ClosureBlock;
+
+// 节点类型标签，供解释器用 switch 分派，避免逐个 dynamic_cast
+enum class NodeKind : unsigned char {
+    // 表达式
+    LiteralExpr,
+    IdentifierExpr,
+    VarExpr,
+    BinaryExpr,
+    UnaryExpr,
+    CallExpr,
+    NamespaceCallExpr,
+    ArrayExpr,
+    // 语句
+    VarDeclStmt,
+    AssignStmt,
+    BlockStmt,
+    IfStmt,
+    WhileStmt,
+    FuncDefStmt,
+    ReturnStmt,
+    IncludeStmt,
+    NullStmt,
+    BreakStmt,
+    ContinueStmt,
+    ExprStmt,
+    StructDeclStmt,
+    DefineStmt,
+    BigIntDeclStmt
+};
+
+// Resolver 的绑定结果：Local 为当前函数帧的槽位，Global 为全局变量表下标。
+// Lamina 只有函数作用域，(depth, slot) 因此退化为局部/全局两种
+struct Binding {
+    enum class Scope : unsigned char {
+        Unresolved,
+        Local,
+        Global
+    };
+    Scope scope = Scope::Unresolved;
+    int index = -1;
+};
+
+// AST 节点的内存区：节点从大块内存中顺序切分，整体释放，同一棵树的节点在内存中相邻。
+// AstArena::Scope 存活期间，当前线程 new 出的 AST 节点都分配在该 arena 中
+class LAMINA_API AstArena {
+public:
+    AstArena() = default;
+    AstArena(const AstArena&) = delete;
+    AstArena& operator=(const AstArena&) = delete;
 
+    void* allocate(size_t size);
+    bool owns(const void* p) const;
+    size_t bytes_used() const { return used; }
+
+    class LAMINA_API Scope {
+    public:
+        explicit Scope(AstArena& arena);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        AstArena* previous;
+    };
+    // 当前线程生效的 arena，没有时为 nullptr
+    static AstArena* current();
+
+private:
+    struct Block {
+        std::unique_ptr<std::byte[]> data;
+        size_t size;
+    };
+    std::vector<Block> blocks;
+    std::byte* next = nullptr;
+    size_t left = 0;
+    size_t used = 0;
+};
+
+// 源码区间：字节偏移、长度和起始行号，指向 SyntaxTree::source
+struct SourceSpan {
+    uint32_t offset = 0;
+    uint32_t length = 0;
+    uint32_t line = 0;
+};
 
 // AST 基类
 struct ASTNode {
+    const NodeKind kind;
+    // 位于 AstArena 中的节点 delete 时只析构，内存随 arena 整体回收
+    const bool in_arena;
+    explicit ASTNode(NodeKind k) : kind(k), in_arena(AstArena::current() != nullptr) {}
     virtual ~ASTNode() = default;
+
+    static void* operator new(size_t size);
+    static void operator delete(ASTNode* node, std::destroying_delete_t);
+    // 仅在构造函数抛出异常时使用
+    static void operator delete(void* p);
 };
 
 // 表达式基类
 struct Expression : public ASTNode {
-    std::string source;// 保存表达式源码
+    SourceSpan span;// 表达式在源码中的位置
+    explicit Expression(NodeKind k) : ASTNode(k) {}
 };
 
 // 语句基类
-struct Statement : public ASTNode {};
+struct Statement : public ASTNode {
+    explicit Statement(NodeKind k) : ASTNode(k) {}
+};
 
 // 字面量
 struct LiteralExpr : public Expression {
     Value::Type type;
     std::string value;
-    LiteralExpr(const std::string& v, const Value::Type type) : type(type), value(v) {}
+    // 构造时预先解码的值；解码失败时 decoded 为 false，求值时再报错
+    Value cached;
+    bool decoded = false;
+    LiteralExpr(const std::string& v, const Value::Type type) : Expression(NodeKind::LiteralExpr), type(type), value(v) {
+        try {
+            cached = decode(value, type);
+            decoded = true;
+        } catch (const std::exception&) {
+        }
+    }
+    // 把字面量源码转换为 Value（定义于 eval.cpp）
+    static Value decode(const std::string& value, Value::Type type);
 };
 
 // 标识符
 struct IdentifierExpr : public Expression {
     std::string name;
-    explicit IdentifierExpr(const std::string& n) : name(n) {}
+    Binding binding;
+    explicit IdentifierExpr(const std::string& n) : Expression(NodeKind::IdentifierExpr), name(n) {}
 };
 
 // 变量引用
 struct VarExpr : public Expression {
     std::string name;
-    explicit VarExpr(const std::string& n) : name(n) {}
+    Binding binding;
+    explicit VarExpr(const std::string& n) : Expression(NodeKind::VarExpr), name(n) {}
+};
+
+// 二元运算符，比较运算符排在最后（见 is_comparison）
+enum class BinaryOp : unsigned char {
+    Add,
+    Sub,
+    Mul,
+    Div,
+    Mod,
+    Pow,
+    Eq,
+    Ne,
+    Lt,
+    Le,
+    Gt,
+    Ge
+};
+
+inline bool is_comparison(BinaryOp op) {
+    return op >= BinaryOp::Eq;
+}
+
+// 运算符文本，仅用于报错信息
+inline const char* binary_op_text(BinaryOp op) {
+    static const char* const text[] = {"+", "-", "*", "/", "%", "^", "==", "!=", "<", "<=", ">", ">="};
+    return text[static_cast<int>(op)];
+}
+
+// 一元运算符：前缀负号与后缀阶乘
+enum class UnaryOp : unsigned char {
+    Neg,
+    Fact
 };
 
+inline const char* unary_op_text(UnaryOp op) {
+    return op == UnaryOp::Neg ? "-" : "!";
+}
+
 // 二元运算
 struct BinaryExpr : public Expression {
-    std::string op;
+    BinaryOp op;
     std::unique_ptr<Expression> left, right;
-    BinaryExpr(const std::string& o, std::unique_ptr<Expression> l, std::unique_ptr<Expression> r)
-        : op(o), left(std::move(l)), right(std::move(r)) {}
+    BinaryExpr(BinaryOp o, std::unique_ptr<Expression> l, std::unique_ptr<Expression> r)
+        : Expression(NodeKind::BinaryExpr), op(o), left(std::move(l)), right(std::move(r)) {}
 };
 
 // 一元运算
 struct UnaryExpr : public Expression {
-    std::string op;
+    UnaryOp op;
     std::unique_ptr<Expression> operand;
-    UnaryExpr(const std::string& o, std::unique_ptr<Expression> e)
-        : op(o), operand(std::move(e)) {}
+    UnaryExpr(UnaryOp o, std::unique_ptr<Expression> e)
+        : Expression(NodeKind::UnaryExpr), op(o), operand(std::move(e)) {}
 };
 
 // 变量声明
 struct VarDeclStmt : public Statement {
     std::string name;
+    Binding binding;
     std::unique_ptr<Expression> expr;
     VarDeclStmt(const std::string& n, std::unique_ptr<Expression> e)
-        : name(n), expr(std::move(e)) {}
+        : Statement(NodeKind::VarDeclStmt), name(n), expr(std::move(e)) {}
 };
 
 // 赋值
 struct AssignStmt : public Statement {
     std::string name;
+    Binding binding;
     std::unique_ptr<Expression> expr;
     AssignStmt(const std::string& n, std::unique_ptr<Expression> e)
-        : name(n), expr(std::move(e)) {}
+        : Statement(NodeKind::AssignStmt), name(n), expr(std::move(e)) {}
+
+    // x = x + e1 + e2 ... 形式时按求值顺序返回 e1, e2 ...，供字符串、BigInt 原地累加使用；否则返回空
+    std::vector<const Expression*> append_operands() const {
+        std::vector<const Expression*> operands;
+        if (binding.scope == Binding::Scope::Unresolved) return operands;
+        const Expression* e = expr.get();
+        while (e && e->kind == NodeKind::BinaryExpr) {
+            auto* bin = static_cast<const BinaryExpr*>(e);
+            if (bin->op != BinaryOp::Add || !bin->right) return {};
+            operands.push_back(bin->right.get());
+            e = bin->left.get();
+        }
+        const Binding* b = nullptr;
+        const std::string* n = nullptr;
+        if (e && e->kind == NodeKind::IdentifierExpr) {
+            auto* id = static_cast<const IdentifierExpr*>(e);
+            b = &id->binding;
+            n = &id->name;
+        } else if (e && e->kind == NodeKind::VarExpr) {
+            auto* var = static_cast<const VarExpr*>(e);
+            b = &var->binding;
+            n = &var->name;
+        }
+        if (!b || *n != name || b->scope != binding.scope || b->index != binding.index) return {};
+        return {operands.rbegin(), operands.rend()};
+    }
 };
 
 
 // 复合语句块
 struct BlockStmt : public Statement {
     std::vector<std::unique_ptr<Statement>> statements;
+    BlockStmt() : Statement(NodeKind::BlockStmt) {}
 };
 
 // if 语句
@@ -81,7 +261,7 @@ struct IfStmt : public Statement {
     std::unique_ptr<BlockStmt> thenBlock;
     std::unique_ptr<BlockStmt> elseBlock;
     IfStmt(std::unique_ptr<Expression> cond, std::unique_ptr<BlockStmt> thenB, std::unique_ptr<BlockStmt> elseB)
-        : condition(std::move(cond)), thenBlock(std::move(thenB)), elseBlock(std::move(elseB)) {}
+        : Statement(NodeKind::IfStmt), condition(std::move(cond)), thenBlock(std::move(thenB)), elseBlock(std::move(elseB)) {}
 };
 
 // while 语句
@@ -89,7 +269,7 @@ struct WhileStmt : public Statement {
     std::unique_ptr<Expression> condition;
     std::unique_ptr<BlockStmt> body;
     WhileStmt(std::unique_ptr<Expression> cond, std::unique_ptr<BlockStmt> b)
-        : condition(std::move(cond)), body(std::move(b)) {}
+        : Statement(NodeKind::WhileStmt), condition(std::move(cond)), body(std::move(b)) {}
 };
 
 // 函数定义
@@ -97,16 +277,47 @@ struct FuncDefStmt : public Statement {
     std::string name;
     std::vector<std::string> params;
     std::unique_ptr<BlockStmt> body;
+    // 由 Resolver 填写：帧内槽位对应的名字，以及每个参数所在的槽位
+    std::vector<std::string> locals;
+    std::vector<int> param_slots;
+    // 闭包编译层：调用计数达到阈值后把函数体编译为 ClosureBlock（见 closure.hpp）
+    mutable uint32_t call_count = 0;
+    mutable std::shared_ptr<const ClosureBlock> compiled;
+    // Interpreter::locals_read_by_name 的缓存，GlobalTable::dynamic_reads 增长后重新计算
+    mutable size_t dynamic_reads_checked = SIZE_MAX;
+    mutable bool locals_read_by_name = false;
     FuncDefStmt(const std::string& n, const std::vector<std::string>& p, std::unique_ptr<BlockStmt> b)
-        : name(n), params(p), body(std::move(b)) {}
+        : Statement(NodeKind::FuncDefStmt), name(n), params(p), body(std::move(b)) {}
+};
+
+// 调用点缓存：记录被调名字解析出的目标，由 Interpreter 填写和校验
+struct CallCache {
+    enum class Target : unsigned char {
+        Unresolved,
+        Builtin,
+        Function,
+        Module,
+        Undefined
+    };
+    Target target = Target::Unresolved;
+    // 被调名字可能同时是变量名，需要检查 "__function_" 间接调用
+    bool may_be_variable = false;
+    // 填写时解释器的状态，任一变化即失效
+    uint64_t epoch = 0;
+    size_t global_count = 0;
+    const std::function<Value(const std::vector<Value>&)>* builtin = nullptr;
+    const FuncDefStmt* func = nullptr;
+    // 被调名在 Interpreter 符号表中的 ID，用于调用栈
+    uint32_t name_id = 0;
 };
 
 // 函数调用
 struct CallExpr : public Expression {
     std::string callee;
     std::vector<std::unique_ptr<Expression>> args;
+    mutable CallCache cache;
     CallExpr(const std::string& c, std::vector<std::unique_ptr<Expression>> a)
-        : callee(c), args(std::move(a)) {}
+        : Expression(NodeKind::CallExpr), callee(c), args(std::move(a)) {}
 };
 
 // 命名空间函数调用
@@ -115,57 +326,61 @@ struct NamespaceCallExpr : public Expression {
     std::string function_name;
     std::vector<std::unique_ptr<Expression>> args;
     NamespaceCallExpr(const std::string& ns, const std::string& fn, std::vector<std::unique_ptr<Expression>> a)
-        : namespace_name(ns), function_name(fn), args(std::move(a)) {}
+        : Expression(NodeKind::NamespaceCallExpr), namespace_name(ns), function_name(fn), args(std::move(a)) {}
 };
 
 // 数组字面量
 struct ArrayExpr : public Expression {
     std::vector<std::unique_ptr<Expression>> elements;
     explicit ArrayExpr(std::vector<std::unique_ptr<Expression>> elems)
-        : elements(std::move(elems)) {}
+        : Expression(NodeKind::ArrayExpr), elements(std::move(elems)) {}
 };
 
 // return 语句
 struct ReturnStmt : public Statement {
     std::unique_ptr<Expression> expr;
-    explicit ReturnStmt(std::unique_ptr<Expression> e) : expr(std::move(e)) {}
+    // 函数体内、循环外的 return f(...)，由 Resolver 标记为尾调用候选；
+    // 当前帧的局部变量可能被按名读到时，执行时仍按普通调用处理（见 Interpreter::locals_read_by_name）
+    bool tail_call = false;
+    explicit ReturnStmt(std::unique_ptr<Expression> e) : Statement(NodeKind::ReturnStmt), expr(std::move(e)) {}
 };
 
 // include 语句
 struct IncludeStmt : public Statement {
     std::string module;
-    explicit IncludeStmt(const std::string& m) : module(m) {}
+    explicit IncludeStmt(const std::string& m) : Statement(NodeKind::IncludeStmt), module(m) {}
 };
 
 // 空语句
 struct NullStmt : public Statement {
-    NullStmt() = default;
+    NullStmt() : Statement(NodeKind::NullStmt) {}
 };
 
 // break 语句
 struct BreakStmt : public Statement {
-    BreakStmt() = default;
+    BreakStmt() : Statement(NodeKind::BreakStmt) {}
 };
 
 // continue 语句
 struct ContinueStmt : public Statement {
-    ContinueStmt() = default;
+    ContinueStmt() : Statement(NodeKind::ContinueStmt) {}
 };
 
 // 表达式语句
 struct ExprStmt : public Statement {
     std::unique_ptr<Expression> expr;
-    explicit ExprStmt(std::unique_ptr<Expression> e) : expr(std::move(e)) {}
+    explicit ExprStmt(std::unique_ptr<Expression> e) : Statement(NodeKind::ExprStmt), expr(std::move(e)) {}
 };
 
 // Struct声明
 struct StructDeclStmt : public Statement {
     std::string name;
+    Binding binding;
     std::vector<std::pair<std::string, std::unique_ptr<Expression>>> init_vec;
     explicit StructDeclStmt(
             const std::string& n,
             std::vector<std::pair<std::string, std::unique_ptr<Expression>>> v)
-        : name(n), init_vec(std::move(v)) {}
+        : Statement(NodeKind::StructDeclStmt), name(n), init_vec(std::move(v)) {}
 };
 
 // Define语句（用于设置常量，如递归深度）
@@ -173,13 +388,30 @@ struct DefineStmt : public Statement {
     std::string name;
     std::unique_ptr<Expression> value;
     DefineStmt(const std::string& n, std::unique_ptr<Expression> v)
-        : name(n), value(std::move(v)) {}
+        : Statement(NodeKind::DefineStmt), name(n), value(std::move(v)) {}
 };
 
 // BigInt变量声明
 struct BigIntDeclStmt : public Statement {
     std::string name;
+    Binding binding;
     std::unique_ptr<Expression> init_value;
     explicit BigIntDeclStmt(const std::string& n, std::unique_ptr<Expression> v = nullptr)
-        : name(n), init_value(std::move(v)) {}
+        : Statement(NodeKind::BigIntDeclStmt), name(n), init_value(std::move(v)) {}
+};
+
+// 一次解析的完整结果：根节点、节点所在的 arena 和被引用的源码。
+// 成员按声明的逆序析构，节点先于 arena 和源码释放
+struct SyntaxTree {
+    // 源码缓冲区的所有者（映射的文件或字符串），source 指向其中
+    std::shared_ptr<const void> source_owner;
+    std::string_view source;
+    std::unique_ptr<AstArena> arena;
+    std::unique_ptr<ASTNode> root;
+
+    std::string_view text(const SourceSpan& span) const {
+        return span.offset <= source.size() && span.length <= source.size() - span.offset
+                       ? source.substr(span.offset, span.length)
+                       : std::string_view();
+    }
 };
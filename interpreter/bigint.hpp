@@ -1,370 +1,1167 @@
 #pragma once
 #include <algorithm>
+#include <atomic>
+#include <bit>
 #include <climits>
 #include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <limits>
+#include <mutex>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+// 以 64 位 limb 为单位的无符号多精度运算，BigInt 的各运算都落到这里。
+// 数组低位在前；除特别说明外，输出区不能与输入区重叠
+namespace bigint_detail {
+using limb = uint64_t;
+
+#ifdef __SIZEOF_INT128__
+__extension__ typedef unsigned __int128 dlimb;
+#endif
+
+// a * b 的低 64 位，高 64 位写入 hi
+inline limb mul_wide(limb a, limb b, limb& hi) {
+#ifdef __SIZEOF_INT128__
+    const dlimb p = static_cast<dlimb>(a) * b;
+    hi = static_cast<limb>(p >> 64);
+    return static_cast<limb>(p);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    return _umul128(a, b, &hi);
+#else
+    const limb a0 = a & 0xffffffffu, a1 = a >> 32, b0 = b & 0xffffffffu, b1 = b >> 32;
+    const limb p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+    const limb mid = (p00 >> 32) + (p01 & 0xffffffffu) + (p10 & 0xffffffffu);
+    hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+    return (mid << 32) | (p00 & 0xffffffffu);
+#endif
+}
+
+// (hi:lo) / d，要求 hi < d，余数写入 rem
+inline limb div_wide(limb hi, limb lo, limb d, limb& rem) {
+#ifdef __SIZEOF_INT128__
+    const dlimb n = (static_cast<dlimb>(hi) << 64) | lo;
+    rem = static_cast<limb>(n % d);
+    return static_cast<limb>(n / d);
+#elif defined(_MSC_VER) && defined(_M_X64) && _MSC_VER >= 1920
+    return _udiv128(hi, lo, d, &rem);
+#else
+    limb q = 0;
+    for (int i = 0; i < 64; ++i) {
+        const bool top = hi >> 63;
+        hi = (hi << 1) | (lo >> 63);
+        lo <<= 1;
+        q <<= 1;
+        if (top || hi >= d) {
+            hi -= d;
+            q |= 1;
+        }
+    }
+    rem = hi;
+    return q;
+#endif
+}
+
+// 带溢出检查的 int64 加、减、乘：溢出时返回 true，否则结果写入 result。
+// GCC/Clang 用 __builtin_*_overflow，MSVC 等其他编译器按无符号运算判断
+inline bool add_overflow(int64_t a, int64_t b, int64_t& result) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_add_overflow(a, b, &result);
+#else
+    const auto r = static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b));
+    if (((a ^ r) & (b ^ r)) < 0) return true;
+    result = r;
+    return false;
+#endif
+}
+
+inline bool sub_overflow(int64_t a, int64_t b, int64_t& result) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_sub_overflow(a, b, &result);
+#else
+    const auto r = static_cast<int64_t>(static_cast<uint64_t>(a) - static_cast<uint64_t>(b));
+    if (((a ^ b) & (a ^ r)) < 0) return true;
+    result = r;
+    return false;
+#endif
+}
+
+inline bool mul_overflow(int64_t a, int64_t b, int64_t& result) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_mul_overflow(a, b, &result);
+#else
+    // 按绝对值相乘，再看乘积是否落在 [-2^63, 2^63 - 1] 内
+    const bool negative = (a < 0) != (b < 0);
+    const limb ua = a < 0 ? 0 - static_cast<limb>(a) : static_cast<limb>(a);
+    const limb ub = b < 0 ? 0 - static_cast<limb>(b) : static_cast<limb>(b);
+    limb hi;
+    const limb lo = mul_wide(ua, ub, hi);
+    const limb limit = static_cast<limb>(INT64_MAX) + (negative ? 1 : 0);
+    if (hi || lo > limit) return true;
+    result = static_cast<int64_t>(negative ? 0 - lo : lo);
+    return false;
+#endif
+}
+
+// a + b + carry，carry 取 0/1 并更新为新的进位
+inline limb add_carry(limb a, limb b, limb& carry) {
+    const limb s = a + b;
+    const limb r = s + carry;
+    carry = static_cast<limb>(s < a) + static_cast<limb>(r < s);
+    return r;
+}
+
+// a - b - borrow，borrow 取 0/1 并更新为新的借位
+inline limb sub_borrow(limb a, limb b, limb& borrow) {
+    const limb d = a - b;
+    const limb r = d - borrow;
+    borrow = static_cast<limb>(a < b) + static_cast<limb>(d < borrow);
+    return r;
+}
+
+// 比较两个已去掉高位零的数
+inline int cmp(const limb* a, size_t an, const limb* b, size_t bn) {
+    if (an != bn) return an < bn ? -1 : 1;
+    for (size_t i = an; i-- > 0;) {
+        if (a[i] != b[i]) return a[i] < b[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+// r[0..an) = a + b，要求 an >= bn，返回最高位进位；r 可以与 a 重叠
+inline limb add(limb* r, const limb* a, size_t an, const limb* b, size_t bn) {
+    limb carry = 0;
+    size_t i = 0;
+    for (; i < bn; ++i) r[i] = add_carry(a[i], b[i], carry);
+    for (; i < an; ++i) {
+        r[i] = a[i] + carry;
+        carry = r[i] < carry;
+    }
+    return carry;
+}
+
+// r[0..an) = a - b，要求 an >= bn，返回最高位借位；r 可以与 a 或 b 重叠
+inline limb sub(limb* r, const limb* a, size_t an, const limb* b, size_t bn) {
+    limb borrow = 0;
+    size_t i = 0;
+    for (; i < bn; ++i) r[i] = sub_borrow(a[i], b[i], borrow);
+    for (; i < an; ++i) {
+        const limb v = a[i];
+        r[i] = v - borrow;
+        borrow = v < borrow;
+    }
+    return borrow;
+}
+
+// r[0..n) += a[0..n) * b，返回溢出到 r[n] 的部分
+inline limb addmul_1(limb* r, const limb* a, size_t n, limb b) {
+    limb carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        limb hi;
+        limb lo = mul_wide(a[i], b, hi);
+        lo += carry;
+        hi += lo < carry;
+        r[i] += lo;
+        hi += r[i] < lo;
+        carry = hi;
+    }
+    return carry;
+}
+
+// r[0..n) -= a[0..n) * b，返回还需从 r[n] 减去的部分
+inline limb submul_1(limb* r, const limb* a, size_t n, limb b) {
+    limb carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        limb hi;
+        limb lo = mul_wide(a[i], b, hi);
+        lo += carry;
+        hi += lo < carry;
+        const limb x = r[i];
+        r[i] = x - lo;
+        hi += x < lo;
+        carry = hi;
+    }
+    return carry;
+}
+
+// q[0..n) = a / d，返回余数；q 可以与 a 重叠
+inline limb divmod_1(limb* q, const limb* a, size_t n, limb d) {
+    limb rem = 0;
+    for (size_t i = n; i-- > 0;) q[i] = div_wide(rem, a[i], d, rem);
+    return rem;
+}
+
+// 线程局部的复用缓冲区：构造时取走，析构时归还，循环中反复运算不再重新分配。
+// 嵌套使用（包括等待线程池时代为执行的任务）时内层拿到的是空缓冲区，互不干扰；
+// 超过 retain_limit 的缓冲区不留存，避免长期占用大块内存
+template<int Tag>
+class ReusableBuffer {
+public:
+    ReusableBuffer() : buffer(std::move(stash())) {}
+    ~ReusableBuffer() {
+        if (buffer.capacity() <= retain_limit) stash() = std::move(buffer);
+    }
+    ReusableBuffer(const ReusableBuffer&) = delete;
+    ReusableBuffer& operator=(const ReusableBuffer&) = delete;
 
-class BigInt {
+    std::vector<limb>& get() { return buffer; }
+
+private:
+    static constexpr size_t retain_limit = size_t(1) << 16;
+    std::vector<limb> buffer;
+
+    static std::vector<limb>& stash() {
+        thread_local std::vector<limb> v;
+        return v;
+    }
+};
+
+// Knuth 算法 D：q[0..an-bn] = a / b，r[0..bn) = a % b。
+// 要求 an >= bn >= 2 且 b 的最高 limb 非零
+inline void divmod_knuth(limb* q, limb* r, const limb* a, size_t an, const limb* b, size_t bn) {
+    // 规范化：左移使除数最高位为 1，试商最多偏大 2
+    const int s = std::countl_zero(b[bn - 1]);
+    ReusableBuffer<1> vbuf;
+    ReusableBuffer<2> ubuf;
+    std::vector<limb>& v = vbuf.get();
+    std::vector<limb>& u = ubuf.get();
+    v.resize(bn);
+    u.resize(an + 1);
+    for (size_t i = bn; i-- > 0;) v[i] = (b[i] << s) | (s && i ? b[i - 1] >> (64 - s) : 0);
+    u[an] = s ? a[an - 1] >> (64 - s) : 0;
+    for (size_t i = an; i-- > 0;) u[i] = (a[i] << s) | (s && i ? a[i - 1] >> (64 - s) : 0);
+
+    const limb vh = v[bn - 1], vl = v[bn - 2];
+    for (size_t j = an - bn + 1; j-- > 0;) {
+        // 用被除数最高两个 limb 除以除数最高 limb 试商，再用次高 limb 修正
+        limb qhat, rhat;
+        bool rhat_overflow = false;
+        if (u[j + bn] >= vh) {
+            qhat = ~limb(0);
+            rhat = u[j + bn - 1] + vh;
+            rhat_overflow = rhat < vh;
+        } else {
+            qhat = div_wide(u[j + bn], u[j + bn - 1], vh, rhat);
+        }
+        while (!rhat_overflow) {
+            limb hi;
+            const limb lo = mul_wide(qhat, vl, hi);
+            if (hi < rhat || (hi == rhat && lo <= u[j + bn - 2])) break;
+            --qhat;
+            rhat += vh;
+            rhat_overflow = rhat < vh;
+        }
+
+        // u[j..j+bn] -= qhat·v，减成负数说明试商仍大 1，加回一次
+        const limb borrow = submul_1(u.data() + j, v.data(), bn, qhat);
+        const limb top = u[j + bn];
+        u[j + bn] = top - borrow;
+        if (top < borrow) {
+            --qhat;
+            u[j + bn] += add(u.data() + j, u.data() + j, bn, v.data(), bn);
+        }
+        q[j] = qhat;
+    }
+
+    // 余数右移还原
+    for (size_t i = 0; i < bn; ++i) r[i] = (u[i] >> s) | (s ? u[i + 1] << (64 - s) : 0);
+}
+
+// 大数乘法与阶乘共用的 fork-join 线程池。
+// 等待一组任务的线程会顺带执行队列中的其他任务，嵌套提交不会死锁
+class TaskPool {
 public:
-    bool negative;
-    std::vector<unsigned char> digits;// 存储数字，低位在前
+    // 线程数默认取硬件并发数，可用环境变量 LAMINA_THREADS 限制，为 1 时全部串行
+    static TaskPool& instance() {
+        // 有意不析构：工作线程常驻到进程退出，避免在动态库卸载时 join
+        static TaskPool* pool = new TaskPool(thread_count() - 1);
+        return *pool;
+    }
 
-    // 友元类声明
-    friend class Fraction;
-    // 构造函数
-    BigInt() : negative(false), digits({0}) {}
+    // 含调用线程在内的可用线程数
+    [[nodiscard]] size_t threads() const { return workers + 1; }
 
-    explicit BigInt(int n) : negative(n < 0) {
-        if (n == 0) {
-            digits.push_back(0);
+    // 并发执行 tasks[0..n)，全部完成后返回；任一任务抛出的异常在结束后重新抛出
+    void run(std::function<void()>* tasks, size_t n) {
+        if (workers == 0 || n < 2) {
+            for (size_t i = 0; i < n; ++i) tasks[i]();
             return;
         }
 
-        // 处理 INT_MIN 的特殊情况
-        if (n == INT_MIN) {
-            // INT_MIN 的绝对值超出 int 范围，直接处理
-            auto ln = static_cast<long long>(n);
-            ln = -ln;// 现在安全了
-            while (ln > 0) {
-                digits.push_back(ln % 10);
-                ln /= 10;
-            }
-        } else {
-            n = std::abs(n);
-            while (n > 0) {
-                digits.push_back(n % 10);
-                n /= 10;
+        Group group;
+        group.pending = n;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (size_t i = 1; i < n; ++i) queue.push_back({&tasks[i], &group});
+        }
+        changed.notify_all();
+        execute({&tasks[0], &group});
+
+        std::unique_lock<std::mutex> lock(mutex);
+        while (group.pending.load() > 0) {
+            if (!queue.empty()) {
+                const Job job = queue.front();
+                queue.pop_front();
+                lock.unlock();
+                execute(job);
+                lock.lock();
+            } else {
+                changed.wait(lock);
             }
         }
+        lock.unlock();
+        if (group.error) std::rethrow_exception(group.error);
     }
 
-    explicit BigInt(const std::string& str) : negative(false), digits({}) {
-        if (str.empty() || str == "0") {
-            digits.push_back(0);
-            return;
+private:
+    struct Group {
+        std::atomic<size_t> pending;
+        std::mutex error_mutex;
+        std::exception_ptr error;
+    };
+
+    struct Job {
+        std::function<void()>* fn;
+        Group* group;
+    };
+
+    size_t workers;
+    std::mutex mutex;
+    std::condition_variable changed;// 有新任务入队或有任务组完成
+    std::deque<Job> queue;
+
+    explicit TaskPool(size_t n) : workers(n) {
+        for (size_t i = 0; i < n; ++i) std::thread([this] { work(); }).detach();
+    }
+
+    static size_t thread_count() {
+        size_t n = std::max(1u, std::thread::hardware_concurrency());
+        if (const char* env = std::getenv("LAMINA_THREADS")) {
+            const long v = std::strtol(env, nullptr, 10);
+            if (v > 0) n = static_cast<size_t>(v);
         }
+        return n;
+    }
 
-        size_t start = 0;
-        if (str[0] == '-') {
-            negative = true;
-            start = 1;
-        } else if (str[0] == '+') {
-            start = 1;
+    void execute(const Job& job) {
+        try {
+            (*job.fn)();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(job.group->error_mutex);
+            if (!job.group->error) job.group->error = std::current_exception();
+        }
+        if (--job.group->pending == 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            changed.notify_all();
+        }
+    }
+
+    void work() {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            changed.wait(lock, [this] { return !queue.empty(); });
+            const Job job = queue.front();
+            queue.pop_front();
+            lock.unlock();
+            execute(job);
+            lock.lock();
         }
+    }
+};
+
+// 并发执行若干个可调用对象
+template<class... F>
+void parallel_invoke(F&&... fs) {
+    std::function<void()> tasks[] = {std::function<void()>(std::forward<F>(fs))...};
+    TaskPool::instance().run(tasks, sizeof...(F));
+}
+
+// 把 [0, n) 切成至多线程数个、每段不少于 grain 的区间，并发调用 f(begin, end)
+template<class F>
+void parallel_for(size_t n, size_t grain, const F& f) {
+    TaskPool& pool = TaskPool::instance();
+    const size_t chunks = std::min(pool.threads(), std::max<size_t>(1, n / std::max<size_t>(1, grain)));
+    if (chunks < 2) {
+        f(size_t(0), n);
+        return;
+    }
+    std::vector<std::function<void()>> tasks;
+    tasks.reserve(chunks);
+    for (size_t c = 0; c < chunks; ++c) {
+        const size_t begin = n * c / chunks, end = n * (c + 1) / chunks;
+        tasks.emplace_back([&f, begin, end] { f(begin, end); });
+    }
+    pool.run(tasks.data(), tasks.size());
+}
+
+// 较短的操作数短于该长度（limb 数）时使用逐位相乘
+constexpr size_t karatsuba_threshold = 32;
+// 较短的操作数达到该长度且两数长度相近时使用 Toom-3
+constexpr size_t toom3_threshold = 192;
+// 较短的操作数达到该长度时使用数论变换
+constexpr size_t ntt_threshold = 4000;
+// 较短的操作数达到该长度时 Karatsuba、Toom-3 的子乘积交给线程池并发计算
+constexpr size_t parallel_mul_threshold = 768;
+
+// r[0..an+bn) = a * b，逐位相乘
+inline void mul_basecase(limb* r, const limb* a, size_t an, const limb* b, size_t bn) {
+    std::fill(r, r + an + bn, limb(0));
+    for (size_t j = 0; j < bn; ++j) r[an + j] = addmul_1(r + j, a, an, b[j]);
+}
+
+// x[0..n) 按 n 个 limb 宽的补码取负
+inline void negate(limb* x, size_t n) {
+    limb carry = 1;
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = ~x[i] + carry;
+        carry = carry && x[i] == 0;
+    }
+}
+
+// x[0..n) 按补码解释为负数时取绝对值，返回原来是否为负
+inline bool abs_in_place(limb* x, size_t n) {
+    if (!(x[n - 1] >> 63)) return false;
+    negate(x, n);
+    return true;
+}
+
+// x[0..n) 左移 1 位，最高位丢弃
+inline void shl1(limb* x, size_t n) {
+    for (size_t i = n; i-- > 1;) x[i] = (x[i] << 1) | (x[i - 1] >> 63);
+    x[0] <<= 1;
+}
+
+// x[0..n) 按补码算术右移 1 位
+inline void sar1(limb* x, size_t n) {
+    for (size_t i = 0; i + 1 < n; ++i) x[i] = (x[i] >> 1) | (x[i + 1] << 63);
+    x[n - 1] = static_cast<limb>(static_cast<int64_t>(x[n - 1]) >> 1);
+}
+
+// x[0..n) /= 3，要求按 n 个 limb 宽的补码能整除
+inline void divexact_by3(limb* x, size_t n) {
+    constexpr limb inv3 = 0xaaaaaaaaaaaaaaabull;// 3 在模 2^64 下的逆元
+    limb borrow = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const limb v = x[i];
+        const limb s = v - borrow;
+        borrow = v < borrow;
+        const limb q = s * inv3;
+        x[i] = q;
+        limb hi;
+        mul_wide(q, 3, hi);
+        borrow += hi;
+    }
+}
+
+// mul_rec 在较长操作数为 n 个 limb 时所需的临时空间上界
+inline size_t mul_scratch_size(size_t n) {
+    return 6 * n + 64 * static_cast<size_t>(std::bit_width(n));
+}
+
+inline void mul_rec(limb* r, const limb* a, size_t an, const limb* b, size_t bn, limb* scratch);
+
+// 执行互不重叠的子乘积 product(scratch)。parallel 为真且有多个线程时交给线程池并发计算，
+// 第一个沿用 scratch，其余各自分配 scratch_size 个 limb 的临时空间
+inline void sub_products(std::initializer_list<std::function<void(limb*)>> products, limb* scratch, size_t scratch_size, bool parallel) {
+    if (!parallel || TaskPool::instance().threads() < 2) {
+        for (const auto& product: products) product(scratch);
+        return;
+    }
+    std::vector<std::vector<limb>> buffers(products.size() - 1, std::vector<limb>(scratch_size));
+    std::vector<std::function<void()>> tasks;
+    tasks.reserve(products.size());
+    for (const auto& product: products) {
+        limb* s = tasks.empty() ? scratch : buffers[tasks.size() - 1].data();
+        tasks.emplace_back([&product, s] { product(s); });
+    }
+    TaskPool::instance().run(tasks.data(), tasks.size());
+}
+
+// Toom-3：a、b 各按 k 个 limb 拆成三段，在 0、1、-1、-2、∞ 处求值后做 5 次乘法再插值。
+// 要求 an >= bn > 2k，k = ceil(an / 3)；临时空间取自 scratch
+inline void mul_toom3(limb* r, const limb* a, size_t an, const limb* b, size_t bn, limb* scratch) {
+    const size_t k = (an + 2) / 3;
+    const size_t a2n = an - 2 * k, b2n = bn - 2 * k;
+    // 求值结果的绝对值不超过 5·B^k，乘积与插值中间量不超过 50·B^(2k)，都留出一个 limb 的符号余量
+    const size_t w = k + 2, pw = 2 * w;
+
+    limb* ea = scratch;    // a 在 1、-1、-2 处的值
+    limb* eb = ea + 3 * w; // b 在 1、-1、-2 处的值
+    limb* p = eb + 3 * w;  // 三处的乘积，补码
+    limb* rest = p + 3 * pw;
+
+    // 求值：p1 = x0 + x1 + x2，pm1 = x0 - x1 + x2，pm2 = 2(pm1 + x2) - x0，均按 w 宽的补码
+    auto evaluate = [k, w](const limb* x, size_t x2n, limb* e) {
+        const limb *x0 = x, *x1 = x + k, *x2 = x + 2 * k;
+        limb *p1 = e, *pm1 = e + w, *pm2 = e + 2 * w;
+        std::fill(p1, p1 + w, limb(0));
+        std::copy(x0, x0 + k, p1);
+        add(p1, p1, w, x2, x2n);
+        std::copy(p1, p1 + w, pm1);
+        sub(pm1, pm1, w, x1, k);
+        add(p1, p1, w, x1, k);
+        std::copy(pm1, pm1 + w, pm2);
+        add(pm2, pm2, w, x2, x2n);
+        shl1(pm2, w);
+        sub(pm2, pm2, w, x0, k);
+    };
+    evaluate(a, a2n, ea);
+    evaluate(b, b2n, eb);
+
+    // 三处的乘积按绝对值相乘，异号时再取负；r(0) 与 r(∞) 直接写到结果的最低与最高段
+    bool neg[3];
+    for (size_t i = 0; i < 3; ++i) neg[i] = abs_in_place(ea + i * w, w) != abs_in_place(eb + i * w, w);
+    auto at = [&](size_t i) {
+        return [&, i](limb* s) {
+            mul_rec(p + i * pw, ea + i * w, w, eb + i * w, w, s);
+            if (neg[i]) negate(p + i * pw, pw);
+        };
+    };
+    sub_products({at(0), at(1), at(2),
+                  [&](limb* s) { mul_rec(r, a, k, b, k, s); },
+                  [&](limb* s) {
+                      if (a2n >= b2n) {
+                          mul_rec(r + 4 * k, a + 2 * k, a2n, b + 2 * k, b2n, s);
+                      } else {
+                          mul_rec(r + 4 * k, b + 2 * k, b2n, a + 2 * k, a2n, s);
+                      }
+                  }},
+                 rest, mul_scratch_size(w), bn >= parallel_mul_threshold);
+    std::fill(r + 2 * k, r + 4 * k, limb(0));
+
+    // 插值（Bodrato 的顺序），全程按 pw 宽的补码运算：
+    // r3 = (r(-2) - r(1)) / 3，r1 = (r(1) - r(-1)) / 2，r2 = r(-1) - r(0)，
+    // r3 = (r2 - r3) / 2 + 2r(∞)，r2 = r2 + r1 - r(∞)，r1 = r1 - r3
+    limb *r1 = p, *r2 = p + pw, *r3 = p + 2 * pw;
+    const limb *r0 = r, *rinf = r + 4 * k;
+    const size_t rinfn = a2n + b2n;
+    sub(r3, r3, pw, r1, pw);
+    divexact_by3(r3, pw);
+    sub(r1, r1, pw, r2, pw);
+    sar1(r1, pw);
+    sub(r2, r2, pw, r0, 2 * k);
+    sub(r3, r2, pw, r3, pw);
+    sar1(r3, pw);
+    add(r3, r3, pw, rinf, rinfn);
+    add(r3, r3, pw, rinf, rinfn);
+    add(r2, r2, pw, r1, pw);
+    sub(r2, r2, pw, rinf, rinfn);
+    sub(r1, r1, pw, r3, pw);
+
+    // 此时 r1、r2、r3 均非负，依次累加到第 k、2k、3k 个 limb 上
+    const size_t n = an + bn;
+    for (size_t i = 1; i <= 3; ++i) {
+        const limb* c = p + (i - 1) * pw;
+        size_t cn = pw;
+        while (cn > 0 && c[cn - 1] == 0) --cn;
+        add(r + i * k, r + i * k, n - i * k, c, cn);
+    }
+}
+
+// r[0..an+bn) = a * b，要求 an >= bn > 0；临时空间取自 scratch，至少 mul_scratch_size(an) 个 limb
+inline void mul_rec(limb* r, const limb* a, size_t an, const limb* b, size_t bn, limb* scratch) {
+    if (bn < karatsuba_threshold) {
+        mul_basecase(r, a, an, b, bn);
+        return;
+    }
 
-        for (size_t i = str.length() - 1; i >= start and i < str.length(); i--) {
-            if (str[i] >= '0' && str[i] <= '9') {
-                digits.push_back(str[i] - '0');
+    const size_t m = (an + 1) / 2;
+    if (bn <= m) {
+        // 长度相差悬殊：a 按 bn 分段，每段与 b 等长相乘后错位累加
+        std::fill(r, r + an + bn, limb(0));
+        limb* part = scratch;
+        for (size_t off = 0; off < an; off += bn) {
+            const size_t len = std::min(bn, an - off);
+            if (len >= bn) {
+                mul_rec(part, a + off, len, b, bn, scratch + 2 * bn);
+            } else {
+                mul_rec(part, b, bn, a + off, len, scratch + 2 * bn);
             }
+            add(r + off, r + off, an + bn - off, part, len + bn);
+        }
+        return;
+    }
+
+    if (bn >= toom3_threshold && bn > 2 * ((an + 2) / 3)) {
+        mul_toom3(r, a, an, b, bn, scratch);
+        return;
+    }
+
+    // Karatsuba：a = a1·B^m + a0，b = b1·B^m + b0
+    // a·b = z2·B^2m + (z1 - z2 - z0)·B^m + z0，z1 = (a0 + a1)(b0 + b1)
+    const limb *a0 = a, *a1 = a + m, *b0 = b, *b1 = b + m;
+    const size_t a1n = an - m, b1n = bn - m;
+    limb* sa = scratch;
+    limb* sb = sa + (m + 1);
+    limb* z1 = sb + (m + 1);
+    limb* rest = z1 + (2 * m + 2);
+
+    sa[m] = add(sa, a0, m, a1, a1n);
+    sb[m] = add(sb, b0, m, b1, b1n);
+    sub_products({[&](limb* s) { mul_rec(r, a0, m, b0, m, s); },// z0 -> r[0..2m)
+                  [&](limb* s) {                                // z2 -> r[2m..an+bn)
+                      if (a1n >= b1n) {
+                          mul_rec(r + 2 * m, a1, a1n, b1, b1n, s);
+                      } else {
+                          mul_rec(r + 2 * m, b1, b1n, a1, a1n, s);
+                      }
+                  },
+                  [&](limb* s) { mul_rec(z1, sa, m + 1, sb, m + 1, s); }},
+                 rest, mul_scratch_size(m + 1), bn >= parallel_mul_threshold);
+
+    // z1 -= z0 + z2，结果非负且不超过 2m+1 个 limb
+    sub(z1, z1, 2 * m + 2, r, 2 * m);
+    sub(z1, z1, 2 * m + 2, r + 2 * m, a1n + b1n);
+    size_t z1n = 2 * m + 2;
+    while (z1n > 0 && z1[z1n - 1] == 0) --z1n;
+    add(r + m, r + m, an + bn - m, z1, z1n);
+}
+
+// 三个形如 c·2^k + 1 的 62 位素数上的数论变换，再用中国剩余定理合成卷积。
+// 卷积的每一项小于 min(an, bn)·2^128，三素数之积约为 2^184，长度不超过 2^56 时不会溢出
+namespace ntt {
+// 模 p 的 Montgomery 运算，要求 p < 2^62，数值保持在 [0, p)
+struct Modulus {
+    limb p;
+    limb pinv;// -p^(-1) mod 2^64
+    limb r2;  // 2^128 mod p
+
+    explicit Modulus(limb p_) : p(p_) {
+        // 奇数 p 满足 p·p ≡ 1 (mod 8)，每次牛顿迭代精度翻倍
+        limb inv = p;
+        for (int i = 0; i < 5; ++i) inv *= 2 - p * inv;
+        pinv = 0 - inv;
+        const limb r = (0 - p) % p;// 2^64 mod p
+        limb hi;
+        const limb lo = mul_wide(r, r, hi);
+        div_wide(hi, lo, p, r2);
+    }
+
+    // Montgomery 约简：(hi·2^64 + lo) · 2^(-64) mod p，要求输入小于 p·2^64
+    [[nodiscard]] limb reduce(limb hi, limb lo) const {
+        limb mh;
+        const limb ml = mul_wide(lo * pinv, p, mh);
+        const limb carry = (lo + ml) < lo;
+        limb t = hi + mh + carry;
+        return t >= p ? t - p : t;
+    }
+
+    [[nodiscard]] limb mul(limb a, limb b) const {
+        limb hi;
+        const limb lo = mul_wide(a, b, hi);
+        return reduce(hi, lo);
+    }
+
+    [[nodiscard]] limb add(limb a, limb b) const {
+        const limb s = a + b;
+        return s >= p ? s - p : s;
+    }
+
+    [[nodiscard]] limb sub(limb a, limb b) const {
+        return a >= b ? a - b : a + p - b;
+    }
+
+    // a·r2 < 2^64·p，任意 64 位的 a 都可以直接约简
+    [[nodiscard]] limb to_mont(limb a) const { return mul(a, r2); }
+
+    [[nodiscard]] limb from_mont(limb a) const { return reduce(0, a); }
+
+    [[nodiscard]] limb pow(limb base, limb e) const {
+        limb result = to_mont(1);
+        while (e) {
+            if (e & 1) result = mul(result, base);
+            base = mul(base, base);
+            e >>= 1;
+        }
+        return result;
+    }
+};
+
+struct Prime {
+    limb p;
+    limb generator;
+};
+
+constexpr Prime primes[3] = {
+    {4179340454199820289ull, 3},// 29·2^57 + 1
+    {2485986994308513793ull, 5},// 69·2^55 + 1
+    {1945555039024054273ull, 5},// 27·2^56 + 1
+};
+
+// 变换各层的单位根表：t[len + j] = w^j，w 为 2len 次单位根，len 取 1、2、4…n/2。
+// 同一层的单位根连续存放，内层循环顺序访问
+inline std::vector<limb> twiddles(const Modulus& mod, limb root, size_t n) {
+    std::vector<limb> t(n);
+    const size_t half = n / 2;
+    t[half] = mod.to_mont(1);
+    for (size_t j = 1; j < half; ++j) t[half + j] = mod.mul(t[half + j - 1], root);
+    for (size_t len = half / 2; len >= 1; len /= 2) {
+        for (size_t j = 0; j < len; ++j) t[len + j] = t[2 * (len + j)];
+    }
+    return t;
+}
+
+// 子变换长度不超过该值时逐层迭代，不再拆成线程池任务
+constexpr size_t serial_size = size_t(1) << 13;
+
+// 长度为 2 的幂的原地变换，均以 Montgomery 形式运算。
+// 正变换按频率抽取，输出为位反转顺序；逆变换按时间抽取，接受位反转顺序的输入。
+// 较长时先（或后）做最外一层，其余递归到前后两半，两半互相独立，可以并发
+inline void forward(limb* x, size_t n, const Modulus& mod, const limb* t) {
+    auto level = [&](size_t len, size_t s, size_t begin, size_t end) {
+        // 复制到局部，避免写 x 时编译器担心别名而反复读取模数
+        const Modulus m = mod;
+        const limb* w = t + len;
+        limb* lo = x + s;
+        limb* hi = lo + len;
+        for (size_t j = begin; j < end; ++j) {
+            const limb u = lo[j], v = hi[j];
+            lo[j] = m.add(u, v);
+            hi[j] = m.mul(m.sub(u, v), w[j]);
+        }
+    };
+    if (n <= serial_size) {
+        for (size_t len = n / 2; len >= 1; len /= 2) {
+            for (size_t s = 0; s < n; s += 2 * len) level(len, s, 0, len);
         }
+        return;
+    }
+    const size_t half = n / 2;
+    parallel_for(half, serial_size, [&](size_t begin, size_t end) { level(half, 0, begin, end); });
+    parallel_invoke([&] { forward(x, half, mod, t); }, [&] { forward(x + half, half, mod, t); });
+}
+
+inline void inverse(limb* x, size_t n, const Modulus& mod, const limb* t) {
+    auto level = [&](size_t len, size_t s, size_t begin, size_t end) {
+        const Modulus m = mod;
+        const limb* w = t + len;
+        limb* lo = x + s;
+        limb* hi = lo + len;
+        for (size_t j = begin; j < end; ++j) {
+            const limb u = lo[j], v = m.mul(hi[j], w[j]);
+            lo[j] = m.add(u, v);
+            hi[j] = m.sub(u, v);
+        }
+    };
+    if (n <= serial_size) {
+        for (size_t len = 1; len < n; len *= 2) {
+            for (size_t s = 0; s < n; s += 2 * len) level(len, s, 0, len);
+        }
+        return;
+    }
+    const size_t half = n / 2;
+    parallel_invoke([&] { inverse(x, half, mod, t); }, [&] { inverse(x + half, half, mod, t); });
+    parallel_for(half, serial_size, [&](size_t begin, size_t end) { level(half, 0, begin, end); });
+}
+
+// 在一个素数下求 a、b 的循环卷积，长度 n，结果为普通形式
+inline std::vector<limb> convolve(const limb* a, size_t an, const limb* b, size_t bn, size_t n, const Prime& prime) {
+    const Modulus mod(prime.p);
+    const limb root = mod.pow(mod.to_mont(prime.generator), (prime.p - 1) / n);
+    const std::vector<limb> t = twiddles(mod, root, n);
+
+    auto load = [&](const limb* x, size_t xn, std::vector<limb>& f) {
+        f.assign(n, 0);
+        for (size_t i = 0; i < xn; ++i) f[i] = mod.to_mont(x[i]);
+        forward(f.data(), n, mod, t.data());
+    };
+    std::vector<limb> fa, fb;
+    if (a == b && an == bn) {
+        // 平方只需一次正变换
+        load(a, an, fa);
+        parallel_for(n, serial_size, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) fa[i] = mod.mul(fa[i], fa[i]);
+        });
+    } else {
+        parallel_invoke([&] { load(a, an, fa); }, [&] { load(b, bn, fb); });
+        parallel_for(n, serial_size, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) fa[i] = mod.mul(fa[i], fb[i]);
+        });
+    }
+    inverse(fa.data(), n, mod, twiddles(mod, mod.pow(root, n - 1), n).data());
+
+    // 除以 n 并转回普通形式：乘 n^(-1) 的普通形式即可一步完成
+    const limb n_inv = mod.from_mont(mod.pow(mod.to_mont(n), prime.p - 2));
+    parallel_for(n, serial_size, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) fa[i] = mod.mul(fa[i], n_inv);
+    });
+    return fa;
+}
+
+// r[0..an+bn) = a * b
+inline void mul(limb* r, const limb* a, size_t an, const limb* b, size_t bn) {
+    const size_t n = std::bit_ceil(an + bn - 1);
+    std::vector<limb> c0, c1, c2;
+    parallel_invoke([&] { c0 = convolve(a, an, b, bn, n, primes[0]); },
+                    [&] { c1 = convolve(a, an, b, bn, n, primes[1]); },
+                    [&] { c2 = convolve(a, an, b, bn, n, primes[2]); });
+
+    // Garner：x = c0 + p0·t1 + p0·p1·t2，t1 < p1，t2 < p2。
+    // 常数取 Montgomery 形式，与普通形式的数相乘时 2^64 因子正好抵消，结果仍为普通形式
+    const limb p0 = primes[0].p, p1 = primes[1].p, p2 = primes[2].p;
+    const Modulus m1(p1), m2(p2);
+    const limb inv_p0_m1 = m1.pow(m1.to_mont(p0), p1 - 2);
+    const limb p0_m2 = m2.to_mont(p0);
+    const limb inv_p0p1_m2 = m2.pow(m2.mul(p0_m2, m2.to_mont(p1)), p2 - 2);
+    limb p01_hi;
+    const limb p01_lo = mul_wide(p0, p1, p01_hi);
+
+    // 各项互相独立，并发算出 x 的三个 limb，原地写回 c0、c1、c2
+    const size_t terms = an + bn - 1;
+    parallel_for(terms, serial_size, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const limb t1 = m1.mul(m1.sub(c1[i], c0[i] % p1), inv_p0_m1);
+            const limb u = m2.sub(m2.sub(c2[i], c0[i] % p2), m2.mul(t1 % p2, p0_m2));
+            const limb t2 = m2.mul(u, inv_p0p1_m2);
+            // x = c0 + p0·t1 + (p0·p1)·t2
+            limb x[3];
+            x[0] = mul_wide(p0, t1, x[1]);
+            limb carry = 0;
+            x[0] = add_carry(x[0], c0[i], carry);
+            x[1] += carry;
+            limb h0, h1;
+            const limb l0 = mul_wide(p01_lo, t2, h0);
+            const limb l1 = mul_wide(p01_hi, t2, h1);
+            carry = 0;
+            x[0] = add_carry(x[0], l0, carry);
+            x[1] = add_carry(x[1], h0, carry);
+            x[2] = h1 + carry;
+            carry = 0;
+            x[1] = add_carry(x[1], l1, carry);
+            x[2] += carry;
+            c0[i] = x[0];
+            c1[i] = x[1];
+            c2[i] = x[2];
+        }
+    });
+
+    // 按位错开累加：acc 是尚未输出的高位部分，每步输出最低的一个 limb
+    limb acc[4] = {0, 0, 0, 0};
+    for (size_t i = 0; i < an + bn; ++i) {
+        limb carry = 0;
+        if (i < terms) {
+            acc[0] = add_carry(acc[0], c0[i], carry);
+            acc[1] = add_carry(acc[1], c1[i], carry);
+            acc[2] = add_carry(acc[2], c2[i], carry);
+            acc[3] += carry;
+        }
+        r[i] = acc[0];
+        acc[0] = acc[1];
+        acc[1] = acc[2];
+        acc[2] = acc[3];
+        acc[3] = 0;
+    }
+}
+}// namespace ntt
+
+// r[0..an+bn) = a * b，要求 an >= bn > 0
+inline void mul(limb* r, const limb* a, size_t an, const limb* b, size_t bn) {
+    if (bn < karatsuba_threshold) {
+        mul_basecase(r, a, an, b, bn);
+    } else if (bn >= ntt_threshold) {
+        ntt::mul(r, a, an, b, bn);
+    } else {
+        std::vector<limb> scratch(mul_scratch_size(an));
+        mul_rec(r, a, an, b, bn, scratch.data());
+    }
+}
+}// namespace bigint_detail
 
-        if (digits.empty()) {
-            digits.push_back(0);
+class BigInt {
+public:
+    using limb = bigint_detail::limb;
+
+    bool negative;
+    std::vector<limb> limbs;// 绝对值，2^64 进制，低位在前；零没有 limb
+
+    // 友元类声明
+    friend class Fraction;
+    // 构造函数
+    BigInt() : negative(false) {}
+
+    explicit BigInt(int n) : BigInt(static_cast<int64_t>(n)) {}
+
+    explicit BigInt(int64_t n) : negative(n < 0) {
+        if (const limb m = magnitude(n)) limbs.push_back(m);
+    }
+
+    // 十进制字符串，可带正负号；非数字字符被忽略
+    explicit BigInt(const std::string& str) : negative(false) {
+        size_t start = 0;
+        if (!str.empty() && (str[0] == '-' || str[0] == '+')) {
+            negative = str[0] == '-';
+            start = 1;
         }
 
+        std::string digits;
+        digits.reserve(str.size() - start);
+        for (size_t i = start; i < str.length(); ++i) {
+            if (str[i] >= '0' && str[i] <= '9') digits += str[i];
+        }
+        const bool sign = negative;
+        *this = parse_decimal(digits.data(), digits.size());
+        negative = sign;
         remove_leading_zeros();
     }
 
-    // 移除前导零
+    // 移除高位的零 limb，零的符号归为正
     void remove_leading_zeros() {
-        while (digits.size() > 1 && digits.back() == 0) {
-            digits.pop_back();
+        while (!limbs.empty() && limbs.back() == 0) {
+            limbs.pop_back();
         }
-        if (digits.size() == 1 && digits[0] == 0) {
+        if (limbs.empty()) {
             negative = false;
         }
     }
 
     // 转换为字符串
     [[nodiscard]] std::string to_string() const {
-        if (digits.size() == 1 && digits[0] == 0) {
+        if (is_zero()) {
             return "0";
         }
 
         std::string result;
         if (negative) result += "-";
+        if (limbs.size() < decimal_split_threshold) {
+            append_decimal(limbs, 0, result);
+            return result;
+        }
 
-        for (size_t i = digits.size() - 1; i < digits.size(); i--) {
-            result += static_cast<char>('0' + digits[i]);
+        // 分治：powers[k] = 10^(19·2^k)，取到平方超过 |*this| 为止
+        std::vector<BigInt> powers(1);
+        powers[0].limbs.push_back(decimal_chunk_base);
+        while (2 * (powers.back().limbs.size() - 1) < limbs.size()) {
+            powers.push_back(powers.back() * powers.back());
         }
+        append_decimal_split(abs(), powers, powers.size() - 1, 0, result);
+        return result;
+    }
 
+    // 乘法
+    BigInt operator*(const BigInt& other) const& {
+        BigInt result;
+        if (is_zero() || other.is_zero()) return result;
+
+        const BigInt* a = this;
+        const BigInt* b = &other;
+        if (a->limbs.size() < b->limbs.size()) std::swap(a, b);
+        result.limbs.resize(a->limbs.size() + b->limbs.size());
+        bigint_detail::mul(result.limbs.data(), a->limbs.data(), a->limbs.size(), b->limbs.data(), b->limbs.size());
+
+        result.negative = (negative != other.negative);
+        result.remove_leading_zeros();
         return result;
     }
 
-    // 快速乘10
-    void mul_pow10(size_t n /* 乘10次数 */) {
-        if (n <= 0) return;
-        remove_leading_zeros();
-        for (size_t i = 0; i < n; i++) digits.push_back(0);
-        for (size_t i = digits.size() - 1; i >= n; i--) {
-            digits[i] = digits[i - n];
-        }
-        for (size_t i = n - 1; i < n; i--) digits[i] = 0;
+    // 加法
+    BigInt operator+(const BigInt& other) const& {
+        return add_signed(*this, other, other.negative);
     }
 
-    // 返回末尾0的数量
-    size_t count_end_zero() {
-        if (is_zero()) return 0;
-        size_t i = digits.size() - 1;
-        while (!digits[i]) i--;
-        return digits.size() - 1 - i;
+    // 减法
+    BigInt operator-(const BigInt& other) const& {
+        return add_signed(*this, other, !other.negative);
     }
 
-    //去除掉末尾的0
-    void del_end_zero() {
-        if (is_zero()) return;
-        while (!digits.back()) digits.pop_back();
+    // 左操作数是临时对象时直接在它的缓冲区上运算，a + b + c 之类的链式运算只分配一次
+    BigInt operator+(const BigInt& other) && { return std::move(*this += other); }
+    BigInt operator-(const BigInt& other) && { return std::move(*this -= other); }
+    BigInt operator*(const BigInt& other) && { return std::move(*this *= other); }
+    BigInt operator/(const BigInt& other) && { return std::move(*this /= other); }
+    BigInt operator%(const BigInt& other) && { return std::move(*this %= other); }
+
+    // 复合赋值：结果写回 *this，尽量复用已有的 limb 缓冲区
+    BigInt& operator+=(const BigInt& other) {
+        add_in_place(other, other.negative);
+        return *this;
     }
 
-    // 乘法
-    BigInt operator*(const BigInt& other) const {
-        BigInt result;
-        BigInt numa = *this, numb = other;
-        size_t end_zeros = numa.count_end_zero() + numb.count_end_zero();
-        numa.del_end_zero();
-        numb.del_end_zero();    //统计并去除末尾的0
-        numa.negative = false;
-        numb.negative = false;
-        result.digits.assign(digits.size() + other.digits.size(), 0);
-
-        if (numa.digits.size() >> 7 and numb.digits.size() >> 7) {
-            // 等价于numa.digits.size() >= 128 and numb.digits.size() >= 128
-            // 如果两数长度均大于50使用卡拉楚巴算法优化
-            // 算法思想可以将两个四位数乘法看成
-            // (100a + b)(100c + d) = 10000ac + 100(bc + ad) + bd
-            // 时间复杂度O(n^1.585)   = 10000ac + 100[(a + b)(c + d) - ac - bd] + bd
-            // 虽然n基本到了100位以上才有显著提升（一倍）,不过是针对pow才做的优化
-
-            size_t moven = numb.digits.size() >> 1;
-            if (numa.digits.size() > numb.digits.size()) moven = numa.digits.size() >> 1 /*除2*/;   //使用位数较大的一方作为移动基准
-            BigInt a = numa >> moven;
-            BigInt b = numa << (numa.digits.size() - moven);
-            // b.remove_leading_zeros();
-            BigInt c = numb >> moven;
-            BigInt d = numb << (numb.digits.size() - moven);
-            // d.remove_leading_zeros();
-
-            BigInt bd = b * d;
-            result = a * c; // 使用result记录ac节省内存
-            BigInt ad_bc = (a + b) * (c + d) - result - bd;
-            result.mul_pow10(moven);
-            result = result + ad_bc;
-            result.mul_pow10(moven);
-            result = result + bd;
+    BigInt& operator-=(const BigInt& other) {
+        add_in_place(other, !other.negative);
+        return *this;
+    }
 
-        } else {
-            // 否则暴力计算
-            for (size_t i = 0; i < numa.digits.size(); i++) {
-                for (size_t j = 0; j < numb.digits.size(); j++) {
-                    result.digits[i + j] += numa.digits[i] * numb.digits[j];
-                    if (result.digits[i + j] >= 10) {
-                        result.digits[i + j + 1] += result.digits[i + j] / 10;
-                        result.digits[i + j] %= 10;
-                    }
-                }
-            }
+    BigInt& operator*=(const BigInt& other) {
+        if (is_zero() || other.is_zero()) {
+            limbs.clear();
+            negative = false;
+            return *this;
+        }
+        negative = (negative != other.negative);
+        if (other.limbs.size() == 1) {
+            mul_add_small(other.limbs[0], 0);
+            return *this;
         }
-        result.negative = (negative != other.negative);
-        result.remove_leading_zeros();
-        result.mul_pow10(end_zeros);
 
-        return result;
+        // 乘积写入复用缓冲区后与 limbs 交换，两块缓冲区在循环中轮流使用；other 可以就是 *this
+        bigint_detail::ReusableBuffer<0> buffer;
+        std::vector<limb>& product = buffer.get();
+        const std::vector<limb>* a = &limbs;
+        const std::vector<limb>* b = &other.limbs;
+        if (a->size() < b->size()) std::swap(a, b);
+        product.resize(a->size() + b->size());
+        bigint_detail::mul(product.data(), a->data(), a->size(), b->data(), b->size());
+        limbs.swap(product);
+        remove_leading_zeros();
+        return *this;
     }
 
-    // 加法
-    BigInt operator+(const BigInt& other) const {
-        if (negative == other.negative) {
-            // 同号相加
-            BigInt result;
-            result.negative = negative;
-            result.digits.clear();
-            size_t maxn = other.digits.size();
-            if (digits.size() > other.digits.size()) maxn = digits.size();
-            result.digits.reserve(maxn + 1);
-            int carry = 0;
-            for (size_t i = 0; i < maxn || carry; ++i) {
-                carry += (i < digits.size() ? digits[i] : 0) + (i < other.digits.size() ? other.digits[i] : 0);
-                result.digits.push_back(carry % 10);
-                carry /= 10;
-            }
-            result.remove_leading_zeros();
-            return result;
+    BigInt& operator/=(const BigInt& other) {
+        if (other.is_zero()) {
+            throw std::runtime_error("Division by zero");
+        }
+        const bool quotient_negative = (negative != other.negative);
+        if (other.limbs.size() == 1) {
+            bigint_detail::divmod_1(limbs.data(), limbs.data(), limbs.size(), other.limbs[0]);
         } else {
-            // 异号相加，转换为减法
-            // a + (-b) = a - b
-            // (-a) + b = b - a
-            BigInt other_copy = other;
-            other_copy.negative = !other_copy.negative;
-            return *this - other_copy;
+            BigInt quotient, remainder;
+            divmod_abs(*this, other, quotient, remainder);
+            limbs.swap(quotient.limbs);
         }
+        negative = quotient_negative;
+        remove_leading_zeros();
+        return *this;
     }
 
-    // 减法
-    BigInt operator-(const BigInt& other) const {
-        if (negative != other.negative) {
-            // 异号相减
-            // a - (-b) = a + b
-            // (-a) - b = -(a + b)
-            BigInt other_copy = other;
-            other_copy.negative = !other_copy.negative;
-            return *this + other_copy;
+    // 余数与被除数同号
+    BigInt& operator%=(const BigInt& other) {
+        if (other.is_zero()) {
+            throw std::runtime_error("Modulo by zero");
         }
+        if (other.limbs.size() == 1) {
+            const limb rem = bigint_detail::divmod_1(limbs.data(), limbs.data(), limbs.size(), other.limbs[0]);
+            limbs.assign(rem ? 1 : 0, rem);
+        } else {
+            BigInt quotient, remainder;
+            divmod_abs(*this, other, quotient, remainder);
+            limbs.swap(remainder.limbs);
+        }
+        remove_leading_zeros();
+        return *this;
+    }
 
-        // 同号相减
-        auto p1 = this;
-        const BigInt* p2 = &other;
-        bool result_negative = negative;
+    // 与机器整数的复合赋值，不构造临时 BigInt
+    BigInt& operator+=(int64_t n) {
+        add_small_in_place(magnitude(n), n < 0);
+        return *this;
+    }
 
-        if (abs_compare(*p1, *p2) < 0) {
-            std::swap(p1, p2);
-            result_negative = !result_negative;
-        }
+    BigInt& operator-=(int64_t n) {
+        add_small_in_place(magnitude(n), n >= 0);
+        return *this;
+    }
 
-        BigInt result;
-        result.negative = result_negative;
-        result.digits.clear();
-        int borrow = 0, diff;
-        for (size_t i = 0; i < p1->digits.size(); ++i) {
-            diff = p1->digits[i] - (i < p2->digits.size() ? p2->digits[i] : 0) - borrow;
-            if (diff < 0) {
-                diff += 10;
-                borrow = 1;
-            } else {
-                borrow = 0;
-            }
-            result.digits.push_back(diff);
+    BigInt& operator*=(int64_t n) {
+        if (n == 0) {
+            limbs.clear();
+            negative = false;
+            return *this;
         }
-        result.remove_leading_zeros();
-        return result;
+        if (n < 0) negative = !negative;
+        mul_add_small(magnitude(n), 0);
+        remove_leading_zeros();
+        return *this;
     }
 
     // 比较绝对值大小
     static int abs_compare(const BigInt& a, const BigInt& b) {
-        if (a.digits.size() != b.digits.size()) {
-            return a.digits.size() < b.digits.size() ? -1 : 1;
-        }
-        for (size_t i = a.digits.size() - 1; i < a.digits.size(); --i) {
-            if (a.digits[i] != b.digits[i]) {
-                return a.digits[i] < b.digits[i] ? -1 : 1;
-            }
-        }
-        return 0;
+        return bigint_detail::cmp(a.limbs.data(), a.limbs.size(), b.limbs.data(), b.limbs.size());
     }
 
     // 转换为int（如果可能）
     [[nodiscard]] int to_int() const {
         if (is_zero()) return 0;
 
-        if (digits.size() > 10) {// 太大了
+        // 超出 int 范围时饱和
+        const limb limit = negative ? static_cast<limb>(INT_MAX) + 1 : static_cast<limb>(INT_MAX);
+        if (limbs.size() > 1 || limbs[0] >= limit) {
             return negative ? INT_MIN : INT_MAX;
         }
 
-        long long result = 0;
-
-        for (size_t i = digits.size() - 1; i < digits.size(); i--) {
-            result = result * 10 + digits[i];
-            if (!negative && result > INT_MAX) {
-                return INT_MAX;
-            }
-            // For negative numbers, the check is against -(long long)INT_MIN
-            if (negative && result > -static_cast<long long>(INT_MIN)) {
-                return INT_MIN;
-            }
-        }
-
-        if (negative) {
-            long long neg_res = -result;
-            if (neg_res < INT_MIN) return INT_MIN;
-            return static_cast<int>(neg_res);
-        }
-
-        return static_cast<int>(result);
+        const auto magnitude = static_cast<long long>(limbs[0]);
+        return static_cast<int>(negative ? -magnitude : magnitude);
     }
 
     // 检查是否为零
     [[nodiscard]] bool is_zero() const {
-        return digits.size() == 1 && digits[0] == 0;
+        return limbs.empty();
     }
 
-    // 除法（整数除法）
-    BigInt operator/(const BigInt& other) const {
-        if (other.is_zero()) {
-            throw std::runtime_error("Division by zero");
-        }
-
-        if (is_zero()) {
-            return BigInt(0);
-        }
-
-        // 使用长除法算法
-        BigInt dividend = *this;
-        dividend.negative = false;
-        BigInt divisor = other;
-        divisor.negative = false;
-
-        if (abs_compare(dividend, divisor) < 0) {
-            return BigInt(0);
-        }
-
-        BigInt quotient;
-        quotient.digits.clear();
+    // 检查是否为一
+    [[nodiscard]] bool is_one() const {
+        return !negative && limbs.size() == 1 && limbs[0] == 1;
+    }
 
-        BigInt current(0);
-        for (size_t i = dividend.digits.size() - 1; i < dividend.digits.size(); i--) {
-            current.digits.insert(current.digits.begin(), dividend.digits[i]);
-            current.remove_leading_zeros();
+    // 二进制位数，零为 0
+    [[nodiscard]] size_t bit_length() const {
+        if (is_zero()) return 0;
+        return limbs.size() * 64 - std::countl_zero(limbs.back());
+    }
 
-            int count = 0;
-            while (abs_compare(current, divisor) >= 0) {
-                current = current - divisor;
-                count++;
-            }
-            quotient.digits.insert(quotient.digits.begin(), count);
+    // 除法（整数除法，向零取整）
+    BigInt operator/(const BigInt& other) const& {
+        if (other.is_zero()) {
+            throw std::runtime_error("Division by zero");
         }
 
+        BigInt quotient, remainder;
+        divmod_abs(*this, other, quotient, remainder);
         quotient.negative = (negative != other.negative);
         quotient.remove_leading_zeros();
         return quotient;
     }
 
-    // 取模运算
-    BigInt operator%(const BigInt& other) const {
+    // 取模运算，余数与被除数同号
+    BigInt operator%(const BigInt& other) const& {
         if (other.is_zero()) {
             throw std::runtime_error("Modulo by zero");
         }
 
-        BigInt quotient = *this / other;
-        BigInt remainder = *this - (quotient * other);
+        BigInt quotient, remainder;
+        divmod_abs(*this, other, quotient, remainder);
+        remainder.negative = negative;
+        remainder.remove_leading_zeros();
         return remainder;
     }
 
-    //十进制左移运算，注意不是补0，而是忽略左边的n位,补0请使用mul_pow10;
-    BigInt operator<<(size_t n) const {
-        if (n >= digits.size()) return BigInt(0);
-        BigInt re = *this;
-        while (n) {
-            re.digits.pop_back();
-            n--;
-        }
-        while (!re.digits.back() and re.digits.size() > 1) re.digits.pop_back();
-        return re;
+    // 同时求商和余数，与 / 和 % 的结果一致：a = q·b + r
+    static std::pair<BigInt, BigInt> divmod(const BigInt& a, const BigInt& b) {
+        std::pair<BigInt, BigInt> result;
+        divmod(a, b, result.first, result.second);
+        return result;
     }
 
-    //十进制右移运算
-    BigInt operator>>(size_t n) const {
-        if (n >= digits.size()) return BigInt(0);
-        BigInt re = *this;
-        if (n == 0) return re;
-        for (size_t i = n; i < re.digits.size(); i++) {
-            re.digits[i - n] = re.digits[i];
+    // 同上，结果写入 q、r 并复用它们的缓冲区；q、r 可以与 a、b 是同一个对象
+    static void divmod(const BigInt& a, const BigInt& b, BigInt& q, BigInt& r) {
+        if (b.is_zero()) {
+            throw std::runtime_error("Division by zero");
         }
-        while (n) {
-            re.digits.pop_back();
-            n--;
+        if (&q == &a || &q == &b || &r == &a || &r == &b || &q == &r) {
+            BigInt quotient, remainder;
+            divmod(a, b, quotient, remainder);
+            q = std::move(quotient);
+            r = std::move(remainder);
+            return;
         }
-        return re;
+
+        const bool quotient_negative = (a.negative != b.negative);
+        const bool remainder_negative = a.negative;
+        divmod_abs(a, b, q, r);
+        q.negative = quotient_negative;
+        q.remove_leading_zeros();
+        r.negative = remainder_negative;
+        r.remove_leading_zeros();
     }
 
     // 幂运算
@@ -381,16 +1178,15 @@ public:
             return BigInt(0);
         }
 
+        // 从低位到高位扫描指数的二进制位
         BigInt result(1);
         BigInt base = *this;
-        BigInt exp = exponent;
-
-        while (!exp.is_zero()) {
-            if (exp.digits[0] % 2 == 1) {   // 如果指数是奇数
-                result = result * base;
+        const size_t bits = exponent.bit_length();
+        for (size_t i = 0; i < bits; ++i) {
+            if ((exponent.limbs[i / 64] >> (i % 64)) & 1) {
+                result *= base;
             }
-            base = base * base;
-            exp = exp / BigInt(2);
+            if (i + 1 < bits) base *= base;
         }
 
         return result;
@@ -401,29 +1197,38 @@ public:
         if (n.negative) {
             throw std::runtime_error("Factorial of negative number is undefined");
         }
-
-        if (n.is_zero() || (n.digits.size() == 1 && n.digits[0] == 1)) {
-            return BigInt(1);
+        if (n.limbs.size() > 1) {
+            throw std::runtime_error("Factorial argument is too large");
         }
 
-        BigInt result(1);
-        BigInt current(1);
-
-        while (abs_compare(current, n) <= 0) {
-            result = result * current;
-            current = current + BigInt(1);
+        const limb last = n.is_zero() ? 0 : n.limbs[0];
+        // 连续的小因子先在一个 limb 内相乘，放不下时另起一个，最后按乘积树两两相乘
+        std::vector<limb> factors;
+        limb pending = 1;
+        for (limb k = 2; k <= last; ++k) {
+            limb hi;
+            const limb lo = bigint_detail::mul_wide(pending, k, hi);
+            if (hi) {
+                factors.push_back(pending);
+                pending = k;
+            } else {
+                pending = lo;
+            }
         }
+        factors.push_back(pending);
 
-        return result;
+        return product(factors, 0, factors.size());
     }
 
     // 比较运算符
     bool operator<(const BigInt& other) const {
-        if (negative != other.negative) {
-            return negative > other.negative;   // 负数小于正数
+        const bool lneg = negative && !is_zero();
+        const bool rneg = other.negative && !other.is_zero();
+        if (lneg != rneg) {
+            return lneg;   // 负数小于正数
         }
 
-        if (negative) {
+        if (lneg) {
             // 两个都是负数，绝对值大的反而小
             return abs_compare(*this, other) > 0;
         } else {
@@ -433,11 +1238,11 @@ public:
     }
 
     bool operator<=(const BigInt& other) const {
-        return *this < other || *this == other;
+        return !(other < *this);
     }
 
     bool operator>(const BigInt& other) const {
-        return !(*this <= other);
+        return other < *this;
     }
 
     bool operator>=(const BigInt& other) const {
@@ -445,7 +1250,7 @@ public:
     }
 
     bool operator==(const BigInt& other) const {
-        return negative == other.negative && digits == other.digits;
+        return limbs == other.limbs && (is_zero() || negative == other.negative);
     }
 
     bool operator!=(const BigInt& other) const {
@@ -473,7 +1278,7 @@ public:
     // Square root using Newton's method for integer square root
     // Returns the floor of the square root
     [[nodiscard]] BigInt sqrt() const {
-        if (negative) {
+        if (negative && !is_zero()) {
             throw std::runtime_error("Square root of negative BigInt is undefined");
         }
 
@@ -481,18 +1286,25 @@ public:
             return BigInt(0);
         }
 
-        if (digits.size() == 1 && digits[0] == 1) {
+        if (is_one()) {
             return BigInt(1);
         }
 
         // Newton's method for integer square root
-        // Start with an initial guess
-        BigInt x = *this;
-        BigInt y = (*this + BigInt(1)) / BigInt(2);
-
+        // Start from 2^ceil(bits/2), which is never below the root
+        BigInt x = power_of_two((bit_length() + 1) / 2);
+        const BigInt two(2);
+        BigInt y, r;
+        divmod(*this, x, y, r);
+        y += x;
+        y /= two;
+
+        // 每轮 y = (x + n / x) / 2，商和余数写回复用的 y、r
         while (y < x) {
-            x = y;
-            y = (x + (*this / x)) / BigInt(2);
+            std::swap(x, y);
+            divmod(*this, x, y, r);
+            y += x;
+            y /= two;
         }
 
         return x;
@@ -500,7 +1312,7 @@ public:
 
     // Check if this BigInt is a perfect square
     [[nodiscard]] bool is_perfect_square() const {
-        if (negative) {
+        if (negative && !is_zero()) {
             return false;
         }
 
@@ -523,11 +1335,14 @@ public:
         BigInt abs_a = a.abs();
         BigInt abs_b = b.abs();
 
-        if (abs_b.is_zero()) {
-            return abs_a;
+        // 商和余数写进复用的 q、r，三个缓冲区轮换，循环中不再分配
+        BigInt q, r;
+        while (!abs_b.is_zero()) {
+            divmod(abs_a, abs_b, q, r);
+            std::swap(abs_a, abs_b);
+            std::swap(abs_b, r);
         }
-
-        return gcd(abs_b, abs_a % abs_b);
+        return abs_a;
     }
 
     // Least Common Multiple
@@ -536,8 +1351,10 @@ public:
             return BigInt(0);
         }
 
-        BigInt gcd_val = gcd(a, b);
-        return (a.abs() / gcd_val) * b.abs();
+        BigInt result = a.abs() / gcd(a, b);
+        result *= b;
+        result.negative = false;
+        return result;
     }
 
     // Convert to double (with potential precision loss warning)
@@ -546,20 +1363,362 @@ public:
             return 0.0;
         }
 
-        double result = 0.0;
-        double multiplier = 1.0;
+        // 最高两个 limb 已覆盖 double 的全部有效位
+        const size_t n = limbs.size();
+        double top = static_cast<double>(limbs[n - 1]);
+        if (n > 1) top += std::ldexp(static_cast<double>(limbs[n - 2]), -64);
+        double result = std::ldexp(top, static_cast<int>(std::min<size_t>(n - 1, INT_MAX / 64) * 64));
+
+        // Check for overflow - use a large but finite value
+        if (std::isinf(result)) {
+            result = std::numeric_limits<double>::max();
+        }
 
-        for (size_t i = 0; i < digits.size(); ++i) {
-            result += digits[i] * multiplier;
-            multiplier *= 10.0;
+        return negative ? -result : result;
+    }
 
-            // Check for overflow - use a large but finite value
-            if (multiplier > 1e308) {
-                // Precision loss will occur
-                break;
+private:
+    // 一个 limb 能放下的最大 10 的幂：10^19
+    static constexpr int decimal_chunk_digits = 19;
+    static constexpr limb decimal_chunk_base = 10000000000000000000ull;
+    // 超过该 limb 数时十进制转换改用分治
+    static constexpr size_t decimal_split_threshold = 40;
+    // 超过该位数的十进制字符串按分治解析
+    static constexpr size_t decimal_parse_split_digits = decimal_chunk_digits * decimal_split_threshold;
+    // 除数与商都超过该 limb 数时用牛顿法倒数做除法，否则用 Knuth 算法 D
+    static constexpr size_t newton_threshold = 400;
+
+    // *this = |*this| * m + a（保留符号）
+    void mul_add_small(limb m, limb a) {
+        limb carry = a;
+        for (auto& l: limbs) {
+            limb hi;
+            limb lo = bigint_detail::mul_wide(l, m, hi);
+            lo += carry;
+            hi += lo < carry;
+            l = lo;
+            carry = hi;
+        }
+        if (carry) limbs.push_back(carry);
+    }
+
+    // factors[lo..hi) 之积；两半长度相近，让大数乘法落在长度相当的操作数上。
+    // 每个因子占一个 limb，区间长度即可估计乘积的 limb 数
+    static BigInt product(const std::vector<limb>& factors, size_t lo, size_t hi) {
+        if (hi - lo == 1) {
+            BigInt result;
+            result.limbs.push_back(factors[lo]);
+            return result;
+        }
+        const size_t mid = lo + (hi - lo) / 2;
+        if (hi - lo < bigint_detail::parallel_mul_threshold) {
+            return product(factors, lo, mid) * product(factors, mid, hi);
+        }
+        // 两半的乘积互相独立，交给线程池并发计算
+        BigInt left, right;
+        bigint_detail::parallel_invoke([&] { left = product(factors, lo, mid); },
+                                       [&] { right = product(factors, mid, hi); });
+        left *= right;
+        return left;
+    }
+
+    static BigInt power_of_two(size_t k) {
+        BigInt result;
+        result.limbs.assign(k / 64 + 1, 0);
+        result.limbs.back() = limb(1) << (k % 64);
+        return result;
+    }
+
+    // 按无符号绝对值取，INT64_MIN 也不会溢出
+    static limb magnitude(int64_t n) {
+        return n < 0 ? 0 - static_cast<limb>(n) : static_cast<limb>(n);
+    }
+
+    // *this += (b_negative ? -|b| : |b|)，b 可以就是 *this
+    void add_in_place(const BigInt& b, bool b_negative) {
+        if (this == &b) {
+            if (negative == b_negative) {
+                mul_add_small(2, 0);
+            } else {
+                limbs.clear();
+                negative = false;
             }
+            return;
         }
 
-        return negative ? -result : result;
+        const size_t bn = b.limbs.size();
+        if (negative == b_negative || is_zero()) {
+            // 同号（或 *this 为零）：绝对值相加
+            if (limbs.size() < bn) limbs.resize(bn, 0);
+            const limb carry = bigint_detail::add(limbs.data(), limbs.data(), limbs.size(), b.limbs.data(), bn);
+            if (carry) limbs.push_back(carry);
+            negative = b_negative;
+            if (is_zero()) negative = false;
+            return;
+        }
+
+        // 异号：大绝对值减小绝对值，符号随大的一方
+        const size_t n = limbs.size();
+        if (bigint_detail::cmp(limbs.data(), n, b.limbs.data(), bn) >= 0) {
+            bigint_detail::sub(limbs.data(), limbs.data(), n, b.limbs.data(), bn);
+        } else {
+            limbs.resize(bn, 0);
+            bigint_detail::sub(limbs.data(), b.limbs.data(), bn, limbs.data(), n);
+            negative = b_negative;
+        }
+        remove_leading_zeros();
+    }
+
+    // *this += (m_negative ? -m : m)
+    void add_small_in_place(limb m, bool m_negative) {
+        if (m == 0) return;
+        if (negative == m_negative || is_zero()) {
+            negative = m_negative;
+            limbs.push_back(0);
+            bigint_detail::add(limbs.data(), limbs.data(), limbs.size(), &m, 1);
+            remove_leading_zeros();
+            return;
+        }
+        if (limbs.size() > 1 || limbs[0] >= m) {
+            bigint_detail::sub(limbs.data(), limbs.data(), limbs.size(), &m, 1);
+        } else {
+            limbs[0] = m - limbs[0];
+            negative = m_negative;
+        }
+        remove_leading_zeros();
+    }
+
+    // a + (b_negative ? -|b| : |b|)
+    static BigInt add_signed(const BigInt& a, const BigInt& b, bool b_negative) {
+        BigInt result;
+        if (a.negative == b_negative) {
+            // 同号：绝对值相加
+            const BigInt* x = &a;
+            const BigInt* y = &b;
+            if (x->limbs.size() < y->limbs.size()) std::swap(x, y);
+            result.limbs.resize(x->limbs.size() + 1);
+            result.limbs.back() = bigint_detail::add(result.limbs.data(), x->limbs.data(), x->limbs.size(),
+                                                     y->limbs.data(), y->limbs.size());
+            result.negative = a.negative;
+        } else {
+            // 异号：大绝对值减小绝对值，符号随大的一方
+            const int c = abs_compare(a, b);
+            if (c == 0) return result;
+            const BigInt* x = c > 0 ? &a : &b;
+            const BigInt* y = c > 0 ? &b : &a;
+            result.limbs.resize(x->limbs.size());
+            bigint_detail::sub(result.limbs.data(), x->limbs.data(), x->limbs.size(), y->limbs.data(), y->limbs.size());
+            result.negative = c > 0 ? a.negative : b_negative;
+        }
+        result.remove_leading_zeros();
+        return result;
+    }
+
+    // 十进制数字 p[0..n) 的值：较短时每 19 位做一次 limbs = limbs * 10^19 + chunk，
+    // 较长时与 to_string 相同按 powers[k] = 10^(19·2^k) 分治，高半部分乘以 10 的幂后加上低半部分
+    static BigInt parse_decimal(const char* p, size_t n) {
+        if (n <= decimal_parse_split_digits) return parse_decimal_basecase(p, n);
+        std::vector<BigInt> powers(1);
+        powers[0].limbs.push_back(decimal_chunk_base);
+        while ((static_cast<size_t>(decimal_chunk_digits) << powers.size()) < n) {
+            powers.push_back(powers.back() * powers.back());
+        }
+        return parse_decimal_split(p, n, powers);
+    }
+
+    static BigInt parse_decimal_basecase(const char* p, size_t n) {
+        BigInt result;
+        limb chunk = 0, scale = 1;
+        int count = 0;
+        for (size_t i = 0; i < n; ++i) {
+            chunk = chunk * 10 + static_cast<limb>(p[i] - '0');
+            scale *= 10;
+            if (++count == decimal_chunk_digits) {
+                result.mul_add_small(scale, chunk);
+                chunk = 0;
+                scale = 1;
+                count = 0;
+            }
+        }
+        if (count) result.mul_add_small(scale, chunk);
+        result.remove_leading_zeros();
+        return result;
+    }
+
+    // 低半部分取 19·2^level 位，level 取使其少于 n 的最大值，高半部分不长于低半部分
+    static BigInt parse_decimal_split(const char* p, size_t n, const std::vector<BigInt>& powers) {
+        if (n <= decimal_parse_split_digits) return parse_decimal_basecase(p, n);
+        size_t level = powers.size() - 1;
+        while ((static_cast<size_t>(decimal_chunk_digits) << level) >= n) --level;
+        const size_t low_digits = static_cast<size_t>(decimal_chunk_digits) << level;
+        BigInt result = parse_decimal_split(p, n - low_digits, powers);
+        result *= powers[level];
+        result += parse_decimal_split(p + n - low_digits, low_digits, powers);
+        return result;
+    }
+
+    // 非负数 rest 的十进制追加到 out，不足 width 位时补前导零
+    static void append_decimal(std::vector<limb> rest, size_t width, std::string& out) {
+        // 反复除以 10^19，得到低位在前的十进制分组
+        std::vector<limb> chunks;
+        size_t n = rest.size();
+        while (n > 0) {
+            chunks.push_back(bigint_detail::divmod_1(rest.data(), rest.data(), n, decimal_chunk_base));
+            while (n > 0 && rest[n - 1] == 0) --n;
+        }
+
+        const size_t start = out.size();
+        if (!chunks.empty()) {
+            out += std::to_string(chunks.back());
+            const size_t head = out.size();
+            out.resize(head + (chunks.size() - 1) * decimal_chunk_digits);
+            char* p = out.data() + head;
+            for (size_t i = chunks.size() - 1; i-- > 0;) {
+                limb c = chunks[i];
+                for (int k = decimal_chunk_digits - 1; k >= 0; --k) {
+                    p[k] = static_cast<char>('0' + c % 10);
+                    c /= 10;
+                }
+                p += decimal_chunk_digits;
+            }
+        }
+        const size_t written = out.size() - start;
+        if (written < width) out.insert(start, width - written, '0');
+    }
+
+    // 要求 0 <= x < powers[level]^2：按 powers[level] 拆成高低两半递归转换
+    static void append_decimal_split(const BigInt& x, const std::vector<BigInt>& powers, size_t level, size_t width, std::string& out) {
+        if (level == 0 || x.limbs.size() < decimal_split_threshold) {
+            append_decimal(x.limbs, width, out);
+            return;
+        }
+
+        auto [high, low] = divmod(x, powers[level]);
+        if (high.is_zero()) {
+            append_decimal_split(low, powers, level - 1, width, out);
+            return;
+        }
+        const size_t low_digits = static_cast<size_t>(decimal_chunk_digits) << level;
+        append_decimal_split(high, powers, level - 1, width > low_digits ? width - low_digits : 0, out);
+        append_decimal_split(low, powers, level - 1, low_digits, out);
+    }
+
+    // |a| 左移 k 位
+    static BigInt shifted_left(const BigInt& a, size_t k) {
+        BigInt result;
+        if (a.is_zero()) return result;
+        const size_t whole = k / 64;
+        const int bits = static_cast<int>(k % 64);
+        result.limbs.assign(a.limbs.size() + whole + 1, 0);
+        for (size_t i = 0; i < a.limbs.size(); ++i) {
+            result.limbs[i + whole] |= a.limbs[i] << bits;
+            if (bits) result.limbs[i + whole + 1] = a.limbs[i] >> (64 - bits);
+        }
+        result.remove_leading_zeros();
+        return result;
+    }
+
+    // |a| 的第 [k, k + len) 位，len 为 SIZE_MAX 时取到最高位
+    static BigInt bit_range(const BigInt& a, size_t k, size_t len = SIZE_MAX) {
+        BigInt result;
+        const size_t whole = k / 64;
+        if (whole >= a.limbs.size()) return result;
+        const int bits = static_cast<int>(k % 64);
+        result.limbs.resize(a.limbs.size() - whole);
+        for (size_t i = 0; i < result.limbs.size(); ++i) {
+            result.limbs[i] = a.limbs[i + whole] >> bits;
+            if (bits && i + whole + 1 < a.limbs.size()) result.limbs[i] |= a.limbs[i + whole + 1] << (64 - bits);
+        }
+        if (len / 64 < result.limbs.size()) {
+            result.limbs.resize(len / 64 + 1);
+            result.limbs.back() &= (limb(1) << (len % 64)) - 1;
+        }
+        result.remove_leading_zeros();
+        return result;
+    }
+
+    // 恰有 n 位的 d 的倒数 floor(2^(2n) / d)。
+    // 先递归求高 h 位的倒数作初值，一步牛顿迭代把精度翻倍，最后用余数精确修正
+    static BigInt reciprocal(const BigInt& d, size_t n) {
+        BigInt one = power_of_two(2 * n);
+        if (d.limbs.size() < newton_threshold) {
+            BigInt q, r;
+            divmod_abs(one, d, q, r);
+            return q;
+        }
+
+        const size_t h = n / 2 + 4;
+        BigInt x = shifted_left(reciprocal(bit_range(d, n - h), h), n - h);
+        // x += x·(2^(2n) - d·x) / 2^(2n)
+        const BigInt e = one - d * x;
+        BigInt step = bit_range(x * e, 2 * n);
+        if (!step.is_zero()) step.negative = e.negative;
+        x += step;
+
+        BigInt r = one - d * x;
+        while (r.negative) {
+            x -= 1;
+            r += d;
+        }
+        while (abs_compare(r, d) >= 0) {
+            x += 1;
+            r -= d;
+        }
+        return x;
+    }
+
+    // 牛顿法除法：用除数（n 位）的倒数，把被除数按 n 位一段从高到低逐段求商
+    static void divmod_newton(const BigInt& a, const BigInt& divisor, BigInt& q, BigInt& r) {
+        const BigInt b = divisor.abs();
+        const size_t n = b.bit_length();
+        const BigInt y = reciprocal(b, n);
+        const size_t pieces = (a.bit_length() + n - 1) / n;
+
+        q.limbs.assign(pieces * n / 64 + 2, 0);
+        r = BigInt();
+        for (size_t i = pieces; i-- > 0;) {
+            // cur < b·2^n <= 2^(2n)，估商至多偏小 2
+            const BigInt cur = shifted_left(r, n) + bit_range(a, i * n, n);
+            BigInt qi = bit_range(cur * y, 2 * n);
+            r = cur - qi * b;
+            while (abs_compare(r, b) >= 0) {
+                qi += 1;
+                r -= b;
+            }
+            // 各段商不超过 n 位，互不重叠，直接拼到 q 的第 i·n 位上
+            const size_t whole = i * n / 64;
+            const int bits = static_cast<int>(i * n % 64);
+            for (size_t k = 0; k < qi.limbs.size(); ++k) {
+                q.limbs[whole + k] |= qi.limbs[k] << bits;
+                if (bits) q.limbs[whole + k + 1] |= qi.limbs[k] >> (64 - bits);
+            }
+        }
+        q.remove_leading_zeros();
+    }
+
+    // |a| = q·|b| + r，q、r 均非负；要求 b 非零
+    static void divmod_abs(const BigInt& a, const BigInt& b, BigInt& q, BigInt& r) {
+        q.limbs.clear();
+        r.limbs.clear();
+        q.negative = r.negative = false;
+        if (abs_compare(a, b) < 0) {
+            r.limbs = a.limbs;
+            return;
+        }
+
+        const size_t an = a.limbs.size(), bn = b.limbs.size();
+        if (bn == 1) {
+            q.limbs.resize(an);
+            const limb rem = bigint_detail::divmod_1(q.limbs.data(), a.limbs.data(), an, b.limbs[0]);
+            if (rem) r.limbs.push_back(rem);
+        } else if (bn >= newton_threshold && an - bn >= newton_threshold) {
+            divmod_newton(a, b, q, r);
+        } else {
+            q.limbs.resize(an - bn + 1);
+            r.limbs.resize(bn);
+            bigint_detail::divmod_knuth(q.limbs.data(), r.limbs.data(), a.limbs.data(), an, b.limbs.data(), bn);
+        }
+        q.remove_leading_zeros();
+        r.remove_leading_zeros();
     }
 };
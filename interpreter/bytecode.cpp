@@ -0,0 +1,296 @@
+#include "bytecode.hpp"
+#include "interpreter.hpp"
+#include <unordered_map>
+
+int Chunk::add_constant(const Value& v) {
+    constants.push_back(v);
+    return static_cast<int>(constants.size() - 1);
+}
+
+int Chunk::add_name(const std::string& name) {
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (names[i] == name) return static_cast<int>(i);
+    }
+    names.push_back(name);
+    return static_cast<int>(names.size() - 1);
+}
+
+int Chunk::emit(OpCode op, int32_t a, int32_t b) {
+    code.push_back({op, a, b});
+    return static_cast<int>(code.size() - 1);
+}
+
+namespace {
+
+// 单个 Chunk 的编译上下文
+class ChunkCompiler {
+public:
+    ChunkCompiler(Chunk& chunk, const FuncDefStmt* func) : chunk(chunk), func(func) {}
+
+    void compile_statement(const Statement* node);
+    void compile_expression(const Expression* node);
+
+private:
+    struct LoopContext {
+        int start;
+        std::vector<int> breaks;
+    };
+
+    Chunk& chunk;
+    const FuncDefStmt* func;
+    std::vector<LoopContext> loops;
+
+    void compile_block(const BlockStmt* block) {
+        if (!block) return;
+        for (const auto& stmt: block->statements) compile_statement(stmt.get());
+    }
+
+    static void check_resolved(const Binding& binding, const std::string& name) {
+        if (binding.scope == Binding::Scope::Unresolved) {
+            throw RuntimeError("Unresolved variable '" + name + "' in bytecode compiler");
+        }
+    }
+
+    void emit_store(const Binding& binding, const std::string& name) {
+        check_resolved(binding, name);
+        chunk.emit(binding.scope == Binding::Scope::Local ? OpCode::StoreLocal : OpCode::StoreGlobal, binding.index);
+    }
+
+    void emit_load(const Binding& binding, const std::string& name) {
+        check_resolved(binding, name);
+        chunk.emit(binding.scope == Binding::Scope::Local ? OpCode::LoadLocal : OpCode::LoadGlobal,
+                   binding.index, chunk.add_name(name));
+    }
+
+    int local_slot(const std::string& name) const {
+        if (!func) return -1;
+        for (size_t i = 0; i < func->locals.size(); ++i) {
+            if (func->locals[i] == name) return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    void patch_jump(int at) {
+        chunk.code[at].a = static_cast<int32_t>(chunk.code.size());
+    }
+};
+
+// OpCode::Add ... OpCode::Ge 与 BinaryOp 顺序一致
+OpCode binary_opcode(BinaryOp op) {
+    return static_cast<OpCode>(static_cast<int>(OpCode::Add) + static_cast<int>(op));
+}
+
+void ChunkCompiler::compile_expression(const Expression* node) {
+    if (!node) {
+        chunk.emit(OpCode::Const, chunk.add_constant(Value()));
+        return;
+    }
+    switch (node->kind) {
+        case NodeKind::LiteralExpr: {
+            auto* lit = static_cast<const LiteralExpr*>(node);
+            if (!lit->decoded) {
+                throw RuntimeError("Invalid literal '" + lit->value + "'");
+            }
+            chunk.emit(OpCode::Const, chunk.add_constant(lit->cached));
+            break;
+        }
+        case NodeKind::IdentifierExpr: {
+            auto* id = static_cast<const IdentifierExpr*>(node);
+            emit_load(id->binding, id->name);
+            break;
+        }
+        case NodeKind::VarExpr: {
+            auto* var = static_cast<const VarExpr*>(node);
+            emit_load(var->binding, var->name);
+            break;
+        }
+        case NodeKind::BinaryExpr: {
+            auto* bin = static_cast<const BinaryExpr*>(node);
+            compile_expression(bin->left.get());
+            compile_expression(bin->right.get());
+            chunk.emit(binary_opcode(bin->op));
+            break;
+        }
+        case NodeKind::UnaryExpr: {
+            auto* unary = static_cast<const UnaryExpr*>(node);
+            compile_expression(unary->operand.get());
+            chunk.emit(unary->op == UnaryOp::Neg ? OpCode::Neg : OpCode::Fact);
+            break;
+        }
+        case NodeKind::CallExpr: {
+            auto* call = static_cast<const CallExpr*>(node);
+            for (const auto& arg: call->args) compile_expression(arg.get());
+            chunk.calls.push_back({chunk.add_name(call->callee), static_cast<int32_t>(call->args.size()),
+                                   local_slot(call->callee), call->span.line, {}});
+            chunk.emit(OpCode::Call, static_cast<int32_t>(chunk.calls.size() - 1));
+            break;
+        }
+        case NodeKind::ArrayExpr: {
+            auto* arr = static_cast<const ArrayExpr*>(node);
+            for (const auto& element: arr->elements) compile_expression(element.get());
+            chunk.emit(OpCode::BuildArray, static_cast<int32_t>(arr->elements.size()));
+            break;
+        }
+        default:
+            throw RuntimeError("Unsupported expression type in bytecode compiler");
+    }
+}
+
+void ChunkCompiler::compile_statement(const Statement* node) {
+    if (!node) return;
+    switch (node->kind) {
+        case NodeKind::VarDeclStmt: {
+            auto* v = static_cast<const VarDeclStmt*>(node);
+            if (!v->expr) {
+                throw RuntimeError("Variable '" + v->name + "' declaration has null expression");
+            }
+            compile_expression(v->expr.get());
+            emit_store(v->binding, v->name);
+            break;
+        }
+        case NodeKind::AssignStmt: {
+            auto* a = static_cast<const AssignStmt*>(node);
+            const auto operands = a->append_operands();
+            if (!operands.empty()) {
+                emit_load(a->binding, a->name);
+                for (const Expression* operand: operands) compile_expression(operand);
+                chunk.emit(a->binding.scope == Binding::Scope::Local ? OpCode::AppendLocal : OpCode::AppendGlobal,
+                           a->binding.index, static_cast<int32_t>(operands.size()));
+                break;
+            }
+            compile_expression(a->expr.get());
+            emit_store(a->binding, a->name);
+            break;
+        }
+        case NodeKind::DefineStmt: {
+            // define 只求值，不产生绑定（与树遍历解释器一致）
+            compile_expression(static_cast<const DefineStmt*>(node)->value.get());
+            chunk.emit(OpCode::Pop);
+            break;
+        }
+        case NodeKind::BigIntDeclStmt: {
+            auto* bi = static_cast<const BigIntDeclStmt*>(node);
+            if (bi->init_value) {
+                compile_expression(bi->init_value.get());
+                chunk.emit(OpCode::ToBigInt, chunk.add_name(bi->name));
+            } else {
+                chunk.emit(OpCode::Const, chunk.add_constant(Value(::BigInt(0))));
+            }
+            emit_store(bi->binding, bi->name);
+            break;
+        }
+        case NodeKind::StructDeclStmt: {
+            auto* s = static_cast<const StructDeclStmt*>(node);
+            // 字段名连续存放在名字表中，不做去重
+            int first_name = static_cast<int>(chunk.names.size());
+            for (const auto& [n, e]: s->init_vec) chunk.names.push_back(n);
+            for (const auto& [n, e]: s->init_vec) compile_expression(e.get());
+            chunk.emit(OpCode::BuildStruct, static_cast<int32_t>(s->init_vec.size()), first_name);
+            emit_store(s->binding, s->name);
+            break;
+        }
+        case NodeKind::IfStmt: {
+            auto* ifs = static_cast<const IfStmt*>(node);
+            compile_expression(ifs->condition.get());
+            int to_else = chunk.emit(OpCode::JumpIfFalse);
+            compile_block(ifs->thenBlock.get());
+            if (ifs->elseBlock) {
+                int to_end = chunk.emit(OpCode::Jump);
+                patch_jump(to_else);
+                compile_block(ifs->elseBlock.get());
+                patch_jump(to_end);
+            } else {
+                patch_jump(to_else);
+            }
+            break;
+        }
+        case NodeKind::WhileStmt: {
+            auto* ws = static_cast<const WhileStmt*>(node);
+            int start = static_cast<int>(chunk.code.size());
+            loops.push_back({start, {}});
+            compile_expression(ws->condition.get());
+            int to_end = chunk.emit(OpCode::JumpIfFalse);
+            chunk.handlers.push_back({start, to_end + 1, 0, HandlerKind::LoopCond});
+            compile_block(ws->body.get());
+            chunk.emit(OpCode::Jump, start);
+            patch_jump(to_end);
+            for (int at: loops.back().breaks) patch_jump(at);
+            loops.pop_back();
+            chunk.handlers.push_back({start, static_cast<int32_t>(chunk.code.size()), 0, HandlerKind::LoopBody});
+            break;
+        }
+        case NodeKind::FuncDefStmt: {
+            chunk.functions.push_back(static_cast<const FuncDefStmt*>(node));
+            chunk.emit(OpCode::DefFunc, static_cast<int32_t>(chunk.functions.size() - 1));
+            break;
+        }
+        case NodeKind::BlockStmt:
+            compile_block(static_cast<const BlockStmt*>(node));
+            break;
+        case NodeKind::ReturnStmt: {
+            auto* ret = static_cast<const ReturnStmt*>(node);
+            compile_expression(ret->expr.get());
+            if (func && ret->tail_call) {
+                // 表达式末尾就是这次调用；TailCall 退化为普通调用时由随后的 Return 返回
+                chunk.code.back().op = OpCode::TailCall;
+                chunk.emit(OpCode::Return);
+            } else {
+                chunk.emit(func ? OpCode::Return : OpCode::ThrowReturn);
+            }
+            break;
+        }
+        case NodeKind::BreakStmt:
+            if (loops.empty()) {
+                chunk.emit(OpCode::ThrowBreak);
+            } else {
+                loops.back().breaks.push_back(chunk.emit(OpCode::Jump));
+            }
+            break;
+        case NodeKind::ContinueStmt:
+            if (loops.empty()) {
+                chunk.emit(OpCode::ThrowContinue);
+            } else {
+                chunk.emit(OpCode::Jump, loops.back().start);
+            }
+            break;
+        case NodeKind::IncludeStmt:
+            chunk.emit(OpCode::Include, chunk.add_name(static_cast<const IncludeStmt*>(node)->module));
+            break;
+        case NodeKind::ExprStmt: {
+            int start = static_cast<int>(chunk.code.size());
+            compile_expression(static_cast<const ExprStmt*>(node)->expr.get());
+            chunk.emit(OpCode::Pop);
+            int end = static_cast<int>(chunk.code.size());
+            chunk.handlers.push_back({start, end, end, HandlerKind::ExprStmt});
+            break;
+        }
+        case NodeKind::NullStmt:
+        default:
+            break;
+    }
+}
+
+}// namespace
+
+CompiledProgram Compiler::compile_program(const BlockStmt* block) {
+    CompiledProgram program;
+    for (const auto& stmt: block->statements) {
+        Chunk chunk;
+        ChunkCompiler(chunk, nullptr).compile_statement(stmt.get());
+        chunk.emit(OpCode::ReturnNull);
+        program.statements.push_back(std::move(chunk));
+    }
+    return program;
+}
+
+CompiledFunction Compiler::compile_function(const FuncDefStmt* func) {
+    CompiledFunction compiled;
+    compiled.name = func->name;
+    compiled.slot_count = func->locals.size();
+    compiled.param_slots = func->param_slots;
+
+    ChunkCompiler compiler(compiled.chunk, func);
+    for (const auto& stmt: func->body->statements) compiler.compile_statement(stmt.get());
+    compiled.chunk.emit(OpCode::ReturnNull);
+    return compiled;
+}
@@ -0,0 +1,127 @@
+#pragma once
+#include "ast.hpp"
+#include "value.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifdef LAMINA_CORE_EXPORTS
+#define LAMINA_API __declspec(dllexport)
+#else
+#define LAMINA_API __declspec(dllimport)
+#endif
+#else
+#define LAMINA_API
+#endif
+
+/*
+    字节码定义与编译器：把 Parser::parse 得到的 AST 降级为紧凑的字节码，
+    由 vm.hpp 中的 VM 以分派循环执行
+ */
+
+enum class OpCode : uint8_t {
+    Const,       // a = 常量池下标
+    LoadLocal,   // a = 局部槽位；槽位未赋值时按 b（名字下标）回退到按名查找
+    StoreLocal,  // a = 局部槽位
+    LoadGlobal,  // a = 全局表下标；未定义时按 b（名字下标）回退到按名查找
+    StoreGlobal, // a = 全局表下标
+    AppendLocal, // a = 局部槽位，b = 操作数个数；x = x + e1 ...：弹出各 e 与 x 的旧值，字符串、BigInt 原地累加后写回
+    AppendGlobal,// a = 全局表下标，b 同上；同 AppendLocal
+    Pop,
+    // 二元运算，顺序与 BinaryOp 一致
+    Add,
+    Sub,
+    Mul,
+    Div,
+    Mod,
+    Pow,
+    Eq,
+    Ne,
+    Lt,
+    Le,
+    Gt,
+    Ge,
+    // 一元运算
+    Neg,
+    Fact,
+    BuildArray, // a = 元素个数
+    BuildStruct,// a = 字段个数，b = 字段名列表在名字表中的起始下标
+    ToBigInt,   // a = 变量名下标（用于报错）
+    Jump,       // a = 目标地址
+    JumpIfFalse,// a = 目标地址，弹出条件
+    Call,       // a = 调用点下标
+    TailCall,   // a = 调用点下标；调用用户函数时复用当前帧并返回其结果，当前帧可能被按名读到时按 Call 执行
+    DefFunc,    // a = 函数表下标
+    Include,    // a = 模块名下标
+    Return,
+    ReturnNull,
+    ThrowReturn,  // 函数外的 return
+    ThrowBreak,   // 循环外的 break
+    ThrowContinue,// 循环外的 continue
+};
+
+struct Instruction {
+    OpCode op;
+    int32_t a = 0;
+    int32_t b = 0;
+};
+
+// 调用点：被调名字、参数个数，以及被调名字对应的局部槽位（无则为 -1）
+struct CallSite {
+    int32_t name;
+    int32_t argc;
+    int32_t slot;
+    // 调用所在的源码行，写入调用栈用于错误回溯
+    uint32_t line;
+    // 被调目标缓存，由 Interpreter::resolve_callee 维护
+    mutable CallCache cache;
+};
+
+// 异常处理区间，复现树遍历解释器中 ExprStmt / while 的 try-catch 行为
+enum class HandlerKind : uint8_t {
+    ExprStmt, // 打印错误后跳到 target 继续执行
+    LoopCond, // 包装为 "Loop condition error: ..."
+    LoopBody, // 包装为 "Loop body execution error: ..."
+};
+
+struct Handler {
+    int32_t start;// 区间 [start, end)
+    int32_t end;
+    int32_t target;
+    HandlerKind kind;
+};
+
+// 一段可执行的字节码及其常量池
+struct Chunk {
+    std::vector<Instruction> code;
+    std::vector<Value> constants;
+    std::vector<std::string> names;
+    std::vector<CallSite> calls;
+    std::vector<const FuncDefStmt*> functions;
+    std::vector<Handler> handlers;// 内层区间在前
+
+    int add_constant(const Value& v);
+    int add_name(const std::string& name);
+    int emit(OpCode op, int32_t a = 0, int32_t b = 0);
+};
+
+// 编译后的函数，槽位布局沿用 Resolver 写入 FuncDefStmt 的结果
+struct CompiledFunction {
+    std::string name;
+    size_t slot_count = 0;
+    std::vector<int> param_slots;
+    Chunk chunk;
+};
+
+// 编译后的脚本：每条顶层语句单独成段，便于逐条报错后继续执行
+struct CompiledProgram {
+    std::vector<Chunk> statements;
+};
+
+class LAMINA_API Compiler {
+public:
+    static CompiledProgram compile_program(const BlockStmt* block);
+    // 要求 AST 已经过 Resolver 处理
+    static CompiledFunction compile_function(const FuncDefStmt* func);
+};
@@ -0,0 +1,227 @@
+#include "closure.hpp"
+#include "lamina.hpp"
+
+#include <exception>
+#include <iostream>
+
+std::shared_ptr<const ClosureBlock> ClosureCompiler::compile(const BlockStmt& body) {
+    return std::make_shared<const ClosureBlock>(compile_block(body.statements));
+}
+
+ClosureBlock ClosureCompiler::compile_block(const std::vector<std::unique_ptr<Statement>>& statements) {
+    ClosureBlock block;
+    block.statements.reserve(statements.size());
+    for (const auto& stmt: statements) {
+        block.statements.push_back(compile_statement(stmt.get()));
+    }
+    return block;
+}
+
+ClosureExpr ClosureCompiler::compile_expression(const Expression* node) {
+    // 空节点和未特化的节点交给 Interpreter::eval，报错方式保持一致
+    ClosureExpr fallback = [node](Interpreter& interpreter) {
+        return interpreter.eval(node);
+    };
+    if (!node) return fallback;
+
+    switch (node->kind) {
+        case NodeKind::LiteralExpr: {
+            auto* lit = static_cast<const LiteralExpr*>(node);
+            if (!lit->decoded) return fallback;
+            Value value = lit->cached;
+            return [value](Interpreter&) {
+                return value;
+            };
+        }
+        case NodeKind::IdentifierExpr:
+        case NodeKind::VarExpr: {
+            const Binding& binding = node->kind == NodeKind::IdentifierExpr
+                                             ? static_cast<const IdentifierExpr*>(node)->binding
+                                             : static_cast<const VarExpr*>(node)->binding;
+            const std::string& name = node->kind == NodeKind::IdentifierExpr
+                                              ? static_cast<const IdentifierExpr*>(node)->name
+                                              : static_cast<const VarExpr*>(node)->name;
+            const Binding* b = &binding;
+            const std::string* n = &name;
+            return [b, n](Interpreter& interpreter) {
+                return interpreter.load_variable(*b, *n);
+            };
+        }
+        case NodeKind::BinaryExpr: {
+            auto* bin = static_cast<const BinaryExpr*>(node);
+            if (!bin->left || !bin->right) return fallback;
+            ClosureExpr left = compile_expression(bin->left.get());
+            ClosureExpr right = compile_expression(bin->right.get());
+            const BinaryOp op = bin->op;
+            // 与 eval_BinaryExpr 相同：字符串拼接和 BigInt 运算先尝试写回 l
+            return [op, left = std::move(left), right = std::move(right)](Interpreter& interpreter) {
+                Value l = left(interpreter);
+                Value r = right(interpreter);
+                if (Interpreter::apply_in_place(op, l, r)) return l;
+                return interpreter.apply_binary(op, l, r);
+            };
+        }
+        case NodeKind::UnaryExpr: {
+            auto* unary = static_cast<const UnaryExpr*>(node);
+            if (!unary->operand) return fallback;
+            ClosureExpr operand = compile_expression(unary->operand.get());
+            const UnaryOp op = unary->op;
+            return [op, operand = std::move(operand)](Interpreter& interpreter) {
+                return interpreter.apply_unary(op, operand(interpreter));
+            };
+        }
+        case NodeKind::CallExpr: {
+            // 参数个数检查、调用缓存和尾调用都在 eval_CallExpr 中，这里只省掉分派
+            auto* call = static_cast<const CallExpr*>(node);
+            return [call](Interpreter& interpreter) {
+                return interpreter.eval_CallExpr(call);
+            };
+        }
+        case NodeKind::ArrayExpr: {
+            auto* arr = static_cast<const ArrayExpr*>(node);
+            std::vector<ClosureExpr> elements;
+            elements.reserve(arr->elements.size());
+            for (const auto& element: arr->elements) {
+                if (!element) return fallback;
+                elements.push_back(compile_expression(element.get()));
+            }
+            return [elements = std::move(elements)](Interpreter& interpreter) {
+                std::vector<Value> values;
+                values.reserve(elements.size());
+                for (const auto& element: elements) values.push_back(element(interpreter));
+                return Value(std::move(values));
+            };
+        }
+        default:
+            return fallback;
+    }
+}
+
+ClosureStmt ClosureCompiler::compile_statement(const Statement* node) {
+    ClosureStmt fallback = [node](Interpreter& interpreter) {
+        return interpreter.exec_statement(node);
+    };
+    if (!node) return fallback;
+
+    switch (node->kind) {
+        case NodeKind::VarDeclStmt: {
+            auto* v = static_cast<const VarDeclStmt*>(node);
+            if (!v->expr) return fallback;
+            ClosureExpr expr = compile_expression(v->expr.get());
+            return [v, expr = std::move(expr)](Interpreter& interpreter) {
+                interpreter.store_variable(v->binding, v->name, expr(interpreter));
+                return Completion::Normal;
+            };
+        }
+        case NodeKind::AssignStmt: {
+            auto* a = static_cast<const AssignStmt*>(node);
+            // x = x + ... 的字符串原地追加由 exec_statement 处理
+            if (!a->expr || !a->append_operands().empty()) return fallback;
+            ClosureExpr expr = compile_expression(a->expr.get());
+            return [a, expr = std::move(expr)](Interpreter& interpreter) {
+                interpreter.store_variable(a->binding, a->name, expr(interpreter));
+                return Completion::Normal;
+            };
+        }
+        case NodeKind::IfStmt: {
+            auto* ifs = static_cast<const IfStmt*>(node);
+            if (!ifs->condition || !ifs->thenBlock) return fallback;
+            ClosureExpr condition = compile_expression(ifs->condition.get());
+            ClosureBlock then_block = compile_block(ifs->thenBlock->statements);
+            const bool has_else = ifs->elseBlock != nullptr;
+            ClosureBlock else_block = has_else ? compile_block(ifs->elseBlock->statements) : ClosureBlock{};
+            return [condition = std::move(condition), then_block = std::move(then_block),
+                    else_block = std::move(else_block), has_else](Interpreter& interpreter) {
+                if (condition(interpreter).as_bool()) {
+                    return then_block.run(interpreter);
+                } else if (has_else) {
+                    return else_block.run(interpreter);
+                }
+                return Completion::Normal;
+            };
+        }
+        case NodeKind::WhileStmt: {
+            auto* ws = static_cast<const WhileStmt*>(node);
+            if (!ws->condition || !ws->body) return fallback;
+            ClosureExpr condition = compile_expression(ws->condition.get());
+            ClosureBlock body = compile_block(ws->body->statements);
+            // 与 exec_statement 中 while 的异常包装保持一致
+            return [condition = std::move(condition), body = std::move(body)](Interpreter& interpreter) {
+                try {
+                    while (true) {
+                        Value cond;
+                        try {
+                            cond = condition(interpreter);
+                        } catch (const std::exception& e) {
+                            RuntimeError error("Loop condition error: " + std::string(e.what()));
+                            error.stack_trace = interpreter.get_stack_trace();
+                            throw error;
+                        }
+                        if (!cond.as_bool()) break;
+
+                        Completion completion = body.run(interpreter);
+                        if (completion == Completion::Break) break;
+                        if (completion == Completion::Return) return completion;
+                    }
+                } catch (const std::exception& e) {
+                    RuntimeError error("Loop body execution error: " + std::string(e.what()));
+                    error.stack_trace = interpreter.get_stack_trace();
+                    throw error;
+                }
+                return Completion::Normal;
+            };
+        }
+        case NodeKind::BlockStmt: {
+            auto* block = static_cast<const BlockStmt*>(node);
+            ClosureBlock inner = compile_block(block->statements);
+            return [inner = std::move(inner)](Interpreter& interpreter) {
+                return inner.run(interpreter);
+            };
+        }
+        case NodeKind::ReturnStmt: {
+            auto* ret = static_cast<const ReturnStmt*>(node);
+            if (ret->tail_call) {
+                auto* call = static_cast<const CallExpr*>(ret->expr.get());
+                return [call](Interpreter& interpreter) {
+                    interpreter.pending_tail_call = call;
+                    return Completion::Return;
+                };
+            }
+            if (!ret->expr) return fallback;
+            ClosureExpr expr = compile_expression(ret->expr.get());
+            return [expr = std::move(expr)](Interpreter& interpreter) {
+                interpreter.return_value = expr(interpreter);
+                return Completion::Return;
+            };
+        }
+        case NodeKind::BreakStmt:
+            return [](Interpreter&) {
+                return Completion::Break;
+            };
+        case NodeKind::ContinueStmt:
+            return [](Interpreter&) {
+                return Completion::Continue;
+            };
+        case NodeKind::ExprStmt: {
+            auto* exprstmt = static_cast<const ExprStmt*>(node);
+            if (!exprstmt->expr) return fallback;
+            ClosureExpr expr = compile_expression(exprstmt->expr.get());
+            // 与 exec_statement 中表达式语句的异常处理保持一致
+            return [expr = std::move(expr)](Interpreter& interpreter) {
+                try {
+                    Value result = expr(interpreter);
+                } catch (const StdLibException& e) {
+                    throw StdLibException(e.what());
+                } catch (const std::exception& e) {
+                    std::cerr << "ERROR: Exception in expression statement: " << e.what() << std::endl;
+                } catch (...) {
+                    std::cerr << "ERROR: Unknown exception in expression statement" << std::endl;
+                }
+                return Completion::Normal;
+            };
+        }
+        default:
+            // 函数定义、include、BigInt/结构体声明等不在热路径上
+            return fallback;
+    }
+}
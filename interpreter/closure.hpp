@@ -0,0 +1,48 @@
+#pragma once
+#include "interpreter.hpp"
+#include <functional>
+#include <memory>
+#include <vector>
+
+#ifdef _WIN32
+#ifdef LAMINA_CORE_EXPORTS
+#define LAMINA_API __declspec(dllexport)
+#else
+#define LAMINA_API __declspec(dllimport)
+#endif
+#else
+#define LAMINA_API
+#endif
+
+/*
+    闭包编译层：把热点函数体的 AST 转换为预先绑定的可调用对象树。
+    运算符、字面量的值和变量槽位在编译时确定，执行时不再按 NodeKind 分派，也不再解析字面量字符串；
+    函数调用、include、结构体声明等节点回退到 Interpreter 自身的实现，保证与 Interpreter::execute 语义一致
+ */
+
+using ClosureExpr = std::function<Value(Interpreter&)>;
+using ClosureStmt = std::function<Completion(Interpreter&)>;
+
+// 编译后的语句序列，由 FuncDefStmt::compiled 持有
+struct ClosureBlock {
+    std::vector<ClosureStmt> statements;
+
+    Completion run(Interpreter& interpreter) const {
+        for (const auto& stmt: statements) {
+            Completion completion = stmt(interpreter);
+            if (completion != Completion::Normal) return completion;
+        }
+        return Completion::Normal;
+    }
+};
+
+class LAMINA_API ClosureCompiler {
+public:
+    // 编译函数体；闭包只引用 AST 节点，AST 须比结果存活更久
+    static std::shared_ptr<const ClosureBlock> compile(const BlockStmt& body);
+
+private:
+    static ClosureBlock compile_block(const std::vector<std::unique_ptr<Statement>>& statements);
+    static ClosureStmt compile_statement(const Statement* node);
+    static ClosureExpr compile_expression(const Expression* node);
+};
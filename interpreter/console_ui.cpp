@@ -2,9 +2,12 @@
 #include "interpreter.hpp"
 #include "lamina.hpp"
 #include "lexer.hpp"
+#include "module_cache.hpp"
 #include "parser.hpp"
 #include "repl_input.hpp"
+#include "resolver.hpp"
 #include "trackback.hpp"
+#include "vm.hpp"
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -17,14 +20,37 @@
 
 #include <string>
 
-int exec_block(const BlockStmt* block) {
+int exec_block(BlockStmt* block, Engine engine) {
     Interpreter interpreter;
+    // 先把 include 的脚本交给后台解析，与名称解析和执行重叠
+    interpreter.prefetch_includes(block);
+    Resolver(interpreter.globals).resolve(block);
+    if (engine == Engine::Closure) {
+        // 第二次调用起编译：只调用一次的函数不付编译开销
+        interpreter.closure_threshold = 2;
+    }
+    // VM 引擎先整体编译，再按顶层语句逐段执行
+    CompiledProgram program;
+    std::unique_ptr<VM> vm;
+    if (engine == Engine::VM) {
+        try {
+            program = Compiler::compile_program(block);
+        } catch (const RuntimeError& re) {
+            Interpreter::print_error("Bytecode compilation failed: " + re.message, true);
+            return 1;
+        }
+        vm = std::make_unique<VM>(interpreter);
+    }
     // 每个语句独立执行并捕获异常，但保持解释器状态
     int currentLine = 0;
     for (auto& stmt: block->statements) {
         currentLine++;
         try {
-            interpreter.execute(stmt);
+            if (vm) {
+                vm->run(program.statements[currentLine - 1]);
+            } else {
+                interpreter.execute(stmt);
+            }
         } catch (const RuntimeError& re) {
             // Use stack trace for runtime errors
             interpreter.print_stack_trace(re, true);
@@ -50,18 +76,14 @@ int exec_block(const BlockStmt* block) {
 }
 
 
-int run_file(const std::string& path) {
-    std::ifstream file(path);
-    if (!file) {
+int run_file(const std::string& path, Engine engine) {
+    auto file = std::make_shared<const MappedFile>(path);
+    if (!*file) {
         std::cerr << "Unable to open file: " << path << std::endl;
         return 1;
     }
     std::cout << "Executing file: " << path << std::endl;
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    std::string source = buffer.str();
-    auto tokens = Lexer::tokenize(source);
-    auto ast = Parser::parse(tokens);
+    SyntaxTree ast = ModuleCache::parse(path, std::move(file));
 
     // 注释掉自动加载minimal模块，改为按需加载
     // std::cout << "Loading minimal module..." << std::endl;
@@ -86,16 +108,16 @@ int run_file(const std::string& path) {
     //     std::cerr << "Exception during module loading: " << e.what() << std::endl;
     // }
 
-    if (!ast) {
+    if (!ast.root) {
         print_traceback(path, 1);
         return 2;
     }
 
     // 只支持 BlockStmt
-    auto block = dynamic_cast<BlockStmt*>(ast.get());
+    auto block = dynamic_cast<BlockStmt*>(ast.root.get());
     if (!block) return 1;
 
-    exec_block(block);
+    exec_block(block, engine);
     std::cout << "\nProgram execution completed." << std::endl;
     return 0;
 }
@@ -142,8 +164,26 @@ int argv_parser(const int argc, const char* const argv[]) {
 
     const std::vector<std::string> introduction = {"run", "version", "help", "repl"};
     std::vector<std::string> arguments;
+    Engine engine = Engine::AST;
     for (int i = 0; i < argc; ++i) {
-        arguments.emplace_back(argv[i]);// char* => string
+        const std::string arg = argv[i];
+        // --engine=ast|vm|closure 可出现在任意位置
+        if (i > 0 && arg.rfind("--engine=", 0) == 0) {
+            const std::string name = arg.substr(9);
+            if (name == "vm") {
+                engine = Engine::VM;
+            } else if (name == "closure") {
+                engine = Engine::Closure;
+            } else if (name != "ast") {
+                std::cout << "Unknown engine: " << name << " (expected 'ast', 'vm' or 'closure')" << std::endl;
+                return 1;
+            }
+            continue;
+        }
+        arguments.emplace_back(arg);// char* => string
+    }
+    if (arguments.size() < 2) {
+        return repl();
     }
 
     bool is_valid = false;
@@ -156,7 +196,7 @@ int argv_parser(const int argc, const char* const argv[]) {
 
     if (!is_valid && arguments.size() == 2) {
         // if argv[1] not in introduction then run the argv[1](as a path)
-        const std::string path = argv[1];
+        const std::string path = arguments[1];
         arguments[1] = "run";
         arguments.emplace_back(path);
     }
@@ -165,7 +205,7 @@ int argv_parser(const int argc, const char* const argv[]) {
         if (arguments.size() != 3) {
             std::cout << "'run' command need 1 arguments but " << arguments.size() << "was given" << std::endl;
         }
-        return run_file(arguments[2]);
+        return run_file(arguments[2], engine);
     }
 
     if (arguments[1] == "version") {
@@ -194,7 +234,7 @@ int argv_parser(const int argc, const char* const argv[]) {
         }
     }
 
-    std::cout << "Unknown command: " << argv[1] << std::endl;
+    std::cout << "Unknown command: " << arguments[1] << std::endl;
     print_help();
     return 1;
 }
@@ -319,21 +359,22 @@ int repl() {
             }
 
             // frontend
-            auto tokens = Lexer::tokenize(line_to_process);
-            auto ast = Parser::parse(tokens);
+            auto source = std::make_shared<const std::string>(line_to_process);
+            SyntaxTree ast = Parser::parse_tree(source, *source);
 
 
             // Check if AST generation succeeded
-            if (!ast) {
+            if (!ast.root) {
                 print_traceback("<stdin>", lineno);
                 return 1;
             }
 
             // Only support AST of type BlockStmt (block statement)
-            auto* block = dynamic_cast<BlockStmt*>(ast.get());
+            auto* block = dynamic_cast<BlockStmt*>(ast.root.get());
             if (!block) return 1;
             // 保存AST以保持函数指针有效
             interpreter.save_repl_ast(std::move(ast));
+            Resolver(interpreter.globals).resolve(block);
 
             try {
 
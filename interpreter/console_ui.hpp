@@ -7,11 +7,19 @@ inline void print_help() {
     std::cout << HELP_TEXT << std::endl;
 }
 
-int exec_block(const BlockStmt* block);
+// 执行引擎：AST 为树遍历解释器，VM 为字节码虚拟机（--engine=vm），
+// Closure 为树遍历解释器加热点函数的闭包编译层（--engine=closure）
+enum class Engine {
+    AST,
+    VM,
+    Closure
+};
+
+int exec_block(BlockStmt* block, Engine engine = Engine::AST);
 
 void enable_ansi_escape();
 
-int run_file(const std::string& path);
+int run_file(const std::string& path, Engine engine = Engine::AST);
 
 int argv_parser(int argc, const char* const argv[]);
 
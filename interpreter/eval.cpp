@@ -1,85 +1,130 @@
 #include "interpreter.hpp"
+#include "closure.hpp"
 #include "lamina.hpp"
-Value Interpreter::eval_LiteralExpr(const LiteralExpr* node) {
-    if (node->type == Value::Type::Int) {
+#include "native_stack.hpp"
+Value LiteralExpr::decode(const std::string& value, Value::Type type) {
+    if (type == Value::Type::Int) {
         // Check if it contains scientific notation (e or E) or decimal point
-        const std::string value = node->value;
         if (value.find('.') != std::string::npos ||
             value.find('e') != std::string::npos ||
             value.find('E') != std::string::npos) {
             // Parse as double for floating point numbers and scientific notation
-            double d = std::stod(node->value);
+            double d = std::stod(value);
             return Value(d);
         }
-        // 先尝试用 int 解析，只有溢出时才用 BigInt
+        // 先尝试用 64 位整数解析，只有溢出时才用 BigInt
         try {
-            int i = std::stoi(node->value);
+            int64_t i = std::stoll(value);
             return Value(i);
         } catch (const std::out_of_range&) {
             // int 溢出，使用 BigInt
-            ::BigInt big(node->value);
-            return Value(big);
+            ::BigInt big(value);
+            return Value(std::move(big));
         }
     }
     // Check for boolean literals
-    if (node->value == "true") return Value(true);
-    if (node->value == "false") return Value(false);
-    if (node->value == "null") return Value(nullptr);
+    if (value == "true") return Value(true);
+    if (value == "false") return Value(false);
+    if (value == "null") return Value(nullptr);
     // Otherwise it's a string
-    return Value(node->value);
+    return Value(value);
 }
 
-Value Interpreter::eval_CallExpr(const CallExpr* call) {
-    std::string actual_callee = call->callee;
-    //        std::cout << "DEBUG: Call expression with callee: '" << actual_callee << "'" << std::endl;
-
-    // 检查调用的名称是否是一个参数，如果是，获取其实际值
-    try {
-        Value callee_value = get_variable(actual_callee);
-        if (callee_value.is_string() && std::get<std::string>(callee_value.data).substr(0, 11) == "__function_") {
-            // 这是一个函数参数，提取实际的函数名
-            actual_callee = std::get<std::string>(callee_value.data).substr(11);
-            //   std::cout << "DEBUG: Function parameter resolved to: '" << actual_callee << "'" << std::endl;
-        }
-    } catch (const RuntimeError&) {
-        // 如果不是变量，保持原名称
-        // std::cout << "DEBUG: Not a variable or parameter, using direct name: '" << actual_callee << "'" << std::endl;
-    }
+Value Interpreter::eval_LiteralExpr(const LiteralExpr* node) {
+    if (node->decoded) return node->cached;
+    return LiteralExpr::decode(node->value, node->type);
+}
 
-    // Check builtin functions first
-    //   std::cout << "DEBUG: Looking for builtin function: '" << actual_callee << "'" << std::endl;
-    //   std::cout << "DEBUG: Available builtin functions:" << std::endl;
-    // for (const auto& pair : builtin_functions) {
-    //     std::cout << "  - '" << pair.first << "'" << std::endl;
-    // }
+CallCache Interpreter::resolve_call(const CallExpr* call) {
+    // 被调目标按调用点缓存；名字可能是变量时，先检查 "__function_" 间接调用
+    // 返回副本：求值参数时同一调用点可能被递归重新填写
+    CallCache target = resolve_callee(call->callee, call->cache);
+    if (target.may_be_variable) {
+        const Value* callee_value = find_variable(call->callee);
+        if (callee_value && callee_value->is_string()) {
+            const auto& s = callee_value->get<std::string>();
+            if (s.compare(0, 11, "__function_") == 0) {
+                // 这是一个函数参数，提取实际的函数名
+                CallCache indirect;
+                target = resolve_callee(s.substr(11), indirect);
+            }
+        }
+    }
+    return target;
+}
 
-    auto builtin_it = builtin_functions.find(actual_callee);
-    if (builtin_it != builtin_functions.end()) {
-        //     std::cout << "DEBUG: Found builtin function: '" << actual_callee << "'" << std::endl;
+void Interpreter::eval_arguments(const CallExpr* call, const std::string& name, const FuncDefStmt* func, size_t base) {
+    // Check parameter count
+    if (call->args.size() > func->params.size()) {
+        Interpreter::print_warning("Too many arguments provided to function '" + name +
+                                           "'. Expected " + std::to_string(func->params.size()) +
+                                           ", got " + std::to_string(call->args.size()),
+                                   true);
+    }
 
-        // 检查是否是模块函数
-        bool is_module_func = actual_callee.find(".") != std::string::npos;
-        if (is_module_func) {
-            //       std::cout << "DEBUG: This is a module function with dot notation" << std::endl;
+    // Calculate arguments; 求值可能触发嵌套调用使分配区扩容，因此按下标写入
+    for (size_t j = 0; j < func->params.size(); ++j) {
+        Value arg;
+        if (j < call->args.size()) {
+            if (call->args[j]) {
+                arg = eval(call->args[j].get());
+            } else {
+                Interpreter::print_error("Null argument " + std::to_string(j + 1) + " in call to function '" + name + "'", true);
+                arg = Value("<null arg>");
+            }
+        } else {
+            Interpreter::print_warning("Missing argument '" + func->params[j] + "' in call to function '" + name + "'", true);
+            arg = Value("<undefined>");
         }
+        const size_t slot = base + func->param_slots[j];
+        frame_arena.values[slot] = std::move(arg);
+        frame_arena.assigned[slot] = 1;
+    }
+}
 
-        // Handle builtin call with stack frame and unified error handling
-        push_frame(actual_callee, "<builtin>", 0);
+Completion Interpreter::exec_body(const FuncDefStmt* func) {
+    if (!func->compiled && closure_threshold && ++func->call_count >= closure_threshold) {
+        func->compiled = ClosureCompiler::compile(*func->body);
+    }
+    if (func->compiled) return func->compiled->run(*this);
+    return exec_statements(func->body->statements);
+}
 
-        std::vector<Value> args;
-        for (const auto& arg: call->args) {
-            if (!arg) {
-                pop_frame();
-                RuntimeError err("Null argument in call to builtin function '" + actual_callee + "'");
-                err.stack_trace = get_stack_trace();
-                throw err;
-            }
-            args.push_back(eval(arg.get()));
+Value Interpreter::eval_CallExpr(const CallExpr* call) {
+    // 原生栈余量不足时换到新的栈段上继续递归
+    if (native_stack::exhausted()) {
+        if (!native_stack::segments_supported()) {
+            RuntimeError error("Maximum recursion depth exceeded (native stack exhausted)");
+            error.stack_trace = get_stack_trace();
+            throw error;
         }
+        Value result;
+        native_stack::run_on_new_segment([&] { result = eval_CallExpr(call); });
+        return result;
+    }
+
+    const CallCache target = resolve_call(call);
+    // 指向符号表中的名字，尾调用时改指向新的被调函数
+    const std::string* actual_callee = &symbol_name(target.name_id);
+    //        std::cout << "DEBUG: Call expression with callee: '" << *actual_callee << "'" << std::endl;
+
+    // Check builtin functions first
+    if (target.target == CallCache::Target::Builtin) {
+        // Handle builtin call with stack frame and unified error handling
+        push_frame(target.name_id, SymbolTable::builtin_id, static_cast<int>(call->span.line));
 
         Value result;
         try {
-            result = builtin_it->second(args);
+            FrameArena::Args args(frame_arena, call->args.size());
+            for (const auto& arg: call->args) {
+                if (!arg) {
+                    RuntimeError err("Null argument in call to builtin function '" + *actual_callee + "'");
+                    err.stack_trace = get_stack_trace();
+                    throw err;
+                }
+                args->push_back(eval(arg.get()));
+            }
+            result = (*target.builtin)(*args);
         } catch (...) {
             pop_frame();
             throw;
@@ -90,11 +135,10 @@ Value Interpreter::eval_CallExpr(const CallExpr* call) {
     }
 
     // Check user-defined functions
-    auto it = functions.find(actual_callee);
-    if (it != functions.end()) {
-        FuncDefStmt* func = it->second;
+    if (target.target == CallCache::Target::Function) {
+        const FuncDefStmt* func = target.func;
         if (!func) {
-            std::cerr << "Error: Function object for '" << actual_callee << "' is null" << std::endl;
+            std::cerr << "Error: Function object for '" << *actual_callee << "' is null" << std::endl;
             return Value("<func error>");
         }
 
@@ -106,118 +150,275 @@ Value Interpreter::eval_CallExpr(const CallExpr* call) {
         }
 
         recursion_depth++;
-        push_frame(actual_callee, "<script>", 0);   // Add to call stack
-
-        // Check parameter count
-        if (call->args.size() > func->params.size()) {
-            Interpreter::print_warning("Too many arguments provided to function '" + actual_callee +
-                                               "'. Expected " + std::to_string(func->params.size()) +
-                                               ", got " + std::to_string(call->args.size()),
-                                       true);
-        }
-
-        // Calculate arguments
-        std::vector<Value> arg_values(func->params.size());
-        for (size_t j = 0; j < func->params.size(); ++j) {
-            if (j < call->args.size()) {
-                if (call->args[j]) {
-                    arg_values[j] = eval(call->args[j].get());
-                } else {
-                    Interpreter::print_error("Null argument " + std::to_string(j + 1) + " in call to function '" + actual_callee + "'", true);
-                    arg_values[j] = Value("<null arg>");
-                }
-            } else {
-                Interpreter::print_warning("Missing argument '" + func->params[j] + "' in call to function '" + actual_callee + "'", true);
-                arg_values[j] = Value("<undefined>");
-            }
-        }
+        push_frame(target.name_id, SymbolTable::script_id, static_cast<int>(call->span.line));   // Add to call stack
 
-        push_scope();// Create scope here
-
-        // Pass arguments
-        for (size_t j = 0; j < func->params.size(); ++j) {
-            set_variable(func->params[j], arg_values[j]);
-        }
+        const size_t base = frame_arena.allocate(func->locals.size());
+        eval_arguments(call, *actual_callee, func, base);
+        push_scope(func, base);// Create frame here
 
         // Execute function body, capture return
+        Completion completion;
         try {
-            for (const auto& stmt: func->body->statements) {
-                try {
-                    execute(stmt);
-                } catch (const ReturnException& re) {
-                    // Normal return handling
-                    pop_frame();
-                    pop_scope();
-                    recursion_depth--;
-                    return re.value;
-                } catch (const RuntimeError& re) {
-                    // If the error doesn't have a stack trace yet, capture current state
-                    RuntimeError enriched(re.message);
-                    if (re.stack_trace.empty()) {
-                        enriched.stack_trace = get_stack_trace();
-                    } else {
-                        enriched.stack_trace = re.stack_trace;  // Preserve existing trace
-                    }
-                    pop_frame();
-                    pop_scope();
-                    recursion_depth--;
-                    throw enriched;
-                } catch (const std::exception& e) {
-                    // Wrap standard exception as RuntimeError
-                    RuntimeError enriched("In function '" + actual_callee + "': " + std::string(e.what()));
-                    enriched.stack_trace = get_stack_trace();   // Get stack trace before cleanup
-                    pop_frame();
-                    pop_scope();
-                    recursion_depth--;
-                    throw enriched;
+            completion = exec_body(func);
+            // 尾调用：在当前帧求值实参，再把当前帧替换为被调函数的帧，调用深度不变
+            while (completion == Completion::Return && pending_tail_call) {
+                const CallExpr* tail = pending_tail_call;
+                pending_tail_call = nullptr;
+                const CallCache tail_target = resolve_call(tail);
+                const std::string& tail_callee = symbol_name(tail_target.name_id);
+                // 当前帧可能被按名读到（动态作用域）时保留它，按普通调用处理
+                if (tail_target.target != CallCache::Target::Function || !tail_target.func || locals_read_by_name(func)) {
+                    return_value = eval_CallExpr(tail);
+                    break;
+                }
+                const FuncDefStmt* tail_func = tail_target.func;
+                const size_t tail_base = frame_arena.allocate(tail_func->locals.size());
+                eval_arguments(tail, tail_callee, tail_func, tail_base);
+                // 把新帧的槽位下移到当前帧的位置，分配区不随尾调用次数增长
+                CallFrame& frame = frames.back();
+                for (size_t i = 0; tail_base != frame.base && i < tail_func->locals.size(); ++i) {
+                    frame_arena.values[frame.base + i] = std::move(frame_arena.values[tail_base + i]);
+                    frame_arena.assigned[frame.base + i] = frame_arena.assigned[tail_base + i];
                 }
+                frame_arena.release(frame.base + tail_func->locals.size());
+                frame.func = tail_func;
+                pop_frame();
+                actual_callee = &tail_callee;
+                func = tail_func;
+                push_frame(tail_target.name_id, SymbolTable::script_id, static_cast<int>(tail->span.line));
+                completion = exec_body(func);
             }
-        } catch (const ReturnException& re) {
-            // Ensure cleanup in any case
+        } catch (RuntimeError& re) {
+            // If the error doesn't have a stack trace yet, capture current state;
+            // 就地补全后原样上抛，深递归出错时逐层返回不再复制整个调用栈
+            if (re.stack_trace.empty()) re.stack_trace = get_stack_trace();
+            pop_frame();
+            pop_scope();
+            recursion_depth--;
+            throw;
+        } catch (const std::exception& e) {
+            // Wrap standard exception as RuntimeError
+            RuntimeError enriched("In function '" + *actual_callee + "': " + std::string(e.what()));
+            enriched.stack_trace = get_stack_trace();   // Get stack trace before cleanup
             pop_frame();
             pop_scope();
             recursion_depth--;
-            return re.value;
+            throw enriched;
+        }
+
+        if (completion == Completion::Break || completion == Completion::Continue) {
+            // break/continue 不在循环内，不能越过函数边界
+            RuntimeError error("In function '" + *actual_callee + "': " +
+                               (completion == Completion::Break ? "break" : "continue") + " statement used outside loop");
+            error.stack_trace = get_stack_trace();
+            pop_frame();
+            pop_scope();
+            recursion_depth--;
+            throw error;
         }
 
         pop_frame();
         pop_scope();
         recursion_depth--;
+        if (completion == Completion::Return) {
+            return std::move(return_value);
+        }
         return Value(); // Default value when no return
     }
 
     // Check if it's a module function before reporting undefined
-    bool is_module_func = actual_callee.find(".") != std::string::npos;
-    if (is_module_func) {
+    if (target.target == CallCache::Target::Module) {
         // Prepare arguments for module function call
-        std::vector<Value> args;
+        FrameArena::Args args(frame_arena, call->args.size());
         for (const auto& arg: call->args) {
             if (!arg) {
-                std::cerr << "Error: Null argument in call to module function '" << actual_callee << "'" << std::endl;
-                args.push_back(Value());
+                std::cerr << "Error: Null argument in call to module function '" << *actual_callee << "'" << std::endl;
+                args->push_back(Value());
             } else {
-                args.push_back(eval(arg.get()));
+                args->push_back(eval(arg.get()));
             }
         }
 
         // Try to call the module function
-        Value result = call_module_function(actual_callee, args);
+        Value result = call_module_function(*actual_callee, *args);
         if (result.to_string() != "null") { // 检查是否成功调用
             return result;
         }
         // If module function call failed, fall through to undefined function error
     }
 
-    std::cerr << "Error: Call to undefined function '" << actual_callee << "'" << std::endl;
+    std::cerr << "Error: Call to undefined function '" << *actual_callee << "'" << std::endl;
     return Value("<undefined function>");
 }
 
+// 按比较运算符比较两个同类型的值
+template<typename T>
+static bool compare_with(BinaryOp op, const T& a, const T& b) {
+    switch (op) {
+        case BinaryOp::Eq: return a == b;
+        case BinaryOp::Ne: return a != b;
+        case BinaryOp::Lt: return a < b;
+        case BinaryOp::Le: return a <= b;
+        case BinaryOp::Gt: return a > b;
+        default: return a >= b;
+    }
+}
+
+namespace {
+    // (运算符, 左类型, 右类型) 分派表：常见的标量组合直接查表执行，
+    // 其余组合（Rational、符号表达式、数组等）返回 nullptr，走 apply_binary 中的通用路径
+    using BinaryHandler = Value (*)(BinaryOp, const Value&, const Value&);
+    constexpr size_t op_count = static_cast<size_t>(BinaryOp::Ge) + 1;
+    constexpr size_t type_count = static_cast<size_t>(Value::Type::Symbolic) + 1;
+
+    // 64 位整数运算，仅在真正溢出时提升为 BigInt
+    Value int_binary(BinaryOp op, const Value& l, const Value& r) {
+        const int64_t a = l.get<int64_t>();
+        const int64_t b = r.get<int64_t>();
+        int64_t result;
+        switch (op) {
+            case BinaryOp::Add:
+                if (!bigint_detail::add_overflow(a, b, result)) return Value(result);
+                return Value(::BigInt(a) + ::BigInt(b));
+            case BinaryOp::Sub:
+                if (!bigint_detail::sub_overflow(a, b, result)) return Value(result);
+                return Value(::BigInt(a) - ::BigInt(b));
+            case BinaryOp::Mul:
+                if (!bigint_detail::mul_overflow(a, b, result)) return Value(result);
+                return Value(::BigInt(a) * ::BigInt(b));
+            case BinaryOp::Mod:
+                if (b == 0) error_and_exit("Modulo by zero");
+                // INT64_MIN % -1 在硬件上会溢出，结果恒为 0
+                return Value(b == -1 ? int64_t{0} : a % b);
+            default:
+                return Value(compare_with(op, a, b));
+        }
+    }
+
+    // Int 与 Float 混合或 Float 之间的运算，按 double 计算
+    Value float_binary(BinaryOp op, const Value& l, const Value& r) {
+        const double a = l.as_number();
+        const double b = r.as_number();
+        switch (op) {
+            case BinaryOp::Add: return Value(a + b);
+            case BinaryOp::Sub: return Value(a - b);
+            case BinaryOp::Mul: return Value(a * b);
+            default: return Value(compare_with(op, a, b));
+        }
+    }
+
+    // BigInt 与 BigInt / Int 的运算：直接引用存储的 BigInt，只为 Int 一侧构造临时 BigInt；
+    // 结果与通用路径一致（加减乘取模得到 BigInt，除法整除时得到 BigInt，否则得到 Rational）
+    Value bigint_binary(BinaryOp op, const Value& l, const Value& r) {
+        ::BigInt converted;
+        const ::BigInt& a = l.is_bigint() ? l.get<::BigInt>() : (converted = ::BigInt(l.get<int64_t>()));
+        const ::BigInt& b = r.is_bigint() ? r.get<::BigInt>() : (converted = ::BigInt(r.get<int64_t>()));
+        switch (op) {
+            case BinaryOp::Add: return Value(a + b);
+            case BinaryOp::Sub: return Value(a - b);
+            case BinaryOp::Mul: return Value(a * b);
+            case BinaryOp::Mod: return Value(a % b);
+            case BinaryOp::Div: {
+                if (b.is_zero()) error_and_exit("Division by zero");
+                ::BigInt quotient, remainder;
+                ::BigInt::divmod(a, b, quotient, remainder);
+                if (remainder.is_zero()) return Value(std::move(quotient));
+                return Value(::Rational(a, b));
+            }
+            default: return Value(compare_with(op, a, b));
+        }
+    }
+
+    Value string_compare(BinaryOp op, const Value& l, const Value& r) {
+        return Value(compare_with(op, l.get<std::string>(), r.get<std::string>()));
+    }
+
+    Value bool_compare(BinaryOp op, const Value& l, const Value& r) {
+        return Value(compare_with(op, l.get<bool>(), r.get<bool>()));
+    }
+
+    struct BinaryTable {
+        BinaryHandler handlers[op_count][type_count][type_count] = {};
+
+        void set(BinaryOp op, Value::Type l, Value::Type r, BinaryHandler handler) {
+            handlers[static_cast<size_t>(op)][static_cast<size_t>(l)][static_cast<size_t>(r)] = handler;
+        }
+
+        BinaryTable() {
+            using T = Value::Type;
+            // Int/Float 的 Div 与 Pow 的结果类型（Rational、BigInt）由通用路径决定，不进表
+            for (BinaryOp op: {BinaryOp::Add, BinaryOp::Sub, BinaryOp::Mul, BinaryOp::Mod,
+                               BinaryOp::Eq, BinaryOp::Ne, BinaryOp::Lt, BinaryOp::Le, BinaryOp::Gt, BinaryOp::Ge}) {
+                set(op, T::Int, T::Int, int_binary);
+                // Float 取模沿用通用路径的取整语义
+                if (op == BinaryOp::Mod) continue;
+                set(op, T::Int, T::Float, float_binary);
+                set(op, T::Float, T::Int, float_binary);
+                set(op, T::Float, T::Float, float_binary);
+            }
+            // BigInt 的除法结果只取决于能否整除，可以直接进表
+            for (BinaryOp op: {BinaryOp::Add, BinaryOp::Sub, BinaryOp::Mul, BinaryOp::Div, BinaryOp::Mod,
+                               BinaryOp::Eq, BinaryOp::Ne, BinaryOp::Lt, BinaryOp::Le, BinaryOp::Gt, BinaryOp::Ge}) {
+                set(op, T::BigInt, T::BigInt, bigint_binary);
+                set(op, T::BigInt, T::Int, bigint_binary);
+                set(op, T::Int, T::BigInt, bigint_binary);
+            }
+            for (BinaryOp op: {BinaryOp::Eq, BinaryOp::Ne, BinaryOp::Lt, BinaryOp::Le, BinaryOp::Gt, BinaryOp::Ge}) {
+                set(op, T::String, T::String, string_compare);
+                set(op, T::Bool, T::Bool, bool_compare);
+            }
+        }
+
+        BinaryHandler find(BinaryOp op, const Value& l, const Value& r) const {
+            return handlers[static_cast<size_t>(op)][static_cast<size_t>(l.type)][static_cast<size_t>(r.type)];
+        }
+    };
+
+    const BinaryTable binary_table;
+}// namespace
+
 Value Interpreter::eval_BinaryExpr(const BinaryExpr* bin) {
     Value l = eval(bin->left.get());
     Value r = eval(bin->right.get());
+    if (apply_in_place(bin->op, l, r)) return l;
+    return apply_binary(bin->op, l, r);
+}
+
+bool Interpreter::append_string(Value& l, const Value& r) {
+    if (!l.is_string() || r.is_infinity()) return false;
+    std::string& s = l.get_mut<std::string>();
+    if (r.is_string()) {
+        s += r.get<std::string>();
+    } else {
+        s += r.to_string();
+    }
+    return true;
+}
 
+bool Interpreter::apply_in_place(BinaryOp op, Value& l, const Value& r) {
+    if (op == BinaryOp::Add && append_string(l, r)) return true;
+    // 与 apply_binary 的 BigInt 优先路径结果相同，只是直接改写 l 的盒子，不再复制两个操作数
+    if (!l.is_bigint() || !(r.is_bigint() || r.is_int())) return false;
+    if (op != BinaryOp::Add && op != BinaryOp::Sub && op != BinaryOp::Mul) return false;
+    ::BigInt& lb = l.get_mut<::BigInt>();
+    if (r.is_int()) {
+        const int64_t rv = r.get<int64_t>();
+        if (op == BinaryOp::Add) lb += rv;
+        else if (op == BinaryOp::Sub) lb -= rv;
+        else lb *= rv;
+    } else {
+        const ::BigInt& rb = r.get<::BigInt>();
+        if (op == BinaryOp::Add) lb += rb;
+        else if (op == BinaryOp::Sub) lb -= rb;
+        else lb *= rb;
+    }
+    return true;
+}
+
+Value Interpreter::apply_binary(BinaryOp op, const Value& l, const Value& r) {
+    if (BinaryHandler handler = binary_table.find(op, l, r)) return handler(op, l, r);
     // Handle arithmetic operations
-    if (bin->op == "+") {
+    if (op == BinaryOp::Add) {
 		if (l.is_infinity() || r.is_infinity()) {
 			return l;
 		}
@@ -236,32 +437,32 @@ Value Interpreter::eval_BinaryExpr(const BinaryExpr* bin) {
             std::shared_ptr<SymbolicExpr> leftExpr;
             std::shared_ptr<SymbolicExpr> rightExpr;
             if (l.is_symbolic()) {
-                leftExpr = std::get<std::shared_ptr<SymbolicExpr>>(l.data);
+                leftExpr = l.get<std::shared_ptr<SymbolicExpr>>();
             } else if (l.is_irrational()) {
-                leftExpr = std::get<::Irrational>(l.data).to_symbolic();
+                leftExpr = l.get<::Irrational>().to_symbolic();
             } else if (l.is_rational()) {
-                leftExpr = SymbolicExpr::number(std::get<::Rational>(l.data));
+                leftExpr = SymbolicExpr::number(l.get<::Rational>());
             } else if (l.is_bigint()) {
-                leftExpr = SymbolicExpr::number(std::get<::BigInt>(l.data));
+                leftExpr = SymbolicExpr::number(l.get<::BigInt>());
             } else if (l.is_int()) {
-                leftExpr = SymbolicExpr::number(std::get<int>(l.data));
+                leftExpr = SymbolicExpr::number(l.get<int64_t>());
             } else if (l.is_float()) {
-                leftExpr = SymbolicExpr::number(::Rational::from_double(std::get<double>(l.data)));
+                leftExpr = SymbolicExpr::number(::Rational::from_double(l.get<double>()));
             } else {
                 leftExpr = SymbolicExpr::number(0);
             }
             if (r.is_symbolic()) {
-                rightExpr = std::get<std::shared_ptr<SymbolicExpr>>(r.data);
+                rightExpr = r.get<std::shared_ptr<SymbolicExpr>>();
             } else if (r.is_irrational()) {
-                rightExpr = std::get<::Irrational>(r.data).to_symbolic();
+                rightExpr = r.get<::Irrational>().to_symbolic();
             } else if (r.is_rational()) {
-                rightExpr = SymbolicExpr::number(std::get<::Rational>(r.data));
+                rightExpr = SymbolicExpr::number(r.get<::Rational>());
             } else if (r.is_bigint()) {
-                rightExpr = SymbolicExpr::number(std::get<::BigInt>(r.data));
+                rightExpr = SymbolicExpr::number(r.get<::BigInt>());
             } else if (r.is_int()) {
-                rightExpr = SymbolicExpr::number(std::get<int>(r.data));
+                rightExpr = SymbolicExpr::number(r.get<int64_t>());
             } else if (r.is_float()) {
-                rightExpr = SymbolicExpr::number(::Rational::from_double(std::get<double>(r.data)));
+                rightExpr = SymbolicExpr::number(::Rational::from_double(r.get<double>()));
             } else {
                 rightExpr = SymbolicExpr::number(0);
             }
@@ -271,45 +472,36 @@ Value Interpreter::eval_BinaryExpr(const BinaryExpr* bin) {
         if (l.is_numeric() && r.is_numeric()) {
             // BigInt 优先：如果任一为 BigInt，结果为 BigInt
             if (l.is_bigint() || r.is_bigint()) {
-                ::BigInt lb = l.is_bigint() ? std::get<::BigInt>(l.data) : ::BigInt(l.as_number());
-                ::BigInt rb = r.is_bigint() ? std::get<::BigInt>(r.data) : ::BigInt(r.as_number());
+                ::BigInt lb = l.as_bigint();
+                ::BigInt rb = r.as_bigint();
                 return Value(lb + rb);
             }
             // If either operand is rational, use rational arithmetic
             if (l.is_rational() || r.is_rational()) {
                 ::Rational result = l.as_rational() + r.as_rational();
-                return Value(result);
+                return Value(std::move(result));
             }
 
-            double result = l.as_number() + r.as_number();// Return int if both operands are int and result is the whole
-            if (l.is_int() && r.is_int()) {
-                // check overflow and underflow
-                if (static_cast<int>(result) == INT_MAX ||
-                    static_cast<int>(result) == INT_MIN) {
-                    return Value(BigInt(l.as_number()) + BigInt(r.as_number()));
-                }
-                return Value(static_cast<int>(result));
-            }
-            return Value(result);
+            // Int/Float 组合已由 binary_table 处理
+            return Value(l.as_number() + r.as_number());
         } else {
             error_and_exit("Cannot add " + l.to_string() + " and " + r.to_string());
         }
     }
     // Arithmetic operations (require numeric operands or vector operations)
-    if (bin->op == "-" || bin->op == "*" || bin->op == "/" ||
-        bin->op == "%" || bin->op == "^") {
+    if (!is_comparison(op)) {
 		
 		if (l.is_infinity() || r.is_infinity()) {
 			error_and_exit("Error: Infinity cannot participate in evaluations");
 		}
 			
         // Special handling for multiplication
-        if (bin->op == "*") {
+        if (op == BinaryOp::Mul) {
             // Vector and matrix operations
             if (l.is_array() && r.is_array()) {
                 // Try dot product for same-size vectors
-                const auto& la = std::get<std::vector<Value>>(l.data);
-                const auto& ra = std::get<std::vector<Value>>(r.data);
+                const auto& la = l.get<std::vector<Value>>();
+                const auto& ra = r.get<std::vector<Value>>();
                 if (la.size() == ra.size()) {
                     return l.dot_product(r);
                 }
@@ -331,12 +523,12 @@ Value Interpreter::eval_BinaryExpr(const BinaryExpr* bin) {
                 std::shared_ptr<SymbolicExpr> rightExpr;
                 // 强制所有 Irrational 都转为 SymbolicExpr
                 if (l.is_symbolic()) {
-                    leftExpr = std::get<std::shared_ptr<SymbolicExpr>>(l.data);
+                    leftExpr = l.get<std::shared_ptr<SymbolicExpr>>();
                 } else {
                     leftExpr = from_number_to_symbolic(l);
                 }
                 if (r.is_symbolic()) {
-                    rightExpr = std::get<std::shared_ptr<SymbolicExpr>>(r.data);
+                    rightExpr = r.get<std::shared_ptr<SymbolicExpr>>();
                 } else {
                     rightExpr = from_number_to_symbolic(r);
                 }
@@ -346,43 +538,34 @@ Value Interpreter::eval_BinaryExpr(const BinaryExpr* bin) {
             if (l.is_numeric() && r.is_numeric()) {
                 // BigInt 优先：如果任一为 BigInt，结果为 BigInt
                 if (l.is_bigint() || r.is_bigint()) {
-                    ::BigInt lb = l.is_bigint() ? std::get<::BigInt>(l.data) : ::BigInt(l.as_number());
-                    ::BigInt rb = r.is_bigint() ? std::get<::BigInt>(r.data) : ::BigInt(r.as_number());
+                    ::BigInt lb = l.as_bigint();
+                    ::BigInt rb = r.as_bigint();
                     return Value(lb * rb);
                 }
                 // If either operand is irrational, use irrational arithmetic
                 if (l.is_irrational() || r.is_irrational()) {
                     ::Irrational result = l.as_irrational() * r.as_irrational();
-                    return Value(result);
+                    return Value(std::move(result));
                 }
                 // If either operand is rational, use rational arithmetic
                 if (l.is_rational() || r.is_rational()) {
                     ::Rational result = l.as_rational() * r.as_rational();
-                    return Value(result);
+                    return Value(std::move(result));
                 }
 
-                double result = l.as_number() * r.as_number();
-                if (l.is_int() && r.is_int()) {
-                    // check overflow and underflow
-                    if (static_cast<int>(result) == INT_MAX ||
-                        static_cast<int>(result) == INT_MIN) {
-                        return Value(BigInt(l.as_number()) * BigInt(r.as_number()));
-                    }
-                    return Value(static_cast<int>(result));
-                }
-                return Value(result);
+                return Value(l.as_number() * r.as_number());
             }
             // Error case
             error_and_exit("Cannot multiply " + l.to_string() + " and " + r.to_string());
         }
 
         // Special handling for minus
-        if (bin->op == "-") {
+        if (op == BinaryOp::Sub) {
             // Vector and matrix operations
             if (l.is_array() && r.is_array()) {
                 // Try minus for same-size vectors
-                const auto& la = std::get<std::vector<Value>>(l.data);
-                const auto& ra = std::get<std::vector<Value>>(r.data);
+                const auto& la = l.get<std::vector<Value>>();
+                const auto& ra = r.get<std::vector<Value>>();
                 return l.vector_minus(r);// An exception can be raised inside
             }
             // Matrix multiplication
@@ -399,12 +582,12 @@ Value Interpreter::eval_BinaryExpr(const BinaryExpr* bin) {
                 std::shared_ptr<SymbolicExpr> rightExpr;
                 // 强制所有 Irrational 都转为 SymbolicExpr
                 if (l.is_symbolic()) {
-                    leftExpr = std::get<std::shared_ptr<SymbolicExpr>>(l.data);
+                    leftExpr = l.get<std::shared_ptr<SymbolicExpr>>();
                 } else {
                     leftExpr = from_number_to_symbolic(l);
                 }
                 if (r.is_symbolic()) {
-                    rightExpr = std::get<std::shared_ptr<SymbolicExpr>>(r.data);
+                    rightExpr = r.get<std::shared_ptr<SymbolicExpr>>();
                 } else {
                     rightExpr = from_number_to_symbolic(r);
                 }
@@ -414,31 +597,22 @@ Value Interpreter::eval_BinaryExpr(const BinaryExpr* bin) {
             if (l.is_numeric() && r.is_numeric()) {
                 // BigInt 优先：如果任一为 BigInt，结果为 BigInt
                 if (l.is_bigint() || r.is_bigint()) {
-                    ::BigInt lb = l.is_bigint() ? std::get<::BigInt>(l.data) : ::BigInt(l.as_number());
-                    ::BigInt rb = r.is_bigint() ? std::get<::BigInt>(r.data) : ::BigInt(r.as_number());
+                    ::BigInt lb = l.as_bigint();
+                    ::BigInt rb = r.as_bigint();
                     return Value(lb - rb);
                 }
                 // If either operand is irrational, use irrational arithmetic
                 if (l.is_irrational() || r.is_irrational()) {
                     ::Irrational result = l.as_irrational() - r.as_irrational();
-                    return Value(result);
+                    return Value(std::move(result));
                 }
                 // If either operand is rational, use rational arithmetic
                 if (l.is_rational() || r.is_rational()) {
                     ::Rational result = l.as_rational() - r.as_rational();
-                    return Value(result);
+                    return Value(std::move(result));
                 }
 
-                double result = l.as_number() - r.as_number();
-                if (l.is_int() && r.is_int()) {
-                    // check overflow and underflow
-                    if (static_cast<int>(result) == INT_MAX ||
-                        static_cast<int>(result) == INT_MIN) {
-                        return Value(BigInt(l.as_number()) - BigInt(r.as_number()));
-                    }
-                    return Value(static_cast<int>(result));
-                }
-                return (l.is_int() && r.is_int()) ? Value(static_cast<int>(result)) : Value(result);
+                return Value(l.as_number() - r.as_number());
             }
             // Error case
             error_and_exit("Cannot decrease " + l.to_string() + " by " + r.to_string());
@@ -446,22 +620,22 @@ Value Interpreter::eval_BinaryExpr(const BinaryExpr* bin) {
 
         // Other arithmetic operations require both operands to be numeric
         if (!l.is_numeric() || !r.is_numeric()) {
-            error_and_exit("Arithmetic operation '" + bin->op + "' requires numeric operands");
+            error_and_exit("Arithmetic operation '" + std::string(binary_op_text(op)) + "' requires numeric operands");
         }
 
         // For division, always use rational arithmetic for precise results
-        if (bin->op == "/") {
+        if (op == BinaryOp::Div) {
             // 只要有一方是 Irrational 或 Symbolic，优先生成符号表达式
             if ((l.is_irrational() || l.is_symbolic() || r.is_irrational() || r.is_symbolic()) && l.is_numeric() && r.is_numeric()) {
                 std::shared_ptr<SymbolicExpr> leftExpr;
                 std::shared_ptr<SymbolicExpr> rightExpr;
                 if (l.is_symbolic()) {
-                    leftExpr = std::get<std::shared_ptr<SymbolicExpr>>(l.data);
+                    leftExpr = l.get<std::shared_ptr<SymbolicExpr>>();
                 } else {
                     leftExpr = from_number_to_symbolic(l);
                 }
                 if (r.is_symbolic()) {
-                    rightExpr = std::get<std::shared_ptr<SymbolicExpr>>(r.data);
+                    rightExpr = r.get<std::shared_ptr<SymbolicExpr>>();
                 } else {
                     rightExpr = from_number_to_symbolic(r);
                 }
@@ -470,8 +644,8 @@ Value Interpreter::eval_BinaryExpr(const BinaryExpr* bin) {
             }
             // BigInt 优先：如果任一为 BigInt，结果为 BigInt（如果整除）或 Rational
             if (l.is_bigint() || r.is_bigint()) {
-                ::BigInt lb = l.is_bigint() ? std::get<::BigInt>(l.data) : ::BigInt(l.as_number());
-                ::BigInt rb = r.is_bigint() ? std::get<::BigInt>(r.data) : ::BigInt(r.as_number());
+                ::BigInt lb = l.as_bigint();
+                ::BigInt rb = r.as_bigint();
                 if (rb.is_zero()) {
                     error_and_exit("Division by zero");
                 }
@@ -480,7 +654,7 @@ Value Interpreter::eval_BinaryExpr(const BinaryExpr* bin) {
                     ::BigInt quotient = lb / rb;
                     ::BigInt remainder = lb - (quotient * rb);
                     if (remainder.is_zero()) {
-                        return Value(quotient);
+                        return Value(std::move(quotient));
                     } else {
                         // 不能整除，返回有理数
                         return Value(::Rational(lb, rb));
@@ -509,7 +683,7 @@ Value Interpreter::eval_BinaryExpr(const BinaryExpr* bin) {
             return Value(lr / rr);
         }
 
-        if (bin->op == "%") {
+        if (op == BinaryOp::Mod) {
             if ((l.is_irrational() || l.is_symbolic() || r.is_irrational() || r.is_symbolic() || l.is_rational() || r.is_rational()) && l.is_numeric() && r.is_numeric()) {
                 // 有小数，使用小数取模
                 double ld = l.as_number();
@@ -521,26 +695,26 @@ Value Interpreter::eval_BinaryExpr(const BinaryExpr* bin) {
             }
             if (l.is_bigint() || r.is_bigint()) {
                 // 有BigInt，使用BigInt内置方法
-                ::BigInt lb = l.is_bigint() ? std::get<::BigInt>(l.data) : ::BigInt(l.as_number());
-                ::BigInt rb = r.is_bigint() ? std::get<::BigInt>(r.data) : ::BigInt(r.as_number());
+                ::BigInt lb = l.as_bigint();
+                ::BigInt rb = r.as_bigint();
                 return Value(lb % rb);
             }
             // 都为int
             return Value(static_cast<int>(l.as_number()) % static_cast<int>(r.as_number()));
         }
 
-        if (bin->op == "^") {
+        if (op == BinaryOp::Pow) {
             if ((l.is_irrational() || l.is_symbolic() || r.is_irrational() || r.is_symbolic()) && l.is_numeric() && r.is_numeric()) {
                 // 只要有一方是 Irrational 或 Symbolic，优先生成符号表达式
                 std::shared_ptr<SymbolicExpr> leftExpr;
                 std::shared_ptr<SymbolicExpr> rightExpr;
                 if (l.is_symbolic()) {
-                    leftExpr = std::get<std::shared_ptr<SymbolicExpr>>(l.data);
+                    leftExpr = l.get<std::shared_ptr<SymbolicExpr>>();
                 } else {
                     leftExpr = from_number_to_symbolic(l);
                 }
                 if (r.is_symbolic()) {
-                    rightExpr = std::get<std::shared_ptr<SymbolicExpr>>(r.data);
+                    rightExpr = r.get<std::shared_ptr<SymbolicExpr>>();
                 } else {
                     rightExpr = from_number_to_symbolic(r);
                 }
@@ -549,13 +723,13 @@ Value Interpreter::eval_BinaryExpr(const BinaryExpr* bin) {
             }
             if (l.is_rational() && (r.is_bigint() || r.is_int())) {
                 // 如果底数为Rational，指数为整数，结果为Rational
-                ::BigInt rb = r.is_bigint() ? std::get<::BigInt>(r.data) : ::BigInt(r.as_number());
+                ::BigInt rb = r.as_bigint();
                 return Value(l.as_rational().power(rb));
             }
             if ((l.is_bigint() || r.is_int()) && (r.is_bigint() || r.is_int())) {
                 // 如果底数为整数，指数为整数，结果为BigInt
-                ::BigInt lb = l.is_bigint() ? std::get<::BigInt>(l.data) : ::BigInt(l.as_number());
-                ::BigInt rb = r.is_bigint() ? std::get<::BigInt>(r.data) : ::BigInt(r.as_number());
+                ::BigInt lb = l.as_bigint();
+                ::BigInt rb = r.as_bigint();
 				if (rb < ::BigInt(0)) {
 					return Value(l.as_rational().reciprocal().power(::BigInt(0) - rb));
 				} else {
@@ -565,10 +739,10 @@ Value Interpreter::eval_BinaryExpr(const BinaryExpr* bin) {
 			if ((l.is_int() || l.is_bigint() || l.is_rational()) && r.is_rational()) {
 				// 底数和指数均为Rational，考虑符号表达式
 				::Rational lb;
-				if (l.is_int()) lb = ::Rational(l.as_number());
-				else if (l.is_bigint()) lb = ::Rational(std::get<::BigInt>(l.data));
-				else lb = std::get<::Rational>(l.data);
-				return Value(SymbolicExpr::power(SymbolicExpr::number(lb), SymbolicExpr::number(std::get<::Rational>(r.data)))->simplify());
+				if (l.is_int()) lb = l.as_rational();
+				else if (l.is_bigint()) lb = ::Rational(l.get<::BigInt>());
+				else lb = l.get<::Rational>();
+				return Value(SymbolicExpr::power(SymbolicExpr::number(lb), SymbolicExpr::number(r.get<::Rational>()))->simplify());
 			}
             // 有小数，采用小数幂
             double ld = l.as_number();
@@ -581,132 +755,64 @@ Value Interpreter::eval_BinaryExpr(const BinaryExpr* bin) {
     }
 
     // Comparison operators
-    if (bin->op == "==" || bin->op == "!=" || bin->op == "<" ||
-        bin->op == "<=" || bin->op == ">" || bin->op == ">=") {
+    if (is_comparison(op)) {
         // Handle different type combinations
 		if (l.is_infinity() && r.is_infinity()) {
-			int lt = std::get<int>(l.data), rt = std::get<int>(r.data);
-			if (bin->op == "==") return lt == rt;
-			else if (bin->op == "!=") return lt != rt;
-			else if (bin->op == "<") return lt < rt;
-			else if (bin->op == "<=") return lt <= rt;
-			else if (bin->op == ">") return lt > rt;
-			else if (bin->op == ">=") return lt >= rt;
-			else return false;
+			int64_t lt = l.get<int64_t>(), rt = r.get<int64_t>();
+			return compare_with(op, lt, rt);
 		}
 		if (l.is_infinity()) {
-			if (bin->op == "==") return false;
-			if (bin->op == "!=") return true;
-			if (bin->op == ">" || bin->op == ">=") return (std::get<int>(l.data) > 0);
-			else return !(std::get<int>(l.data) > 0);
+			if (op == BinaryOp::Eq) return false;
+			if (op == BinaryOp::Ne) return true;
+			if (op == BinaryOp::Gt || op == BinaryOp::Ge) return (l.get<int>() > 0);
+			else return !(l.get<int>() > 0);
 		}
 		if (r.is_infinity()) {
-			if (bin->op == "==") return false;
-			if (bin->op == "!=") return true;
-			if (bin->op == "<" || bin->op == "<=") return (std::get<int>(r.data) > 0);
-			else return !(std::get<int>(r.data) > 0);
+			if (op == BinaryOp::Eq) return false;
+			if (op == BinaryOp::Ne) return true;
+			if (op == BinaryOp::Lt || op == BinaryOp::Le) return (r.get<int>() > 0);
+			else return !(r.get<int>() > 0);
 		}
         if (l.is_numeric() && r.is_numeric()) {
-            // BigInt 比较优先
+            // BigInt 比较优先：直接比较存储的 BigInt，另一侧不是 BigInt 时才按 as_bigint 转换
             if (l.is_bigint() || r.is_bigint()) {
-                ::BigInt lb = l.is_bigint() ? std::get<::BigInt>(l.data) : ::BigInt(l.as_number());
-                ::BigInt rb = r.is_bigint() ? std::get<::BigInt>(r.data) : ::BigInt(r.as_number());
-
-                // 使用字符串比较来判断大小（这是一个简化的实现）
-                std::string ls = lb.to_string();
-                std::string rs = rb.to_string();
-
-                if (bin->op == "==") return Value(ls == rs);
-                if (bin->op == "!=") return Value(ls != rs);
-
-                // 对于大小比较，需要考虑符号和长度
-                bool lb_neg = ls[0] == '-';
-                bool rb_neg = rs[0] == '-';
-
-                if (lb_neg && !rb_neg) {
-                    // 左负右正
-                    if (bin->op == "<") return Value(true);
-                    if (bin->op == "<=") return Value(true);
-                    if (bin->op == ">") return Value(false);
-                    if (bin->op == ">=") return Value(false);
-                } else if (!lb_neg && rb_neg) {
-                    // 左正右负
-                    if (bin->op == "<") return Value(false);
-                    if (bin->op == "<=") return Value(false);
-                    if (bin->op == ">") return Value(true);
-                    if (bin->op == ">=") return Value(true);
-                } else {
-                    // 同号比较：比较绝对值的长度和字典序
-                    std::string labs = lb_neg ? ls.substr(1) : ls;
-                    std::string rabs = rb_neg ? rs.substr(1) : rs;
-
-                    bool abs_less;
-                    if (labs.length() != rabs.length()) {
-                        abs_less = labs.length() < rabs.length();
-                    } else {
-                        abs_less = labs < rabs;
-                    }
-
-                    bool result_less = lb_neg ? !abs_less : abs_less;
-
-                    if (bin->op == "<") return Value(result_less);
-                    if (bin->op == "<=") return Value(result_less || ls == rs);
-                    if (bin->op == ">") return Value(!result_less && ls != rs);
-                    if (bin->op == ">=") return Value(!result_less);
-                }
-            } else {
-                double ld = l.as_number();
-                double rd = r.as_number();
-
-                if (bin->op == "==") return Value(ld == rd);
-                if (bin->op == "!=") return Value(ld != rd);
-                if (bin->op == "<") return Value(ld < rd);
-                if (bin->op == "<=") return Value(ld <= rd);
-                if (bin->op == ">") return Value(ld > rd);
-                if (bin->op == ">=") return Value(ld >= rd);
+                ::BigInt converted;
+                const ::BigInt& lb = l.is_bigint() ? l.get<::BigInt>() : (converted = l.as_bigint());
+                const ::BigInt& rb = r.is_bigint() ? r.get<::BigInt>() : (converted = r.as_bigint());
+                return Value(compare_with(op, lb, rb));
             }
+            double ld = l.as_number();
+            double rd = r.as_number();
+            return Value(compare_with(op, ld, rd));
         } else if (l.is_string() && r.is_string()) {
-            std::string ls = std::get<std::string>(l.data);
-            std::string rs = std::get<std::string>(r.data);
-
-            if (bin->op == "==") return Value(ls == rs);
-            if (bin->op == "!=") return Value(ls != rs);
-            if (bin->op == "<") return Value(ls < rs);
-            if (bin->op == "<=") return Value(ls <= rs);
-            if (bin->op == ">") return Value(ls > rs);
-            if (bin->op == ">=") return Value(ls >= rs);
+            const auto& ls = l.get<std::string>();
+            const auto& rs = r.get<std::string>();
+            return Value(compare_with(op, ls, rs));
         } else if (l.is_bool() && r.is_bool()) {
-            bool lb = std::get<bool>(l.data);
-            bool rb = std::get<bool>(r.data);
-
-            if (bin->op == "==") return Value(lb == rb);
-            if (bin->op == "!=") return Value(lb != rb);
             // For booleans, false < true
-            if (bin->op == "<") return Value(lb < rb);
-            if (bin->op == "<=") return Value(lb <= rb);
-            if (bin->op == ">") return Value(lb > rb);
-            if (bin->op == ">=") return Value(lb >= rb);
+            return Value(compare_with(op, l.get<bool>(), r.get<bool>()));
         } else {
             // Type mismatch - only equality/inequality make sense
-            if (bin->op == "==") return Value(false);   // Different types are never equal
-            if (bin->op == "!=") return Value(true);    // Different types are always not equal
+            if (op == BinaryOp::Eq) return Value(false);   // Different types are never equal
+            if (op == BinaryOp::Ne) return Value(true);    // Different types are always not equal
 
-            error_and_exit("Cannot compare different types with operator '" + bin->op + "'");
+            error_and_exit("Cannot compare different types with operator '" + std::string(binary_op_text(op)) + "'");
             return Value();
         }
     }
 
-    error_and_exit("Unknown binary operator '" + bin->op + "'");
+    error_and_exit("Unknown binary operator '" + std::string(binary_op_text(op)) + "'");
     return {};
 }
 
 Value Interpreter::eval_UnaryExpr(const UnaryExpr* unary) {
-    Value v = eval(unary->operand.get());
+    return apply_unary(unary->op, eval(unary->operand.get()));
+}
 
-    if (unary->op == "-") {
+Value Interpreter::apply_unary(UnaryOp op, Value v) {
+    if (op == UnaryOp::Neg) {
 		if (v.is_infinity()) {
-			v.data = Value::DataType(std::in_place_index<2>, 0-(std::get<int>(v.data)));
-			return v;
+			return Value::infinity(0-(v.get<int>()));
 		}
         if (v.type != Value::Type::Int && v.type != Value::Type::BigInt && v.type != Value::Type::Float) {
             RuntimeError error("Unary operator '-' requires integer, float or big integer operand");
@@ -714,19 +820,20 @@ Value Interpreter::eval_UnaryExpr(const UnaryExpr* unary) {
             throw error;
         }
         if (v.type == Value::Type::Int) {
-            int vi = std::get<int>(v.data);
+            int64_t vi = v.get<int64_t>();
+            if (vi == INT64_MIN) return Value(::BigInt(vi).negate());
             return Value(-vi);
         }
         if (v.type == Value::Type::Float) {
-            float vf = std::get<double>(v.data);
+            float vf = v.get<double>();
             return Value(-vf);
         }
         // For BigInt, negate directly
-        ::BigInt big_val = std::get<::BigInt>(v.data);
+        ::BigInt big_val = v.get<::BigInt>();
         return Value(big_val.negate());
     }
 
-    if (unary->op == "!") {
+    if (op == UnaryOp::Fact) {
         if (v.type != Value::Type::Int && v.type != Value::Type::BigInt) {
             RuntimeError error("Unary operator '!' requires integer or big integer operand");
             error.stack_trace = get_stack_trace();
@@ -734,9 +841,9 @@ Value Interpreter::eval_UnaryExpr(const UnaryExpr* unary) {
         }
         int vi;
         if (v.type == Value::Type::Int) {
-            vi = std::get<int>(v.data);
+            vi = v.get<int>();
         } else {
-            vi = std::get<::BigInt>(v.data).to_int();
+            vi = v.get<::BigInt>().to_int();
         }
 
         if (vi < 0) {
@@ -747,18 +854,14 @@ Value Interpreter::eval_UnaryExpr(const UnaryExpr* unary) {
 
         // Use BigInt for factorial if the number is large or result would be large
         if (vi > 20) {
-            ::BigInt result(1);
-            for (int j = 2; j <= vi; ++j) {
-                result = result * ::BigInt(j);
-            }
-            return Value(result);
+            return Value(::BigInt::factorial(::BigInt(vi)));
         }
-        // Use regular int for small factorials
-        int res = 1;
+        // 20! 仍在 int64 范围内
+        int64_t res = 1;
         for (int j = 1; j <= vi; ++j) res *= j;
         return Value(res);
     }
 
-    std::cerr << "Error: Unknown unary operator '" << unary->op << "'" << std::endl;
+    std::cerr << "Error: Unknown unary operator '" << unary_op_text(op) << "'" << std::endl;
     return Value("<unknown op>");
 }
@@ -0,0 +1,144 @@
+#include "include_prefetch.hpp"
+#include "interpreter.hpp"
+#include "module_cache.hpp"
+
+namespace {
+// 解析以文件读取和分配为主，少量线程即可覆盖
+constexpr unsigned max_prefetch_threads = 4;
+
+bool stat_file(const std::string& path, std::filesystem::file_time_type& mtime, uintmax_t& size) {
+    std::error_code ec;
+    mtime = std::filesystem::last_write_time(path, ec);
+    if (ec) return false;
+    size = std::filesystem::file_size(path, ec);
+    return !ec;
+}
+}// namespace
+
+IncludePrefetcher::~IncludePrefetcher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        queue.clear();
+    }
+    work_ready.notify_all();
+    for (auto& t: workers) t.join();
+}
+
+void IncludePrefetcher::collect(const ASTNode* node, std::vector<std::string>& paths) const {
+    if (!node) return;
+    switch (node->kind) {
+        case NodeKind::IncludeStmt: {
+            std::string path = Interpreter::find_module_script(static_cast<const IncludeStmt*>(node)->module);
+            if (!path.empty()) paths.push_back(std::move(path));
+            break;
+        }
+        case NodeKind::BlockStmt:
+            for (const auto& stmt: static_cast<const BlockStmt*>(node)->statements) collect(stmt.get(), paths);
+            break;
+        case NodeKind::IfStmt: {
+            auto* ifs = static_cast<const IfStmt*>(node);
+            collect(ifs->thenBlock.get(), paths);
+            collect(ifs->elseBlock.get(), paths);
+            break;
+        }
+        case NodeKind::WhileStmt:
+            collect(static_cast<const WhileStmt*>(node)->body.get(), paths);
+            break;
+        case NodeKind::FuncDefStmt:
+            collect(static_cast<const FuncDefStmt*>(node)->body.get(), paths);
+            break;
+        default:
+            break;
+    }
+}
+
+void IncludePrefetcher::scan(const ASTNode* root) {
+    std::vector<std::string> paths;
+    collect(root, paths);
+    if (!paths.empty()) submit(paths);
+}
+
+void IncludePrefetcher::submit(const std::vector<std::string>& paths) {
+    size_t pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) return;
+        for (const auto& path: paths) {
+            if (entries.contains(path)) continue;
+            entries.emplace(path, std::make_unique<Entry>());
+            queue.push_back(path);
+        }
+        pending = queue.size();
+        // 按需启动线程，没有 include 的脚本不创建线程
+        const unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+        while (workers.size() < std::min({pending, size_t(hw), size_t(max_prefetch_threads)})) {
+            workers.emplace_back(&IncludePrefetcher::worker, this);
+        }
+    }
+    work_ready.notify_all();
+}
+
+void IncludePrefetcher::worker() {
+    while (true) {
+        std::string path;
+        Entry* entry;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            work_ready.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (stopping) return;
+            path = std::move(queue.front());
+            queue.pop_front();
+            entry = entries.at(path).get();
+        }
+
+        // entry 只有本线程写，done 置位后才由 take 读取
+        bool opened = stat_file(path, entry->mtime, entry->size);
+        SyntaxTree tree;
+        std::string diagnostics;
+        if (opened) {
+            auto file = std::make_shared<const MappedFile>(path);
+            opened = static_cast<bool>(*file);
+            if (opened) {
+                try {
+                    tree = ModuleCache::parse(path, std::move(file), &diagnostics);
+                } catch (...) {
+                    // 解析抛出的错误交给 load_module 重新解析时在主线程上报
+                    opened = false;
+                    diagnostics.clear();
+                }
+            }
+        }
+        if (tree.root) scan(tree.root.get());
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            entry->opened = opened;
+            entry->tree = std::move(tree);
+            entry->diagnostics = std::move(diagnostics);
+            entry->done = true;
+        }
+        work_done.notify_all();
+    }
+}
+
+bool IncludePrefetcher::take(const std::string& path, SyntaxTree& tree, std::string& diagnostics) {
+    Entry* entry;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        auto it = entries.find(path);
+        if (it == entries.end()) return false;
+        entry = it->second.get();
+        work_done.wait(lock, [entry] { return entry->done; });
+        if (entry->taken) return false;
+        entry->taken = true;
+    }
+    // 取走后 entry 不再被其他线程访问
+    if (!entry->opened) return false;
+    std::filesystem::file_time_type mtime;
+    uintmax_t size;
+    if (!stat_file(path, mtime, size) || mtime != entry->mtime || size != entry->size) return false;
+    tree = std::move(entry->tree);
+    diagnostics = std::move(entry->diagnostics);
+    return true;
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include "ast.hpp"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#ifdef LAMINA_CORE_EXPORTS
+#define LAMINA_API __declspec(dllexport)
+#else
+#define LAMINA_API __declspec(dllimport)
+#endif
+#else
+#define LAMINA_API
+#endif
+
+/*
+    include 的后台预解析：扫描已解析代码中的 include 语句，把能找到的脚本交给线程池读取和解析，
+    解析结果中的 include 继续提交，直到覆盖整个传递闭包。
+    执行仍由 Interpreter::load_module 按原顺序进行，只是到达 include 时直接取走已解析好的 AST；
+    诊断信息也由 load_module 在原本解析的时机打印
+ */
+class LAMINA_API IncludePrefetcher {
+public:
+    IncludePrefetcher() = default;
+    ~IncludePrefetcher();
+    IncludePrefetcher(const IncludePrefetcher&) = delete;
+    IncludePrefetcher& operator=(const IncludePrefetcher&) = delete;
+
+    // 提交 root 中所有 include 语句（含函数体和分支内）对应的脚本
+    void scan(const ASTNode* root);
+    // 取走 path 的解析结果，必要时等待后台线程完成。
+    // 未提交、文件无法读取或提交后文件被修改过时返回 false，由调用方自行解析
+    bool take(const std::string& path, SyntaxTree& tree, std::string& diagnostics);
+
+private:
+    struct Entry {
+        bool done = false;
+        bool opened = false;
+        // 已被取走的条目仍留在表中，避免后续扫描到同一脚本时重复解析
+        bool taken = false;
+        SyntaxTree tree;
+        std::string diagnostics;
+        // 读取前的修改时间和大小，take 时不一致即视为过期
+        std::filesystem::file_time_type mtime;
+        uintmax_t size = 0;
+    };
+
+    std::mutex mutex;
+    std::condition_variable work_ready;
+    std::condition_variable work_done;
+    std::deque<std::string> queue;
+    std::unordered_map<std::string, std::unique_ptr<Entry>> entries;
+    std::vector<std::thread> workers;
+    bool stopping = false;
+
+    void collect(const ASTNode* node, std::vector<std::string>& paths) const;
+    void submit(const std::vector<std::string>& paths);
+    void worker();
+};
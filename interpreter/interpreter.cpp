@@ -3,8 +3,10 @@
 #include "bigint.hpp"
 #include "lamina.hpp"
 #include "lexer.hpp"
+#include "module_cache.hpp"
 #include "module_loader.hpp"
 #include "parser.hpp"
+#include "resolver.hpp"
 
 #include <cmath>
 #include <cstdlib>// For std::exit
@@ -36,28 +38,118 @@
 
 // 这些异常类已经移到了 interpreter.hpp
 
-// Scope stack operations
-void Interpreter::push_scope() {
-    variable_stack.emplace_back();
+uint32_t SymbolTable::intern(const std::string& name) {
+    auto [it, inserted] = ids.try_emplace(name, static_cast<uint32_t>(names.size()));
+    if (inserted) names.push_back(name);
+    return it->second;
 }
 
-void Interpreter::add_function(const std::string& name, FuncDefStmt* func) {
-    functions[name] = func;
+int GlobalTable::slot(const std::string& name) {
+    auto [it, inserted] = index.try_emplace(name, static_cast<int>(values.size()));
+    if (inserted) {
+        values.emplace_back();
+        defined.push_back(0);
+        shadowed.push_back(0);
+    }
+    return it->second;
+}
+
+const Value* GlobalTable::find(const std::string& name) const {
+    auto it = index.find(name);
+    if (it == index.end() || !defined[it->second]) return nullptr;
+    return &values[it->second];
+}
+
+// Frame stack operations
+void Interpreter::push_scope(const FuncDefStmt* func, size_t base) {
+    if (frames.size() == frames.capacity()) ++frame_arena.allocations;
+    frames.push_back({func, base});
+}
+
+void Interpreter::add_function(const std::string& name, const FuncDefStmt* func) {
+    auto& slot = functions[name];
+    if (slot != func) {
+        slot = func;
+        invalidate_call_cache();
+    }
+}
+
+const CallCache& Interpreter::resolve_callee(const std::string& name, CallCache& cache) {
+    if (cache.epoch == call_cache_epoch && cache.global_count == globals.values.size()) {
+        return cache;
+    }
+    cache = CallCache{};
+    cache.epoch = call_cache_epoch;
+    cache.global_count = globals.values.size();
+    cache.name_id = symbols.intern(name);
+
+    // 名字出现在全局表或任一函数的局部槽位中时，才可能被变量遮蔽
+    cache.may_be_variable = globals.index.contains(name);
+    for (auto it = functions.begin(); !cache.may_be_variable && it != functions.end(); ++it) {
+        if (!it->second) continue;
+        for (const auto& local: it->second->locals) {
+            if (local == name) {
+                cache.may_be_variable = true;
+                break;
+            }
+        }
+    }
+
+    auto builtin_it = builtin_functions.find(name);
+    if (builtin_it != builtin_functions.end()) {
+        cache.target = CallCache::Target::Builtin;
+        cache.builtin = &builtin_it->second;
+        return cache;
+    }
+    auto func_it = functions.find(name);
+    if (func_it != functions.end()) {
+        cache.target = CallCache::Target::Function;
+        cache.func = func_it->second;
+        return cache;
+    }
+    cache.target = name.find('.') != std::string::npos ? CallCache::Target::Module : CallCache::Target::Undefined;
+    return cache;
 }
 
-void Interpreter::save_repl_ast(std::unique_ptr<ASTNode> ast) {
+void Interpreter::save_repl_ast(SyntaxTree ast) {
     repl_asts.push_back(std::move(ast));
 }
 
 void Interpreter::pop_scope() {
-    if (variable_stack.size() > 1) variable_stack.pop_back();
+    if (!frames.empty()) {
+        frame_arena.release(frames.back().base);
+        frames.pop_back();
+    }
 }
 
-Value Interpreter::get_variable(const std::string& name) const {
-    for (auto it = variable_stack.rbegin(); it != variable_stack.rend(); ++it) {
-        auto found = it->find(name);
-        if (found != it->end()) return found->second;
+const Value* Interpreter::find_variable(const std::string& name) const {
+    // 由内向外查找调用帧（保持动态作用域），最后查全局表
+    for (auto it = frames.rbegin(); it != frames.rend(); ++it) {
+        const auto& locals = it->func->locals;
+        for (size_t i = 0; i < locals.size(); ++i) {
+            if (frame_arena.assigned[it->base + i] && locals[i] == name) return &frame_arena.values[it->base + i];
+        }
+    }
+    return globals.find(name);
+}
+
+bool Interpreter::locals_read_by_name(const FuncDefStmt* func) const {
+    const size_t seen = globals.dynamic_reads.size();
+    if (func->dynamic_reads_checked != seen) {
+        func->locals_read_by_name = false;
+        for (const auto& name: func->locals) {
+            if (globals.dynamic_reads.count(name)) {
+                func->locals_read_by_name = true;
+                break;
+            }
+        }
+        func->dynamic_reads_checked = seen;
     }
+    return func->locals_read_by_name;
+}
+
+Value Interpreter::get_variable(const std::string& name) const {
+    if (const Value* found = find_variable(name)) return *found;
 
     // 如果变量找不到，检查是否是函数名
     auto func_it = functions.find(name);
@@ -73,189 +165,317 @@ Value Interpreter::get_variable(const std::string& name) const {
     return Value();// Unreachable, but suppress compiler warning
 }
 
-void Interpreter::set_variable(const std::string& name, const Value& val) {
-    if (!variable_stack.empty()) {
-        (*variable_stack.rbegin())[name] = val;
+void Interpreter::set_variable(const std::string& name, Value val) {
+    if (!frames.empty()) {
+        const CallFrame& frame = frames.back();
+        const auto& locals = frame.func->locals;
+        for (size_t i = 0; i < locals.size(); ++i) {
+            if (locals[i] == name) {
+                frame_arena.values[frame.base + i] = std::move(val);
+                frame_arena.assigned[frame.base + i] = 1;
+                return;
+            }
+        }
     }
+    globals.set(globals.slot(name), std::move(val));
+}
+
+void Interpreter::set_global_variable(const std::string& name, Value val) {
+    globals.set(globals.slot(name), std::move(val));
 }
 
-void Interpreter::set_global_variable(const std::string& name, const Value& val) {
-    if (!variable_stack.empty()) {
-        variable_stack.front()[name] = val;
+Value Interpreter::load_variable(const Binding& binding, const std::string& name) const {
+    switch (binding.scope) {
+        case Binding::Scope::Local: {
+            const size_t i = frames.back().base + binding.index;
+            if (frame_arena.assigned[i]) return frame_arena.values[i];
+            break;
+        }
+        case Binding::Scope::Global:
+            // 嵌套调用时外层帧可能遮蔽全局名字，交给按名查找；没有函数以该名字作局部变量时不会被遮蔽
+            if ((frames.size() <= 1 || !globals.shadowed[binding.index]) && globals.defined[binding.index]) {
+                return globals.values[binding.index];
+            }
+            break;
+        default:
+            break;
+    }
+    return get_variable(name);
+}
+
+Value* Interpreter::variable_slot(const Binding& binding) {
+    switch (binding.scope) {
+        case Binding::Scope::Local: {
+            const size_t i = frames.back().base + binding.index;
+            return frame_arena.assigned[i] ? &frame_arena.values[i] : nullptr;
+        }
+        case Binding::Scope::Global:
+            // 与 load_variable 一致：嵌套调用时交给按名查找
+            if ((frames.size() <= 1 || !globals.shadowed[binding.index]) && globals.defined[binding.index]) {
+                return &globals.values[binding.index];
+            }
+            return nullptr;
+        default:
+            return nullptr;
+    }
+}
+
+bool Interpreter::assign_append(const AssignStmt* a) {
+    if (a->expr->kind != NodeKind::BinaryExpr) return false;
+    const Value* slot = variable_slot(a->binding);
+    if (!slot || !(slot->is_string() || slot->is_bigint())) return false;
+    const auto operands = a->append_operands();
+    if (operands.empty()) return false;
+
+    // 先求出全部右操作数再依次累加到 l，结果与逐个相加相同
+    Value l = *slot;
+    std::vector<Value> rs;
+    rs.reserve(operands.size());
+    for (const Expression* operand: operands) rs.push_back(eval(operand));
+    // 求值可能改写该变量或让帧槽位扩容，重新取槽位并确认仍是同一个值
+    Value* target = variable_slot(a->binding);
+    if (target && target->shares_payload(l)) {
+        l = Value();// 交还引用，槽位独占缓冲区后原地累加
+        for (const Value& r: rs) {
+            if (!apply_in_place(BinaryOp::Add, *target, r)) *target = apply_binary(BinaryOp::Add, *target, r);
+        }
+    } else {
+        for (const Value& r: rs) {
+            if (!apply_in_place(BinaryOp::Add, l, r)) l = apply_binary(BinaryOp::Add, l, r);
+        }
+        store_variable(a->binding, a->name, std::move(l));
+    }
+    return true;
+}
+
+void Interpreter::store_variable(const Binding& binding, const std::string& name, Value val) {
+    switch (binding.scope) {
+        case Binding::Scope::Local: {
+            const size_t i = frames.back().base + binding.index;
+            frame_arena.values[i] = std::move(val);
+            frame_arena.assigned[i] = 1;
+            break;
+        }
+        case Binding::Scope::Global:
+            globals.set(binding.index, std::move(val));
+            break;
+        default:
+            set_variable(name, std::move(val));
+            break;
     }
 }
 
 void Interpreter::execute(const std::unique_ptr<Statement>& node) {
-    if (!node) return;
+    // 顶层语句：把未被消费的控制流状态转换为异常，交给调用方报告
+    switch (exec_statement(node.get())) {
+        case Completion::Return:
+            throw ReturnException(std::move(return_value));
+        case Completion::Break:
+            throw BreakException();
+        case Completion::Continue:
+            throw ContinueException();
+        default:
+            break;
+    }
+}
 
-    if (auto* v = dynamic_cast<VarDeclStmt*>(node.get())) {
-        if (v->expr) {
-            Value val = eval(v->expr.get());
-            set_variable(v->name, val);
-        } else {
-            RuntimeError error("Variable '" + v->name + "' declaration has null expression");
-            error.stack_trace = get_stack_trace();
-            throw error;
-        }
-    } else if (auto* d = dynamic_cast<DefineStmt*>(node.get())) {
-        if (!d->value) {
-            error_and_exit("Null expression in define statement for '" + d->name + "'");
-        }
-        Value val = eval(d->value.get());
-        // 删除递归限制
-        /*if (d->name == "MAX_RECURSION_DEPTH" && val.is_int()) {
-            int new_depth = std::get<int>(val.data);
-            if (new_depth > 0 && new_depth <= 10000) {
-                max_recursion_depth = new_depth;
-                std::cout << "Recursion depth limit set to: " << new_depth << std::endl;
+Completion Interpreter::exec_statements(const std::vector<std::unique_ptr<Statement>>& statements) {
+    for (const auto& stmt: statements) {
+        Completion completion = exec_statement(stmt.get());
+        if (completion != Completion::Normal) return completion;
+    }
+    return Completion::Normal;
+}
+
+Completion Interpreter::exec_statement(const Statement* node) {
+    if (!node) return Completion::Normal;
+
+    switch (node->kind) {
+        case NodeKind::VarDeclStmt: {
+            auto* v = static_cast<const VarDeclStmt*>(node);
+            if (v->expr) {
+                store_variable(v->binding, v->name, eval(v->expr.get()));
             } else {
-                error_and_exit("Invalid recursion depth value: " + std::to_string(new_depth) + " (must be between 1 and 10000)");
+                RuntimeError error("Variable '" + v->name + "' declaration has null expression");
+                error.stack_trace = get_stack_trace();
+                throw error;
             }
-        } else {
-            // 原：std::cerr << "Error: Unknown define constant: " << d->name << std::endl;
-            // 已替换
-        }*/
-    } else if (auto* bi = dynamic_cast<BigIntDeclStmt*>(node.get())) {
-        if (bi->init_value) {
-            Value val = eval(bi->init_value.get());
-            if (val.is_bigint()) {
-                // 如果值已经是BigInt，直接使用
-                set_variable(bi->name, val);
-            } else if (val.is_int()) {
-                // 将普通整数转换为BigInt
-                ::BigInt big_val(std::get<int>(val.data));
-                set_variable(bi->name, Value(big_val));
-            } else if (val.is_string()) {
-                // 从字符串创建BigInt
-                try {
-                    ::BigInt big_val(std::get<std::string>(val.data));
-                    set_variable(bi->name, Value(big_val));
-                } catch (const std::exception& e) {
-                    error_and_exit("Invalid BigInt string '" + std::get<std::string>(val.data) + "' in declaration of " + bi->name);
+            break;
+        }
+        case NodeKind::DefineStmt: {
+            auto* d = static_cast<const DefineStmt*>(node);
+            if (!d->value) {
+                error_and_exit("Null expression in define statement for '" + d->name + "'");
+            }
+            Value val = eval(d->value.get());
+            // 删除递归限制
+            /*if (d->name == "MAX_RECURSION_DEPTH" && val.is_int()) {
+                int new_depth = val.get<int>();
+                if (new_depth > 0 && new_depth <= 10000) {
+                    max_recursion_depth = new_depth;
+                    std::cout << "Recursion depth limit set to: " << new_depth << std::endl;
+                } else {
+                    error_and_exit("Invalid recursion depth value: " + std::to_string(new_depth) + " (must be between 1 and 10000)");
                 }
             } else {
-                // 默认初始化为0
-                error_and_exit("Cannot convert " + val.to_string() + " to BigInt in declaration of " + bi->name);
-            }
-        } else {
-            set_variable(bi->name, Value(::BigInt(0)));
+                // 原：std::cerr << "Error: Unknown define constant: " << d->name << std::endl;
+                // 已替换
+            }*/
+            break;
         }
-    } else if (auto* a = dynamic_cast<AssignStmt*>(node.get())) {
-        if (!a->expr) {
-            error_and_exit("Null expression in assignment to '" + a->name + "'");
-        }
-        Value val = eval(a->expr.get());
-        set_variable(a->name, val);
-    } else if (auto* a = dynamic_cast<StructDeclStmt*>(node.get())) {
-        std::vector<std::pair<std::string, Value>> struct_init_val{};
-        for (const auto& [n, e]: a->init_vec) {
-            auto val = eval(e.get());
-            struct_init_val.emplace_back(n, val);
+        case NodeKind::BigIntDeclStmt: {
+            auto* bi = static_cast<const BigIntDeclStmt*>(node);
+            if (bi->init_value) {
+                Value val = eval(bi->init_value.get());
+                if (val.is_bigint()) {
+                    // 如果值已经是BigInt，直接使用
+                    store_variable(bi->binding, bi->name, std::move(val));
+                } else if (val.is_int()) {
+                    // 将普通整数转换为BigInt
+                    store_variable(bi->binding, bi->name, Value(::BigInt(val.get<int64_t>())));
+                } else if (val.is_string()) {
+                    // 从字符串创建BigInt
+                    try {
+                        store_variable(bi->binding, bi->name, Value(::BigInt(val.get<std::string>())));
+                    } catch (const std::exception& e) {
+                        error_and_exit("Invalid BigInt string '" + val.get<std::string>() + "' in declaration of " + bi->name);
+                    }
+                } else {
+                    // 默认初始化为0
+                    error_and_exit("Cannot convert " + val.to_string() + " to BigInt in declaration of " + bi->name);
+                }
+            } else {
+                store_variable(bi->binding, bi->name, Value(::BigInt(0)));
+            }
+            break;
         }
-        set_variable(a->name, new_lstruct(struct_init_val));
-    } else if (auto* ifs = dynamic_cast<IfStmt*>(node.get())) {
-        if (!ifs->condition) {
-            error_and_exit("Null condition in if statement");
+        case NodeKind::AssignStmt: {
+            auto* a = static_cast<const AssignStmt*>(node);
+            if (!a->expr) {
+                error_and_exit("Null expression in assignment to '" + a->name + "'");
+            }
+            if (assign_append(a)) break;
+            store_variable(a->binding, a->name, eval(a->expr.get()));
+            break;
         }
-        Value cond = eval(ifs->condition.get());
-        bool cond_true = cond.as_bool();
-        if (cond_true) {
-            for (auto& stmt: ifs->thenBlock->statements) execute(stmt);
-        } else if (ifs->elseBlock) {
-            for (auto& stmt: ifs->elseBlock->statements) execute(stmt);
+        case NodeKind::StructDeclStmt: {
+            auto* a = static_cast<const StructDeclStmt*>(node);
+            std::vector<std::pair<std::string, Value>> struct_init_val{};
+            for (const auto& [n, e]: a->init_vec) {
+                struct_init_val.emplace_back(n, eval(e.get()));
+            }
+            store_variable(a->binding, a->name, new_lstruct(struct_init_val));
+            break;
         }
-    } else if (auto* ws = dynamic_cast<WhileStmt*>(node.get())) {
-        if (!ws->condition) {
-            RuntimeError error("Loop condition cannot be null");
-            error.stack_trace = get_stack_trace();
-            throw error;
+        case NodeKind::IfStmt: {
+            auto* ifs = static_cast<const IfStmt*>(node);
+            if (!ifs->condition) {
+                error_and_exit("Null condition in if statement");
+            }
+            Value cond = eval(ifs->condition.get());
+            bool cond_true = cond.as_bool();
+            if (cond_true) {
+                return exec_statements(ifs->thenBlock->statements);
+            } else if (ifs->elseBlock) {
+                return exec_statements(ifs->elseBlock->statements);
+            }
+            break;
         }
+        case NodeKind::WhileStmt: {
+            auto* ws = static_cast<const WhileStmt*>(node);
+            if (!ws->condition) {
+                RuntimeError error("Loop condition cannot be null");
+                error.stack_trace = get_stack_trace();
+                throw error;
+            }
 
-        // 更健壮的while循环实现
-
-        try {
-            while (true) {
-                // 评估循环条件
-                Value cond;
-                try {
-                    cond = eval(ws->condition.get());
-                } catch (const std::exception& e) {
-                    // 如果条件计算出错，优雅地退出循环
-                    RuntimeError error("Loop condition error: " + std::string(e.what()));
-                    error.stack_trace = get_stack_trace();
-                    throw error;
-                }
-
-                if (!cond.as_bool()) {
-                    // 条件为假，退出循环
-                    break;
-                }
-
-                bool continue_encountered = false;
-
-                // 执行循环体
-                for (auto& stmt: ws->body->statements) {
-                    if (continue_encountered) continue;
+            // 更健壮的while循环实现
 
+            try {
+                while (true) {
+                    // 评估循环条件
+                    Value cond;
                     try {
-                        execute(stmt);
-                    } catch (const BreakException&) {
-                        // 退出整个循环
-                        return;
-                    } catch (const ContinueException&) {
-                        // 跳到下一次迭代
-                        continue_encountered = true;
+                        cond = eval(ws->condition.get());
+                    } catch (const std::exception& e) {
+                        // 如果条件计算出错，优雅地退出循环
+                        RuntimeError error("Loop condition error: " + std::string(e.what()));
+                        error.stack_trace = get_stack_trace();
+                        throw error;
+                    }
+
+                    if (!cond.as_bool()) {
+                        // 条件为假，退出循环
+                        break;
                     }
+
+                    // 执行循环体，continue 直接进入下一次迭代
+                    Completion completion = exec_statements(ws->body->statements);
+                    if (completion == Completion::Break) break;
+                    if (completion == Completion::Return) return completion;
                 }
-            }
-        } catch (const BreakException&) {
-            // 捕获可能从嵌套块冒泡上来的break异常
-            return;
-        } catch (const ReturnException&) {
-            // 函数返回，直接传递给上层
-            throw;
-        } catch (const std::exception& e) {
-            // 所有其他异常都作为运行时错误处理
-            RuntimeError error("Loop body execution error: " + std::string(e.what()));
-            error.stack_trace = get_stack_trace();
-            throw error;
-        }
-    } else if (auto* func = dynamic_cast<FuncDefStmt*>(node.get())) {
-        functions[func->name] = func;
-    } else if (auto* block = dynamic_cast<BlockStmt*>(node.get())) {
-        for (auto& stmt: block->statements) execute(stmt);
-    } else if (auto* ret = dynamic_cast<ReturnStmt*>(node.get())) {
-        Value val = eval(ret->expr.get());
-        throw ReturnException(val);
-    } else if (auto* breakStmt = dynamic_cast<BreakStmt*>(node.get())) {
-        (void) breakStmt;// 避免未使用变量警告
-        throw BreakException();
-    } else if (auto* contStmt = dynamic_cast<ContinueStmt*>(node.get())) {
-        (void) contStmt;// 避免未使用变量警告
-        throw ContinueException();
-    } else if (auto* includeStmt = dynamic_cast<IncludeStmt*>(node.get())) {
-        if (!load_module(includeStmt->module)) {
-            error_and_exit("Failed to include module '" + includeStmt->module + "'");
-        }
-    } else if (auto* exprstmt = dynamic_cast<ExprStmt*>(node.get())) {
-        if (exprstmt->expr) {
-            try {
-                // std::cerr << "DEBUG: Executing expression statement" << std::endl;
-                Value result = eval(exprstmt->expr.get());
-                // std::cerr << "DEBUG: Expression result: " << result.to_string() << std::endl;
-            } catch (const StdLibException& e){
-                throw StdLibException(e.what());
             } catch (const std::exception& e) {
-                std::cerr << "ERROR: Exception in expression statement: " << e.what() << std::endl;
-            } catch (...) {
-                std::cerr << "ERROR: Unknown exception in expression statement" << std::endl;
+                // 所有其他异常都作为运行时错误处理
+                RuntimeError error("Loop body execution error: " + std::string(e.what()));
+                error.stack_trace = get_stack_trace();
+                throw error;
             }
-        } else {
-            error_and_exit("Empty expression statement");
+            break;
+        }
+        case NodeKind::FuncDefStmt: {
+            auto* func = static_cast<const FuncDefStmt*>(node);
+            add_function(func->name, func);
+            break;
+        }
+        case NodeKind::BlockStmt: {
+            auto* block = static_cast<const BlockStmt*>(node);
+            return exec_statements(block->statements);
         }
-    } else if (auto* nullstmt = dynamic_cast<NullStmt*>(node.get())) {
-        (void) nullstmt;
+        case NodeKind::ReturnStmt: {
+            auto* ret = static_cast<const ReturnStmt*>(node);
+            if (ret->tail_call) {
+                pending_tail_call = static_cast<const CallExpr*>(ret->expr.get());
+                return Completion::Return;
+            }
+            return_value = eval(ret->expr.get());
+            return Completion::Return;
+        }
+        case NodeKind::BreakStmt:
+            return Completion::Break;
+        case NodeKind::ContinueStmt:
+            return Completion::Continue;
+        case NodeKind::IncludeStmt: {
+            auto* includeStmt = static_cast<const IncludeStmt*>(node);
+            if (!load_module(includeStmt->module)) {
+                error_and_exit("Failed to include module '" + includeStmt->module + "'");
+            }
+            break;
+        }
+        case NodeKind::ExprStmt: {
+            auto* exprstmt = static_cast<const ExprStmt*>(node);
+            if (exprstmt->expr) {
+                try {
+                    // std::cerr << "DEBUG: Executing expression statement" << std::endl;
+                    Value result = eval(exprstmt->expr.get());
+                    // std::cerr << "DEBUG: Expression result: " << result.to_string() << std::endl;
+                } catch (const StdLibException& e){
+                    throw StdLibException(e.what());
+                } catch (const std::exception& e) {
+                    std::cerr << "ERROR: Exception in expression statement: " << e.what() << std::endl;
+                } catch (...) {
+                    std::cerr << "ERROR: Unknown exception in expression statement" << std::endl;
+                }
+            } else {
+                error_and_exit("Empty expression statement");
+            }
+            break;
+        }
+        case NodeKind::NullStmt:
+            break;
+        default:
+            break;
     }
+    return Completion::Normal;
 }
 
 
@@ -263,41 +483,86 @@ Value Interpreter::eval(const ASTNode* node) {
     if (!node) {
         error_and_exit("Attempted to evaluate null expression");
     }
-    if (auto* lit = dynamic_cast<const LiteralExpr*>(node)) {
-        return eval_LiteralExpr(lit);
-    }
-    if (auto* id = dynamic_cast<const IdentifierExpr*>(node)) {
-        return get_variable(id->name);
-    }
-    if (auto* var = dynamic_cast<const VarExpr*>(node)) {
-        return get_variable(var->name);
-    }
-    if (auto* bin = dynamic_cast<const BinaryExpr*>(node)) {
-        return eval_BinaryExpr(bin);
-    }
-    if (auto* unary = dynamic_cast<const UnaryExpr*>(node)) {
-        return eval_UnaryExpr(unary);
-    }// Support function calls
-    if (auto* call = dynamic_cast<const CallExpr*>(node)) {
-        return eval_CallExpr(call);
-    }
-    if (auto* arr = dynamic_cast<const ArrayExpr*>(node)) {
-        std::vector<Value> elements;
-        for (const auto& element: arr->elements) {
-            if (element) {
-                elements.push_back(eval(element.get()));
-            } else {
-                std::cerr << "Error: Null element in array literal" << std::endl;
-                return Value();
+    switch (node->kind) {
+        case NodeKind::LiteralExpr:
+            return eval_LiteralExpr(static_cast<const LiteralExpr*>(node));
+        case NodeKind::IdentifierExpr: {
+            auto* id = static_cast<const IdentifierExpr*>(node);
+            return load_variable(id->binding, id->name);
+        }
+        case NodeKind::VarExpr: {
+            auto* var = static_cast<const VarExpr*>(node);
+            return load_variable(var->binding, var->name);
+        }
+        case NodeKind::BinaryExpr:
+            return eval_BinaryExpr(static_cast<const BinaryExpr*>(node));
+        case NodeKind::UnaryExpr:
+            return eval_UnaryExpr(static_cast<const UnaryExpr*>(node));
+        // Support function calls
+        case NodeKind::CallExpr:
+            return eval_CallExpr(static_cast<const CallExpr*>(node));
+        case NodeKind::ArrayExpr: {
+            auto* arr = static_cast<const ArrayExpr*>(node);
+            std::vector<Value> elements;
+            elements.reserve(arr->elements.size());
+            for (const auto& element: arr->elements) {
+                if (element) {
+                    elements.push_back(eval(element.get()));
+                } else {
+                    std::cerr << "Error: Null element in array literal" << std::endl;
+                    return Value();
+                }
             }
+            return Value(std::move(elements));
         }
-        return Value(elements);
+        default:
+            break;
     }
     std::cerr << "Error: Unsupported expression type" << std::endl;
     return Value("<type error>");
 }
 
 // Load and execute module
+// 平台相关动态库扩展名
+#if defined(_WIN32)
+static constexpr const char* lib_ext = ".dll";
+#elif defined(__APPLE__)
+static constexpr const char* lib_ext = ".dylib";
+#else
+static constexpr const char* lib_ext = ".so";
+#endif
+
+// Try different paths: current directory, examples directory, etc.
+// 常量不需要析构：error_and_exit 退出时后台预解析线程可能仍在查找路径
+static constexpr const char* search_paths[] = {"", ".", "include", "extensions"};
+
+// 在搜索路径中查找脚本文件，找不到时返回空串
+static std::string find_script_file(const std::string& filename) {
+    for (const auto& path: search_paths) {
+        std::string full_path = (std::filesystem::path(path) / filename).string();
+        std::error_code ec;
+        if (std::filesystem::is_regular_file(full_path, ec)) {
+            return full_path;
+        }
+    }
+    return {};
+}
+
+std::string Interpreter::find_module_script(const std::string& module_name) {
+    if (module_name == "splash" || module_name == "them") return {};
+    if (module_name.find(lib_ext) != std::string::npos) return {};
+    std::string filename = module_name;
+    if (filename.find(".lm") == std::string::npos) {
+        filename += ".lm";
+    }
+    return find_script_file(filename);
+}
+
+void Interpreter::prefetch_includes(const ASTNode* root) {
+    if (!prefetcher) prefetcher = std::make_unique<IncludePrefetcher>();
+    prefetcher->scan(root);
+}
+
 bool Interpreter::load_module(const std::string& module_name) {
     // Check if already loaded to avoid circular imports
     if (loaded_modules.contains(module_name)) {
@@ -312,15 +577,6 @@ bool Interpreter::load_module(const std::string& module_name) {
         clean_name = clean_name.substr(3);
     }
 
-// 平台相关动态库扩展名
-#if defined(_WIN32)
-    const std::string lib_ext = ".dll";
-#elif defined(__APPLE__)
-    const std::string lib_ext = ".dylib";
-#else
-    const std::string lib_ext = ".so";
-#endif
-
     // Handle built-in hidden library "splash"
     if (module_name == "splash") {
         print_logo();
@@ -337,8 +593,6 @@ bool Interpreter::load_module(const std::string& module_name) {
     bool has_lm = filename.find(".lm") != std::string::npos;
     bool has_lib = filename.find(lib_ext) != std::string::npos;
 
-    // Try different paths: current directory, examples directory, etc.
-    const std::vector<std::string> search_paths = {"", ".", "include", "extensions"};
     std::string full_path;
 
     // 如果指定了动态库扩展名，直接尝试加载动态库
@@ -380,15 +634,17 @@ bool Interpreter::load_module(const std::string& module_name) {
         filename += ".lm";
     }
 
-    std::ifstream file;
-    for (const auto& path: search_paths) {
-        full_path = (std::filesystem::path(path) / filename).string();
-        file.open(full_path);
-        if (file) break;
+    // 脚本的实际路径按文件名记忆，重复 include 时不再逐个探测搜索路径
+    auto known = module_paths.find(filename);
+    if (known == module_paths.end()) {
+        full_path = find_script_file(filename);
+        if (!full_path.empty()) {
+            known = module_paths.emplace(filename, full_path).first;
+        }
     }
 
     // 如果没找到脚本文件，尝试查找动态库（lib前缀和无前缀，自动适配扩展名）
-    if (!file) {
+    if (known == module_paths.end()) {
         std::vector<std::string> lib_names = {
                 "lib" + clean_name + lib_ext,
                 clean_name + lib_ext};
@@ -431,26 +687,37 @@ bool Interpreter::load_module(const std::string& module_name) {
     }
 
 
-    // Read file into string
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    std::string source = buffer.str();
-    file.close();
-
+    full_path = known->second;
+    SyntaxTree ast;
+    std::string diagnostics;
+    if (prefetcher && prefetcher->take(full_path, ast, diagnostics)) {
+        // 后台已解析好；诊断信息在原本解析的位置输出
+        std::cerr << diagnostics;
+    } else {
+        auto file = std::make_shared<const MappedFile>(full_path);
+        if (!*file) {
+            std::cerr << "Error: Cannot read module '" << module_name << "' from " << full_path << std::endl;
+            module_paths.erase(known);
+            loaded_modules.erase(module_name);
+            return false;
+        }
 
-    // Lexical and syntax analysis
-    auto tokens = Lexer::tokenize(source);
-    auto ast = Parser::parse(tokens);
+        // Lexical and syntax analysis, or the cached AST when the file is unchanged
+        ast = ModuleCache::parse(full_path, std::move(file));
+        // 模块自身的 include 交给后台，执行模块期间并行解析
+        if (prefetcher && ast.root) prefetcher->scan(ast.root.get());
+    }
 
-    if (!ast) {
+    if (!ast.root) {
         std::cerr << "Error: Failed to parse module '" << module_name << "'" << std::endl;
         loaded_modules.erase(module_name);// Remove from loaded modules on failure
         return false;
     }// Execute module code (should be a block statement)
-    auto* block = dynamic_cast<BlockStmt*>(ast.get());
+    auto* block = dynamic_cast<BlockStmt*>(ast.root.get());
     if (block) {
-        // Execute module code in the current scope (not a new scope)
+        // Execute module code at global scope
         // This allows variables and functions to be accessible after inclusion
+        Resolver(globals).resolve(block);
         try {
             for (auto& stmt: block->statements) {
                 execute(stmt);
@@ -463,6 +730,7 @@ bool Interpreter::load_module(const std::string& module_name) {
 
         // Store the AST to keep function pointers valid
         loaded_module_asts.push_back(std::move(ast));
+        invalidate_call_cache();
         return true;
     }
     std::cerr << "Error: Module '" << module_name << "' does not contain valid code" << std::endl;
@@ -484,21 +752,22 @@ void Interpreter::register_builtin_functions() {
     for (auto entry: get_entry_functions()) {
         entry(*this);
     }
+    invalidate_call_cache();
 }
 
 // 将Number转为Symbolic(如果可能)
 std::shared_ptr<SymbolicExpr> Interpreter::from_number_to_symbolic(const Value& v) {
     std::shared_ptr<SymbolicExpr> expr;
     if (v.is_irrational()) {
-        expr = std::get<::Irrational>(v.data).to_symbolic();
+        expr = v.get<::Irrational>().to_symbolic();
     } else if (v.is_rational()) {
-        expr = SymbolicExpr::number(std::get<::Rational>(v.data));
+        expr = SymbolicExpr::number(v.get<::Rational>());
     } else if (v.is_bigint()) {
-        expr = SymbolicExpr::number(std::get<::BigInt>(v.data));
+        expr = SymbolicExpr::number(v.get<::BigInt>());
     } else if (v.is_int()) {
-        expr = SymbolicExpr::number(std::get<int>(v.data));
+        expr = SymbolicExpr::number(v.get<int64_t>());
     } else if (v.is_float()) {
-        expr = SymbolicExpr::number(::Rational::from_double(std::get<double>(v.data)));
+        expr = SymbolicExpr::number(::Rational::from_double(v.get<double>()));
     } else {
         expr = SymbolicExpr::number(0);// 失败，返回0
     }
@@ -520,23 +789,23 @@ LAMINA_EXPORT void error_and_exit(const std::string& msg) {
 
 // 打印当前所有变量
 void Interpreter::printVariables() const {
-    if (variable_stack.empty()) {
-        std::cout << "No variables defined." << std::endl;
-        return;
-    }
-
     std::cout << "\nCurrent variable list:" << std::endl;
     std::cout << "--------------------" << std::endl;
 
-    // 从最内层作用域开始打印
+    // 从最内层调用帧开始打印，最后是全局变量
     bool hasVars = false;
-    for (auto it = variable_stack.rbegin(); it != variable_stack.rend(); ++it) {
-        const auto& scope = *it;
-        for (const auto& [name, value]: scope) {
-            std::cout << name << " = " << value.to_string() << std::endl;
+    for (auto it = frames.rbegin(); it != frames.rend(); ++it) {
+        for (size_t i = 0; i < it->func->locals.size(); ++i) {
+            if (!frame_arena.assigned[it->base + i]) continue;
+            std::cout << it->func->locals[i] << " = " << frame_arena.values[it->base + i].to_string() << std::endl;
             hasVars = true;
         }
     }
+    for (const auto& [name, index]: globals.index) {
+        if (!globals.defined[index]) continue;
+        std::cout << name << " = " << globals.values[index].to_string() << std::endl;
+        hasVars = true;
+    }
 
     if (!hasVars) {
         std::cout << "No variables defined." << std::endl;
@@ -554,7 +823,7 @@ void Interpreter::printVariables() const {
 
 // Stack trace management functions
 void Interpreter::push_frame(const std::string& function_name, const std::string& file_name, int line_number) {
-    call_stack.emplace_back(function_name, file_name, line_number);
+    push_frame(symbols.intern(function_name), symbols.intern(file_name), line_number);
 }
 
 void Interpreter::pop_frame() {
@@ -581,14 +850,23 @@ void Interpreter::print_stack_trace(const RuntimeError& error, bool use_colors)
             std::cerr << "Traceback (most recent call last):\n";
         }
 
-        // Print stack frames
-        for (const auto& frame: trace) {
+        // Print stack frames; deep recursion only shows both ends of the trace
+        constexpr size_t edge_frames = 10;
+        for (size_t i = 0; i < trace.size(); ++i) {
+            if (trace.size() > 3 * edge_frames && i == edge_frames) {
+                std::cerr << "  [... " << trace.size() - 2 * edge_frames << " more frames ...]\n";
+                i = trace.size() - edge_frames - 1;
+                continue;
+            }
+            const auto& frame = trace[i];
+            const std::string& file_name = symbols.name(frame.file_id);
+            const std::string& function_name = symbols.name(frame.function_id);
             if (colors_enabled) {
-                std::cerr << "  File \"\033[1;34m" << frame.file_name << "\033[0m\", line "
-                          << frame.line_number << ", in \033[1;33m" << frame.function_name << "\033[0m\n";
+                std::cerr << "  File \"\033[1;34m" << file_name << "\033[0m\", line "
+                          << frame.line_number << ", in \033[1;33m" << function_name << "\033[0m\n";
             } else {
-                std::cerr << "  File \"" << frame.file_name << "\", line "
-                          << frame.line_number << ", in " << frame.function_name << "\n";
+                std::cerr << "  File \"" << file_name << "\", line "
+                          << frame.line_number << ", in " << function_name << "\n";
             }
         }
     }
@@ -9,26 +9,47 @@
 #define LAMINA_API
 #endif
 #include "ast.hpp"
+#include "include_prefetch.hpp"
 #include "module_loader.hpp"
 #include "value.hpp"
+#include <cstdint>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <set>
 #include <stack>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 // 前向声明在 lamina.hpp 中已定义，无需重复声明
 
-// Stack frame for function call tracking
+// Stack frame for function call tracking.
+// Names are SymbolTable IDs and are only turned back into strings when the trace is printed
 struct StackFrame {
-    std::string function_name;
-    std::string file_name;
+    uint32_t function_id;
+    uint32_t file_id;
+    // 进入该帧的调用表达式所在的源码行（CallExpr::span.line），未知时为 0
     int line_number;
+};
+
+// 符号表：把函数名、文件名映射为稳定的整数 ID，只增不删
+struct SymbolTable {
+    // 预先登记的文件名
+    static constexpr uint32_t script_id = 0;
+    static constexpr uint32_t builtin_id = 1;
+
+    // deque 增长时不移动已有元素，name() 返回的引用一直有效
+    std::deque<std::string> names;
+    std::unordered_map<std::string, uint32_t> ids;
 
-    StackFrame(const std::string& func, const std::string& file, int line)
-        : function_name(func), file_name(file), line_number(line) {}
+    SymbolTable() {
+        intern("<script>");
+        intern("<builtin>");
+    }
+    uint32_t intern(const std::string& name);
+    const std::string& name(uint32_t id) const { return names[id]; }
 };
 
 // Enhanced runtime error class with stack trace support
@@ -77,7 +98,101 @@ public:
     ContinueException() = default;
 };
 
+// 全局变量表：Resolver 在执行前为每个全局名字分配固定下标
+struct GlobalTable {
+    std::vector<Value> values;
+    std::vector<unsigned char> defined;
+    // 该名字是否是某个函数的局部变量：是则嵌套调用中外层帧可能遮蔽全局值，需要按名查找
+    std::vector<unsigned char> shadowed;
+    std::unordered_map<std::string, int> index;
+    // 函数体内可能沿调用链按名查找的名字（未绑定到本帧的读取、读取时可能尚未赋值的局部变量、被调名），
+    // 由 Resolver 收集；调用者帧中有同名局部变量时该帧不能被尾调用替换
+    std::unordered_set<std::string> dynamic_reads;
+
+    // 返回名字对应的下标，不存在时分配一个未定义的槽位
+    int slot(const std::string& name);
+    const Value* find(const std::string& name) const;
+    void set(int i, Value val) {
+        values[i] = std::move(val);
+        defined[i] = 1;
+    }
+};
+
+// 函数调用帧的槽位分配区：调用时在栈顶取一段连续槽位，返回时整体释放。
+// 释放只缩小 size，容量留给后续调用复用，稳定状态下调用不再分配堆内存
+struct FrameArena {
+    std::vector<Value> values;
+    std::vector<unsigned char> assigned;
+    // 内置函数和模块函数的参数缓冲区，按这类调用的嵌套层数各用一个（deque 保证地址不变）
+    std::deque<std::vector<Value>> arg_buffers;
+    size_t arg_depth = 0;
+    // 统计：分配的帧数、调用路径上的堆分配次数：槽位、参数缓冲区，
+    // 以及 Interpreter 的 call_stack / frames 和 VM 调用栈，每次扩容计一次
+    size_t frames_allocated = 0;
+    size_t allocations = 0;
+
+    // 分配 n 个未赋值的槽位，返回起点
+    size_t allocate(size_t n) {
+        const size_t base = values.size();
+        if (base + n > values.capacity()) ++allocations;
+        if (base + n > assigned.capacity()) ++allocations;
+        values.resize(base + n);
+        assigned.resize(base + n, 0);
+        ++frames_allocated;
+        return base;
+    }
+    // 释放 base 及其上方的所有槽位
+    void release(size_t base) {
+        values.resize(base);
+        assigned.resize(base);
+    }
+
+    // 租用一个容量至少为 n 的空参数缓冲区，析构时清空并归还
+    class Args {
+    public:
+        Args(FrameArena& arena, size_t n) : arena(arena) {
+            if (arena.arg_depth == arena.arg_buffers.size()) {
+                arena.arg_buffers.emplace_back();
+                ++arena.allocations;
+            }
+            buffer = &arena.arg_buffers[arena.arg_depth++];
+            if (buffer->capacity() < n) {
+                buffer->reserve(n);
+                ++arena.allocations;
+            }
+        }
+        ~Args() {
+            buffer->clear();
+            --arena.arg_depth;
+        }
+        Args(const Args&) = delete;
+        Args& operator=(const Args&) = delete;
+        std::vector<Value>& operator*() { return *buffer; }
+        std::vector<Value>* operator->() { return buffer; }
+
+    private:
+        FrameArena& arena;
+        std::vector<Value>* buffer;
+    };
+};
+
+// 函数调用帧：槽位布局由 Resolver 写入 FuncDefStmt::locals，槽位存放在 FrameArena 中
+struct CallFrame {
+    const FuncDefStmt* func;
+    size_t base;
+};
+
+// 语句执行的完成状态：return/break/continue 通过返回值向上传递，异常只用于真正的错误
+enum class Completion : unsigned char {
+    Normal,
+    Return,// 返回值存放在 Interpreter::return_value
+    Break,
+    Continue
+};
+
 class LAMINA_API Interpreter {
+    friend class VM;
+    friend class ClosureCompiler;
     // 禁止拷贝，允许移动
     Interpreter(const Interpreter&) = delete;
     Interpreter& operator=(const Interpreter&) = delete;
@@ -88,22 +203,48 @@ public:
     Interpreter() {
         register_builtin_functions();
     }
+    // 执行顶层语句，未被消费的 return/break/continue 以异常形式抛出
     void execute(const std::unique_ptr<Statement>& node);
+    Completion exec_statement(const Statement* node);
+    Completion exec_statements(const std::vector<std::unique_ptr<Statement>>& statements);
     Value eval(const ASTNode* node);
     // Print all variables in current scope
     static Value eval_LiteralExpr(const LiteralExpr* node);
     Value eval_UnaryExpr(const UnaryExpr* unary);
     Value eval_BinaryExpr(const BinaryExpr* bin);
     Value eval_CallExpr(const CallExpr* call);
+    // 解析调用点的实际目标（含 "__function_" 间接调用），实际被调名为 symbol_name(name_id)
+    CallCache resolve_call(const CallExpr* call);
+    // 求值实参，直接写入从 base 开始的帧槽位
+    void eval_arguments(const CallExpr* call, const std::string& name, const FuncDefStmt* func, size_t base);
+    // 运算符求值（树遍历解释器与字节码 VM 共用）
+    Value apply_binary(BinaryOp op, const Value& l, const Value& r);
+    // 字符串拼接 l + r 写回 l：l 独占缓冲区时原地追加，循环拼接均摊 O(1)。
+    // l 不是字符串或 r 为无穷时返回 false，交给 apply_binary
+    static bool append_string(Value& l, const Value& r);
+    // l op r 写回 l：字符串拼接，以及 BigInt 与整数的 + - * 复用 l 的缓冲区。
+    // 其余组合返回 false，交给 apply_binary
+    static bool apply_in_place(BinaryOp op, Value& l, const Value& r);
+    Value apply_unary(UnaryOp op, Value v);
 
     void printVariables() const;
-    void add_function(const std::string& name, FuncDefStmt* func);
+    void add_function(const std::string& name, const FuncDefStmt* func);
     // Save AST in REPL mode to keep function pointers valid
-    void save_repl_ast(std::unique_ptr<ASTNode> ast);
+    void save_repl_ast(SyntaxTree ast);
+    // 在后台线程预解析 root 中 include 的脚本（含传递依赖），执行到 include 时直接使用
+    void prefetch_includes(const ASTNode* root);
+    // include 名对应的脚本路径，与 load_module 的查找规则一致；内置模块、动态库或找不到时为空
+    static std::string find_module_script(const std::string& module_name);
     // Stack trace management
     void push_frame(const std::string& function_name, const std::string& file_name = "<script>", int line_number = 0);
+    void push_frame(uint32_t function_id, uint32_t file_id = SymbolTable::script_id, int line_number = 0) {
+        if (call_stack.size() == call_stack.capacity()) ++frame_arena.allocations;
+        call_stack.push_back({function_id, file_id, line_number});
+    }
     void pop_frame();
+    const std::string& symbol_name(uint32_t id) const { return symbols.name(id); }
     std::vector<StackFrame> get_stack_trace() const;
+    const FrameArena& get_frame_arena() const { return frame_arena; }
     void print_stack_trace(const RuntimeError& error, bool use_colors = true) const;
 
     // Utility functions for error display
@@ -116,37 +257,73 @@ public:
     std::unordered_map<std::string, BuiltinFunction> builtin_functions;
     using EntryFunction = void (*)(Interpreter&);
     static void register_entry(EntryFunction func);
-    // Variable assignment
-    void set_variable(const std::string& name, const Value& val);
+    // Variable assignment, the value is moved into its slot
+    void set_variable(const std::string& name, Value val);
     // built global variable in interpreter
-    void set_global_variable(const std::string& name, const Value& val);
+    void set_global_variable(const std::string& name, Value val);
     // Variable lookup
     Value get_variable(const std::string& name) const;
+    // Variable lookup without throwing, nullptr when undefined
+    const Value* find_variable(const std::string& name) const;
     // Call module function
     Value call_module_function(const std::string& func_name, const std::vector<Value>& args);
-    // Variable scope stack, top is the current scope
-    std::vector<std::unordered_map<std::string, Value>> variable_stack{{}};
+    // Call-site caches are refilled after this; call it after changing builtin_functions at runtime
+    void invalidate_call_cache() { ++call_cache_epoch; }
+    // Resolve a callee name through the given call-site cache
+    const CallCache& resolve_callee(const std::string& name, CallCache& cache);
+    // Global variables, indexed by the slots assigned by Resolver
+    GlobalTable globals;
+    // 函数被调用满这么多次后改用闭包编译层执行函数体，0 表示关闭
+    uint32_t closure_threshold = 0;
 
 private:
     // Store function definitions
-    std::unordered_map<std::string, FuncDefStmt*> functions;
+    std::unordered_map<std::string, const FuncDefStmt*> functions;
+    // Value of the latest return statement, consumed by the caller
+    Value return_value;
+    // 尾调用的 return 留下的调用表达式，由 eval_CallExpr 在弹出当前帧前接手
+    const CallExpr* pending_tail_call = nullptr;
+    // func 的局部变量是否可能被被调函数按名读到；是则其帧不能被尾调用替换
+    bool locals_read_by_name(const FuncDefStmt* func) const;
+    // Bumped whenever functions are (re)defined or modules loaded
+    uint64_t call_cache_epoch = 1;
     // List of loaded modules to prevent circular imports
     std::set<std::string> loaded_modules;
+    // include 的脚本文件名 -> 在搜索路径中找到的实际路径
+    std::unordered_map<std::string, std::string> module_paths;
     // Store loaded module ASTs to keep function pointers valid
-    std::vector<std::unique_ptr<ASTNode>> loaded_module_asts;
+    std::vector<SyntaxTree> loaded_module_asts;
     // Store REPL ASTs to keep function pointers valid in interactive mode
-    std::vector<std::unique_ptr<ASTNode>> repl_asts;
+    std::vector<SyntaxTree> repl_asts;
     // Store loaded module loaders for function calls
     std::vector<std::unique_ptr<ModuleLoader>> module_loaders;
+    // include 的后台预解析，首次 prefetch_includes 时创建
+    std::unique_ptr<IncludePrefetcher> prefetcher;
 
     // Stack trace for function calls
     std::vector<StackFrame> call_stack;
+    // Function and file names referenced by call_stack
+    SymbolTable symbols;
+    // Function call frames, back() is the current function
+    std::vector<CallFrame> frames;
     // Recursion depth tracking
     int recursion_depth = 0;
-    int max_recursion_depth = 100;// 可变的递归深度限制
-    // Enter/exit scope
-    void push_scope();
+    // 树遍历解释器与闭包层的递归深度限制。调用在原生栈用尽前切换到堆上的栈段（见 native_stack.hpp），
+    // 每层仍占约 1 KB 原生栈，10^5 层约 120 MB；更深的递归只有 VM 支持（VM::max_call_depth）
+    int max_recursion_depth = 100000;
+    // Enter/exit function frame
+    // Slots for function calls, shared with the VM
+    FrameArena frame_arena;
+    void push_scope(const FuncDefStmt* func, size_t base);
     void pop_scope();
+    Value load_variable(const Binding& binding, const std::string& name) const;
+    // 绑定对应的已赋值槽位，按名查找的情况返回 nullptr
+    Value* variable_slot(const Binding& binding);
+    // 执行 x = x + e1 + e2 ...，x 为字符串或 BigInt 时原地累加；不适用时返回 false
+    bool assign_append(const AssignStmt* a);
+    void store_variable(const Binding& binding, const std::string& name, Value val);
+    // 执行函数体：热点函数走闭包编译层，其余逐条解释
+    Completion exec_body(const FuncDefStmt* func);
     // Load and execute module
     bool load_module(const std::string& module_name);
     // Register builtin functions
@@ -34,9 +34,10 @@ constexpr bool always_false = false;
 #define LAMINA_INT(value) Value((int) value)
 #define LAMINA_DOUBLE(value) Value((double) value)
 #define LAMINA_STRING(value) Value((const char*) value)
-#define LAMINA_BIGINT(value) Value((const ::BigInt&) value)
-#define LAMINA_RATIONAL(value) Value((const ::Rational&) value)
-#define LAMINA_IRRATIONAL(value) Value((const ::Irrational&) value)
+// 右值实参被移动进 Value，左值照常复制
+#define LAMINA_BIGINT(value) Value(::BigInt(value))
+#define LAMINA_RATIONAL(value) Value(::Rational(value))
+#define LAMINA_IRRATIONAL(value) Value(::Irrational(value))
 #define LAMINA_COMPLEX(real, imag) Value(::lamina::Complex(real, imag))
 #define LAMINA_ARR(value) Value(value)
 #define LAMINA_MATRIX(value) Value(value)
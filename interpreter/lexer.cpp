@@ -1,38 +1,109 @@
 #include "lexer.hpp"
 #include <algorithm>
-#include <cctype>
+#include <array>
+#include <cstdint>
 #include <iostream>
-#include <map>
 
-static std::map<std::string, TokenType> keywords;
-static bool keywords_registered = false;
+namespace {
 
-void registerKeywords() {
-    if (keywords_registered) return;
-    keywords["var"] = TokenType::Var;
-    keywords["func"] = TokenType::Func;
-    keywords["if"] = TokenType::If;
-    keywords["else"] = TokenType::Else;
-    keywords["while"] = TokenType::While;
-    keywords["for"] = TokenType::For;
-    keywords["return"] = TokenType::Return;
-    keywords["include"] = TokenType::Include;
-    keywords["break"] = TokenType::Break;
-    keywords["continue"] = TokenType::Continue;
-    keywords["define"] = TokenType::Define;
-    keywords["bigint"] = TokenType::Bigint;
-    keywords["struct"] = TokenType::Struct;
-    keywords["true"] = TokenType::True;
-    keywords["false"] = TokenType::False;
-    keywords["null"] = TokenType::Null;
-    keywords_registered = true;
+// ASCII 字符分类表，与 C locale 下的 isalpha/isdigit/isspace 一致，非 ASCII 字节不属于任何类别
+enum CharClass : uint8_t {
+    Space = 1,
+    Digit = 2,
+    IdentStart = 4,// 字母和下划线
+    IdentPart = 8  // 字母、数字和下划线
+};
+
+constexpr std::array<uint8_t, 256> make_char_classes() {
+    std::array<uint8_t, 256> table{};
+    for (unsigned char c: {' ', '\t', '\n', '\v', '\f', '\r'}) table[c] = Space;
+    for (int c = '0'; c <= '9'; ++c) table[c] = Digit | IdentPart;
+    for (int c = 'a'; c <= 'z'; ++c) table[c] = IdentStart | IdentPart;
+    for (int c = 'A'; c <= 'Z'; ++c) table[c] = IdentStart | IdentPart;
+    table['_'] = IdentStart | IdentPart;
+    return table;
+}
+
+constexpr std::array<uint8_t, 256> char_classes = make_char_classes();
+
+inline bool is_class(char c, uint8_t cls) {
+    return char_classes[static_cast<unsigned char>(c)] & cls;
+}
+
+// 关键字的完美哈希：由长度、首字符和末字符算出槽位，编译期检查无冲突
+struct Keyword {
+    std::string_view text;
+    TokenType type;
+};
+
+constexpr Keyword keyword_list[] = {
+        {"var", TokenType::Var},
+        {"func", TokenType::Func},
+        {"if", TokenType::If},
+        {"else", TokenType::Else},
+        {"while", TokenType::While},
+        {"for", TokenType::For},
+        {"return", TokenType::Return},
+        {"include", TokenType::Include},
+        {"break", TokenType::Break},
+        {"continue", TokenType::Continue},
+        {"define", TokenType::Define},
+        {"bigint", TokenType::Bigint},
+        {"struct", TokenType::Struct},
+        {"true", TokenType::True},
+        {"false", TokenType::False},
+        {"null", TokenType::Null}};
+
+constexpr size_t keyword_slots = 32;
+
+constexpr size_t keyword_slot(std::string_view s) {
+    return (s.size() * 7 + static_cast<unsigned char>(s.front()) * 23 + static_cast<unsigned char>(s.back())) % keyword_slots;
 }
 
-std::vector<Token> Lexer::tokenize(const std::string& src) {
-    std::vector<Token> tokens;
+constexpr std::array<Keyword, keyword_slots> make_keyword_table() {
+    std::array<Keyword, keyword_slots> table{};
+    for (const auto& kw: keyword_list) table[keyword_slot(kw.text)] = kw;
+    return table;
+}
+
+constexpr std::array<Keyword, keyword_slots> keyword_table = make_keyword_table();
+
+constexpr bool keyword_table_complete() {
+    for (const auto& kw: keyword_list) {
+        if (keyword_table[keyword_slot(kw.text)].text != kw.text) return false;
+    }
+    return true;
+}
+static_assert(keyword_table_complete(), "keyword hash collision, adjust keyword_slot");
+
+inline TokenType keyword_or_identifier(std::string_view ident) {
+    const Keyword& kw = keyword_table[keyword_slot(ident)];
+    return kw.text == ident ? kw.type : TokenType::Identifier;
+}
+
+thread_local std::ostream* diagnostics_stream = nullptr;
+
+}// namespace
+
+std::ostream& frontend_diagnostics() {
+    return diagnostics_stream ? *diagnostics_stream : std::cerr;
+}
+
+DiagnosticCapture::DiagnosticCapture(std::ostream& out) : previous(diagnostics_stream) {
+    diagnostics_stream = &out;
+}
+
+DiagnosticCapture::~DiagnosticCapture() {
+    diagnostics_stream = previous;
+}
+
+TokenList Lexer::tokenize(std::string_view src) {
+    TokenList result;
+    std::vector<Token>& tokens = result.tokens;
+    // 多数 token 只占几个字节，按源码长度预留避免反复扩容
+    tokens.reserve(src.size() / 3 + 16);
     size_t i = 0;
-    int line = 1, col = 1;
-    registerKeywords();
+    size_t line = 1, col = 1;
     // Clear log for debugging
     // Debug: std::cerr << "Starting tokenization of " << src.length() << " characters" << std::endl;
     while (i < src.size()) {
@@ -42,72 +113,72 @@ std::vector<Token> Lexer::tokenize(const std::string& src) {
             ++i;
             continue;
         }
-        if (isspace(src[i])) {
+        if (is_class(src[i], Space)) {
             ++col;
             ++i;
             continue;
         }
         size_t start_col = col;
 
-        if (isalpha(src[i]) || src[i] == '_') {
+        if (is_class(src[i], IdentStart)) {
             size_t j = i + 1;
-            while (j < src.size() && (isalnum(src[j]) || src[j] == '_')) ++j;
-            std::string ident = src.substr(i, j - i);
-            TokenType type = TokenType::Identifier;
-            if (keywords.count(ident)) type = keywords[ident];
-            tokens.emplace_back(type, ident, line, start_col);
+            while (j < src.size() && is_class(src[j], IdentPart)) ++j;
+            std::string_view ident = src.substr(i, j - i);
+            tokens.emplace_back(keyword_or_identifier(ident), ident, i, j - i, line, start_col);
             col += (j - i);
             i = j;
         } else if (src[i] == '=' && i + 1 < src.size() && src[i + 1] == '=') {
-            tokens.emplace_back(TokenType::Equal, "==", line, start_col);
+            tokens.emplace_back(TokenType::Equal, "==", i, 2, line, start_col);
             i += 2;
             col += 2;
         } else if (src[i] == '!' && i + 1 < src.size() && src[i + 1] == '=') {
-            tokens.emplace_back(TokenType::NotEqual, "!=", line, start_col);
+            tokens.emplace_back(TokenType::NotEqual, "!=", i, 2, line, start_col);
             i += 2;
             col += 2;
         } else if (src[i] == '<' && i + 1 < src.size() && src[i + 1] == '=') {
-            tokens.emplace_back(TokenType::LessEqual, "<=", line, start_col);
+            tokens.emplace_back(TokenType::LessEqual, "<=", i, 2, line, start_col);
             i += 2;
             col += 2;
         } else if (src[i] == '>' && i + 1 < src.size() && src[i + 1] == '=') {
-            tokens.emplace_back(TokenType::GreaterEqual, ">=", line, start_col);
+            tokens.emplace_back(TokenType::GreaterEqual, ">=", i, 2, line, start_col);
             i += 2;
             col += 2;
         } else if (src[i] == '<') {
-            tokens.emplace_back(TokenType::Less, "<", line, start_col);
+            tokens.emplace_back(TokenType::Less, "<", i, 1, line, start_col);
             ++i;
             ++col;
         } else if (src[i] == '>') {
-            tokens.emplace_back(TokenType::Greater, ">", line, start_col);
+            tokens.emplace_back(TokenType::Greater, ">", i, 1, line, start_col);
             ++i;
             ++col;
         } else if (src[i] == '=') {
-            tokens.emplace_back(TokenType::Assign, "=", line, start_col);
+            tokens.emplace_back(TokenType::Assign, "=", i, 1, line, start_col);
             ++i;
             ++col;
         } else if (src[i] == '>') {
-            tokens.emplace_back(TokenType::Greater, ">", line, start_col);
+            tokens.emplace_back(TokenType::Greater, ">", i, 1, line, start_col);
             ++i;
             ++col;
-        } else if (isdigit(src[i]) || (src[i] == '.' && i + 1 < src.size() && isdigit(src[i + 1]))) {
+        } else if (is_class(src[i], Digit) || (src[i] == '.' && i + 1 < src.size() && is_class(src[i + 1], Digit))) {
             size_t j = i;
             bool has_dot = false;
-            bool has_underscore;
+            bool has_underscore = false;
+            bool any_underscore = false;
 
             // Handle decimal numbers including scientific notation
             // Parse mantissa (before 'e' or 'E')
             while (j < src.size()) {
                 // 允许数字、单个小数点（仅一次）和下划线（作为分隔符）
-                if (isdigit(src[j])) {
+                if (is_class(src[j], Digit)) {
                     has_underscore = false; // 重置下划线标志
                     ++j;
                 } else if (src[j] == '.' && !has_dot) {
                     has_dot = true;
                     has_underscore = false; // 重置下划线标志
                     ++j;
-                } else if (src[j] == '_' && !has_underscore && j > i && j + 1 < src.size() && isdigit(src[j + 1])) {
+                } else if (src[j] == '_' && !has_underscore && j > i && j + 1 < src.size() && is_class(src[j + 1], Digit)) {
                     has_underscore = true;
+                    any_underscore = true;
                     ++j;
                 } else {
                     break;
@@ -126,13 +197,14 @@ std::vector<Token> Lexer::tokenize(const std::string& src) {
 
                 // 解析指数部分的数字（允许下划线）
                 has_underscore = false; // 重置下划线标志
-                if (j < src.size() && isdigit(src[j])) {
+                if (j < src.size() && is_class(src[j], Digit)) {
                     while (j < src.size()) {
-                        if (isdigit(src[j])) {
+                        if (is_class(src[j], Digit)) {
                             has_underscore = false;
                             ++j;
-                        } else if (src[j] == '_' && !has_underscore && j + 1 < src.size() && isdigit(src[j + 1])) {
+                        } else if (src[j] == '_' && !has_underscore && j + 1 < src.size() && is_class(src[j + 1], Digit)) {
                             has_underscore = true;
+                            any_underscore = true;
                             ++j;
                         } else {
                             break;
@@ -144,83 +216,93 @@ std::vector<Token> Lexer::tokenize(const std::string& src) {
                 }
             }
 
-            // 提取数字字符串并移除所有下划线
-            std::string num_str = src.substr(i, j - i);
-            num_str.erase(std::remove(num_str.begin(), num_str.end(), '_'), num_str.end());
+            // 数字字符串直接引用源码，有下划线时移除后存入 decoded
+            std::string_view num_str = src.substr(i, j - i);
+            if (any_underscore) {
+                std::string& stripped = result.decoded.emplace_back(num_str);
+                stripped.erase(std::remove(stripped.begin(), stripped.end(), '_'), stripped.end());
+                num_str = stripped;
+            }
 
-            tokens.emplace_back(TokenType::Number, num_str, line, start_col);
+            tokens.emplace_back(TokenType::Number, num_str, i, j - i, line, start_col);
             col += (j - i);
             i = j;
         } else if (src[i] == '(') {
-            tokens.emplace_back(TokenType::LParen, "(", line, start_col);
+            tokens.emplace_back(TokenType::LParen, "(", i, 1, line, start_col);
             ++i;
             ++col;
         } else if (src[i] == ')') {
-            tokens.emplace_back(TokenType::RParen, ")", line, start_col);
+            tokens.emplace_back(TokenType::RParen, ")", i, 1, line, start_col);
             ++i;
             ++col;
         } else if (src[i] == ';') {
-            tokens.emplace_back(TokenType::Semicolon, ";", line, start_col);
+            tokens.emplace_back(TokenType::Semicolon, ";", i, 1, line, start_col);
             ++i;
             ++col;
         } else if (src[i] == '"' || src[i] == '\'') {
             char quote_type = src[i];
             size_t j = i + 1;
-            std::string str_content;
-
-            while (j < src.size() && src[j] != quote_type) {
-                if (src[j] == '\\' && j + 1 < src.size()) {
-                    // Handle escape sequences
-                    char next = src[j + 1];
-                    switch (next) {
-                        case 'n':
-                            str_content += '\n';
-                            break;
-                        case 't':
-                            str_content += '\t';
-                            break;
-                        case 'r':
-                            str_content += '\r';
-                            break;
-                        case '\\':
-                            str_content += '\\';
-                            break;
-                        case '"':
-                            str_content += '"';
-                            break;
-                        case '\'':
-                            str_content += '\'';
-                            break;
-                        default:
-                            str_content += '\\';
-                            str_content += next;
-                            break;
+            // 没有转义序列时直接引用源码
+            while (j < src.size() && src[j] != quote_type && src[j] != '\\') ++j;
+            std::string_view str_content = src.substr(i + 1, j - i - 1);
+            if (j < src.size() && src[j] == '\\') {
+                // 含转义序列：从第一个反斜杠起在 decoded 中逐字符改写
+                std::string& unescaped = result.decoded.emplace_back(str_content);
+                while (j < src.size() && src[j] != quote_type) {
+                    if (src[j] == '\\' && j + 1 < src.size()) {
+                        // Handle escape sequences
+                        char next = src[j + 1];
+                        switch (next) {
+                            case 'n':
+                                unescaped += '\n';
+                                break;
+                            case 't':
+                                unescaped += '\t';
+                                break;
+                            case 'r':
+                                unescaped += '\r';
+                                break;
+                            case '\\':
+                                unescaped += '\\';
+                                break;
+                            case '"':
+                                unescaped += '"';
+                                break;
+                            case '\'':
+                                unescaped += '\'';
+                                break;
+                            default:
+                                unescaped += '\\';
+                                unescaped += next;
+                                break;
+                        }
+                        j += 2;
+                    } else {
+                        unescaped += src[j];
+                        j++;
                     }
-                    j += 2;
-                } else {
-                    str_content += src[j];
-                    j++;
                 }
+                str_content = unescaped;
             }
 
             if (j >= src.size()) {// Unterminated string
-                std::cerr << "Error: Unterminated string literal at line " << line << std::endl;
+                frontend_diagnostics() << "Error: Unterminated string literal at line " << line << std::endl;
                 i = src.size();// Stop tokenizing
             } else {
-                tokens.emplace_back(TokenType::String, str_content, line, start_col);
+                tokens.emplace_back(TokenType::String, str_content, i, j - i + 1, line, start_col);
                 col += (j - i + 1);
                 i = j + 1;
             }
         } else if (src[i] == '+') {
-            tokens.emplace_back(TokenType::Plus, "+", line, start_col);
+            tokens.emplace_back(TokenType::Plus, "+", i, 1, line, start_col);
             ++i;
             ++col;
         } else if (src[i] == '-') {
-            tokens.emplace_back(TokenType::Minus, "-", line, start_col);
+            tokens.emplace_back(TokenType::Minus, "-", i, 1, line, start_col);
             ++i;
             ++col;
         } else if (src[i] == '*') {
-            tokens.emplace_back(TokenType::Star, "*", line, start_col);
+            tokens.emplace_back(TokenType::Star, "*", i, 1, line, start_col);
             ++i;
             ++col;
         } else if (src[i] == '/' && i + 1 < src.size() && src[i + 1] == '/') {
@@ -248,51 +330,51 @@ std::vector<Token> Lexer::tokenize(const std::string& src) {
             i = j;
             continue;
         } else if (src[i] == '/') {
-            tokens.emplace_back(TokenType::Slash, "/", line, start_col);
+            tokens.emplace_back(TokenType::Slash, "/", i, 1, line, start_col);
             ++i;
             ++col;
         } else if (src[i] == '%') {
-            tokens.emplace_back(TokenType::Percent, "%", line, start_col);
+            tokens.emplace_back(TokenType::Percent, "%", i, 1, line, start_col);
             ++i;
             ++col;
         } else if (src[i] == '^') {
-            tokens.emplace_back(TokenType::Caret, "^", line, start_col);
+            tokens.emplace_back(TokenType::Caret, "^", i, 1, line, start_col);
             ++i;
             ++col;
         } else if (src[i] == '!') {
-            tokens.emplace_back(TokenType::Bang, "!", line, start_col);
+            tokens.emplace_back(TokenType::Bang, "!", i, 1, line, start_col);
             ++i;
             ++col;
         } else if (src[i] == '{') {
-            tokens.emplace_back(TokenType::LBrace, "{", line, start_col);
+            tokens.emplace_back(TokenType::LBrace, "{", i, 1, line, start_col);
             ++i;
             ++col;
         } else if (src[i] == '}') {
-            tokens.emplace_back(TokenType::RBrace, "}", line, start_col);
+            tokens.emplace_back(TokenType::RBrace, "}", i, 1, line, start_col);
             ++i;
             ++col;
         } else if (src[i] == '[') {
-            tokens.emplace_back(TokenType::LBracket, "[", line, start_col);
+            tokens.emplace_back(TokenType::LBracket, "[", i, 1, line, start_col);
             ++i;
             ++col;
         } else if (src[i] == ']') {
-            tokens.emplace_back(TokenType::RBracket, "]", line, start_col);
+            tokens.emplace_back(TokenType::RBracket, "]", i, 1, line, start_col);
             ++i;
             ++col;
         } else if (src[i] == ',') {
-            tokens.emplace_back(TokenType::Comma, ",", line, start_col);
+            tokens.emplace_back(TokenType::Comma, ",", i, 1, line, start_col);
             ++i;
             ++col;
         } else if (src[i] == '.') {
-            tokens.emplace_back(TokenType::Dot, ".", line, start_col);
+            tokens.emplace_back(TokenType::Dot, ".", i, 1, line, start_col);
             ++i;
             ++col;
         } else {
-            tokens.emplace_back(TokenType::Unknown, std::string(1, src[i]), line, start_col);
+            tokens.emplace_back(TokenType::Unknown, src.substr(i, 1), i, 1, line, start_col);
             ++i;
             ++col;
         }
     }
-    tokens.emplace_back(TokenType::EndOfFile, "", line, col);
-    return tokens;
+    tokens.emplace_back(TokenType::EndOfFile, "", src.size(), 0, line, col);
+    return result;
 }
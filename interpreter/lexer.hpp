@@ -1,5 +1,9 @@
 #pragma once
+#include <cstdint>
+#include <deque>
+#include <ostream>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #ifdef _WIN32
@@ -12,7 +16,7 @@
 #define LAMINA_API
 #endif
 
-enum class TokenType {
+enum class TokenType : uint8_t {
     Var,
     Func,
     If,
@@ -62,14 +66,41 @@ enum class TokenType {
 
 struct Token {
     TokenType type;
-    std::string text;
-    size_t line;
-    size_t column;
-    Token(TokenType t, const std::string& txt, int l, int c)
-        : type(t), text(txt), line(l), column(c) {}
+    // 词素在源码中的字节范围（字符串含引号，数字含下划线），用于 AST 的源码区间
+    uint32_t offset;
+    uint32_t length;
+    // 不拥有内存：指向源码缓冲区，或 TokenList::decoded 中改写过的文本
+    std::string_view text;
+    uint32_t line;
+    uint32_t column;
+    Token(TokenType t, std::string_view txt, size_t off, size_t len, size_t l, size_t c)
+        : type(t), offset(static_cast<uint32_t>(off)), length(static_cast<uint32_t>(len)), text(txt),
+          line(static_cast<uint32_t>(l)), column(static_cast<uint32_t>(c)) {}
+};
+
+// 词法分析结果。源码须比 TokenList 存活更久；
+// 含转义的字符串和带下划线分隔的数字改写后存放在 decoded 中（deque 保证地址不变）
+struct TokenList {
+    std::vector<Token> tokens;
+    std::deque<std::string> decoded;
 };
 
 class LAMINA_API Lexer {
 public:
-    static std::vector<Token> tokenize(const std::string& src);
+    static TokenList tokenize(std::string_view src);
+};
+
+// 词法/语法分析的诊断输出：默认为 std::cerr，DiagnosticCapture 存活期间改写到当前线程指定的流，
+// 后台线程解析时因此不会与主线程的输出交错
+LAMINA_API std::ostream& frontend_diagnostics();
+
+class LAMINA_API DiagnosticCapture {
+public:
+    explicit DiagnosticCapture(std::ostream& out);
+    ~DiagnosticCapture();
+    DiagnosticCapture(const DiagnosticCapture&) = delete;
+    DiagnosticCapture& operator=(const DiagnosticCapture&) = delete;
+
+private:
+    std::ostream* previous;
 };
@@ -0,0 +1,582 @@
+#include "module_cache.hpp"
+#include "parser.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& path) {
+#ifdef _WIN32
+    std::ifstream file(path);
+    if (!file) return;
+    std::stringstream stream;
+    stream << file.rdbuf();
+    buffer = stream.str();
+    data = buffer.data();
+    size = buffer.size();
+    opened = true;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        ::close(fd);
+        return;
+    }
+    size = static_cast<size_t>(st.st_size);
+    if (size > 0) {
+        void* p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            ::close(fd);
+            size = 0;
+            return;
+        }
+        data = static_cast<const char*>(p);
+        mapped = true;
+    }
+    ::close(fd);
+    opened = true;
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifndef _WIN32
+    if (mapped) ::munmap(const_cast<char*>(data), size);
+#endif
+}
+
+namespace {
+
+// 文件头：魔数兼作字节序检查，格式变化时递增 version
+constexpr uint32_t cache_magic = 0x434D4C2E;// ".LMC"
+constexpr uint32_t cache_version = 4;
+// 空子节点的标记，NodeKind 不会取到该值
+constexpr uint8_t null_node = 0xFF;
+// 读取时允许的最大嵌套深度，更深的缓存视为损坏，避免递归耗尽栈
+constexpr int max_node_depth = 1000;
+
+uint64_t fnv1a(std::string_view data) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c: data) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// 缓存的键
+struct CacheKey {
+    std::string path;
+    int64_t mtime = 0;
+    uint64_t size = 0;
+    uint64_t hash = 0;
+};
+
+bool make_key(const std::string& path, std::string_view source, CacheKey& key) {
+    std::error_code ec;
+    auto absolute = std::filesystem::absolute(path, ec);
+    if (ec) return false;
+    auto mtime = std::filesystem::last_write_time(path, ec);
+    if (ec) return false;
+    key.path = absolute.lexically_normal().string();
+    key.mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+    key.size = source.size();
+    key.hash = fnv1a(source);
+    return true;
+}
+
+class Writer {
+public:
+    std::string out;
+
+    template<typename T>
+    void put(T v) {
+        out.append(reinterpret_cast<const char*>(&v), sizeof(T));
+    }
+    void str(const std::string& s) {
+        put<uint32_t>(static_cast<uint32_t>(s.size()));
+        out.append(s);
+    }
+    void node(const ASTNode* n);
+
+private:
+    template<typename T>
+    void nodes(const std::vector<std::unique_ptr<T>>& list) {
+        put<uint32_t>(static_cast<uint32_t>(list.size()));
+        for (const auto& n: list) node(n.get());
+    }
+};
+
+void Writer::node(const ASTNode* n) {
+    if (!n) {
+        put<uint8_t>(null_node);
+        return;
+    }
+    put<uint8_t>(static_cast<uint8_t>(n->kind));
+    if (n->kind <= NodeKind::ArrayExpr) {
+        const SourceSpan& span = static_cast<const Expression*>(n)->span;
+        put<uint32_t>(span.offset);
+        put<uint32_t>(span.length);
+        put<uint32_t>(span.line);
+    }
+    switch (n->kind) {
+        case NodeKind::LiteralExpr: {
+            auto* lit = static_cast<const LiteralExpr*>(n);
+            put<uint8_t>(static_cast<uint8_t>(lit->type));
+            str(lit->value);
+            break;
+        }
+        case NodeKind::IdentifierExpr:
+            str(static_cast<const IdentifierExpr*>(n)->name);
+            break;
+        case NodeKind::VarExpr:
+            str(static_cast<const VarExpr*>(n)->name);
+            break;
+        case NodeKind::BinaryExpr: {
+            auto* bin = static_cast<const BinaryExpr*>(n);
+            put<uint8_t>(static_cast<uint8_t>(bin->op));
+            node(bin->left.get());
+            node(bin->right.get());
+            break;
+        }
+        case NodeKind::UnaryExpr: {
+            auto* unary = static_cast<const UnaryExpr*>(n);
+            put<uint8_t>(static_cast<uint8_t>(unary->op));
+            node(unary->operand.get());
+            break;
+        }
+        case NodeKind::CallExpr: {
+            auto* call = static_cast<const CallExpr*>(n);
+            str(call->callee);
+            nodes(call->args);
+            break;
+        }
+        case NodeKind::NamespaceCallExpr: {
+            auto* call = static_cast<const NamespaceCallExpr*>(n);
+            str(call->namespace_name);
+            str(call->function_name);
+            nodes(call->args);
+            break;
+        }
+        case NodeKind::ArrayExpr:
+            nodes(static_cast<const ArrayExpr*>(n)->elements);
+            break;
+        case NodeKind::VarDeclStmt: {
+            auto* v = static_cast<const VarDeclStmt*>(n);
+            str(v->name);
+            node(v->expr.get());
+            break;
+        }
+        case NodeKind::AssignStmt: {
+            auto* a = static_cast<const AssignStmt*>(n);
+            str(a->name);
+            node(a->expr.get());
+            break;
+        }
+        case NodeKind::BlockStmt:
+            nodes(static_cast<const BlockStmt*>(n)->statements);
+            break;
+        case NodeKind::IfStmt: {
+            auto* ifs = static_cast<const IfStmt*>(n);
+            node(ifs->condition.get());
+            node(ifs->thenBlock.get());
+            node(ifs->elseBlock.get());
+            break;
+        }
+        case NodeKind::WhileStmt: {
+            auto* ws = static_cast<const WhileStmt*>(n);
+            node(ws->condition.get());
+            node(ws->body.get());
+            break;
+        }
+        case NodeKind::FuncDefStmt: {
+            auto* func = static_cast<const FuncDefStmt*>(n);
+            str(func->name);
+            put<uint32_t>(static_cast<uint32_t>(func->params.size()));
+            for (const auto& p: func->params) str(p);
+            node(func->body.get());
+            break;
+        }
+        case NodeKind::ReturnStmt:
+            node(static_cast<const ReturnStmt*>(n)->expr.get());
+            break;
+        case NodeKind::IncludeStmt:
+            str(static_cast<const IncludeStmt*>(n)->module);
+            break;
+        case NodeKind::NullStmt:
+        case NodeKind::BreakStmt:
+        case NodeKind::ContinueStmt:
+            break;
+        case NodeKind::ExprStmt:
+            node(static_cast<const ExprStmt*>(n)->expr.get());
+            break;
+        case NodeKind::StructDeclStmt: {
+            auto* s = static_cast<const StructDeclStmt*>(n);
+            str(s->name);
+            put<uint32_t>(static_cast<uint32_t>(s->init_vec.size()));
+            for (const auto& [name, expr]: s->init_vec) {
+                str(name);
+                node(expr.get());
+            }
+            break;
+        }
+        case NodeKind::DefineStmt: {
+            auto* d = static_cast<const DefineStmt*>(n);
+            str(d->name);
+            node(d->value.get());
+            break;
+        }
+        case NodeKind::BigIntDeclStmt: {
+            auto* bi = static_cast<const BigIntDeclStmt*>(n);
+            str(bi->name);
+            node(bi->init_value.get());
+            break;
+        }
+    }
+}
+
+// 读取时逐项检查边界、枚举值、源码区间和嵌套深度，
+// 缓存损坏或截断时抛出 std::runtime_error，由调用方回退到重新解析
+class Reader {
+public:
+    Reader(std::string_view in, uint64_t source_size) : in(in), source_size(source_size) {}
+
+    template<typename T>
+    T get() {
+        need(sizeof(T));
+        T v;
+        std::memcpy(&v, in.data() + pos, sizeof(T));
+        pos += sizeof(T);
+        return v;
+    }
+    std::string str() {
+        const auto n = get<uint32_t>();
+        need(n);
+        std::string s(in.data() + pos, n);
+        pos += n;
+        return s;
+    }
+    // 列表长度：每项至少占一个字节，超出剩余长度即为损坏
+    uint32_t count() {
+        const auto n = get<uint32_t>();
+        need(n);
+        return n;
+    }
+    bool at_end() const { return pos == in.size(); }
+    std::string_view rest() const { return in.substr(pos); }
+
+    std::unique_ptr<ASTNode> node();
+
+    template<typename T>
+    std::unique_ptr<T> node_as() {
+        std::unique_ptr<ASTNode> n = node();
+        if (n && !kind_matches<T>(n->kind)) throw std::runtime_error("unexpected node kind");
+        return std::unique_ptr<T>(static_cast<T*>(n.release()));
+    }
+
+private:
+    std::string_view in;
+    size_t pos = 0;
+    uint64_t source_size;
+    int depth = 0;
+
+    void need(size_t n) const {
+        if (in.size() - pos < n) throw std::runtime_error("truncated module cache");
+    }
+    // 读取一个取值在 [0, last] 内的单字节枚举
+    template<typename E>
+    E get_enum(E last) {
+        const auto v = get<uint8_t>();
+        if (v > static_cast<uint8_t>(last)) throw std::runtime_error("bad enum value in module cache");
+        return static_cast<E>(v);
+    }
+
+    template<typename T>
+    static bool kind_matches(NodeKind kind) {
+        if constexpr (std::is_same_v<T, Expression>) {
+            return kind <= NodeKind::ArrayExpr;
+        } else if constexpr (std::is_same_v<T, Statement>) {
+            return kind > NodeKind::ArrayExpr;
+        } else {
+            static_assert(std::is_same_v<T, BlockStmt>);
+            return kind == NodeKind::BlockStmt;
+        }
+    }
+
+    template<typename T>
+    std::vector<std::unique_ptr<T>> nodes() {
+        const auto n = count();
+        std::vector<std::unique_ptr<T>> list;
+        list.reserve(n);
+        for (uint32_t i = 0; i < n; ++i) list.push_back(node_as<T>());
+        return list;
+    }
+};
+
+std::unique_ptr<ASTNode> Reader::node() {
+    const auto tag = get<uint8_t>();
+    if (tag == null_node) return nullptr;
+    if (tag > static_cast<uint8_t>(NodeKind::BigIntDeclStmt)) throw std::runtime_error("bad node kind");
+    const auto kind = static_cast<NodeKind>(tag);
+    if (depth >= max_node_depth) throw std::runtime_error("module cache nested too deeply");
+    struct DepthGuard {
+        int& depth;
+        explicit DepthGuard(int& d) : depth(d) { ++depth; }
+        ~DepthGuard() { --depth; }
+    } guard(depth);
+
+    SourceSpan span;
+    if (kind <= NodeKind::ArrayExpr) {
+        span.offset = get<uint32_t>();
+        span.length = get<uint32_t>();
+        span.line = get<uint32_t>();
+        if (uint64_t(span.offset) + span.length > source_size) throw std::runtime_error("bad source span in module cache");
+    }
+    std::unique_ptr<ASTNode> result;
+    switch (kind) {
+        case NodeKind::LiteralExpr: {
+            const auto type = get_enum(Value::Type::Symbolic);
+            result = std::make_unique<LiteralExpr>(str(), type);
+            break;
+        }
+        case NodeKind::IdentifierExpr:
+            result = std::make_unique<IdentifierExpr>(str());
+            break;
+        case NodeKind::VarExpr:
+            result = std::make_unique<VarExpr>(str());
+            break;
+        case NodeKind::BinaryExpr: {
+            const auto op = get_enum(BinaryOp::Ge);
+            auto left = node_as<Expression>();
+            auto right = node_as<Expression>();
+            result = std::make_unique<BinaryExpr>(op, std::move(left), std::move(right));
+            break;
+        }
+        case NodeKind::UnaryExpr: {
+            const auto op = get_enum(UnaryOp::Fact);
+            result = std::make_unique<UnaryExpr>(op, node_as<Expression>());
+            break;
+        }
+        case NodeKind::CallExpr: {
+            std::string callee = str();
+            result = std::make_unique<CallExpr>(callee, nodes<Expression>());
+            break;
+        }
+        case NodeKind::NamespaceCallExpr: {
+            std::string ns = str();
+            std::string fn = str();
+            result = std::make_unique<NamespaceCallExpr>(ns, fn, nodes<Expression>());
+            break;
+        }
+        case NodeKind::ArrayExpr:
+            result = std::make_unique<ArrayExpr>(nodes<Expression>());
+            break;
+        case NodeKind::VarDeclStmt: {
+            std::string name = str();
+            result = std::make_unique<VarDeclStmt>(name, node_as<Expression>());
+            break;
+        }
+        case NodeKind::AssignStmt: {
+            std::string name = str();
+            result = std::make_unique<AssignStmt>(name, node_as<Expression>());
+            break;
+        }
+        case NodeKind::BlockStmt: {
+            auto block = std::make_unique<BlockStmt>();
+            block->statements = nodes<Statement>();
+            result = std::move(block);
+            break;
+        }
+        case NodeKind::IfStmt: {
+            auto condition = node_as<Expression>();
+            auto then_block = node_as<BlockStmt>();
+            auto else_block = node_as<BlockStmt>();
+            result = std::make_unique<IfStmt>(std::move(condition), std::move(then_block), std::move(else_block));
+            break;
+        }
+        case NodeKind::WhileStmt: {
+            auto condition = node_as<Expression>();
+            result = std::make_unique<WhileStmt>(std::move(condition), node_as<BlockStmt>());
+            break;
+        }
+        case NodeKind::FuncDefStmt: {
+            std::string name = str();
+            std::vector<std::string> params(count());
+            for (auto& p: params) p = str();
+            result = std::make_unique<FuncDefStmt>(name, params, node_as<BlockStmt>());
+            break;
+        }
+        case NodeKind::ReturnStmt:
+            result = std::make_unique<ReturnStmt>(node_as<Expression>());
+            break;
+        case NodeKind::IncludeStmt:
+            result = std::make_unique<IncludeStmt>(str());
+            break;
+        case NodeKind::NullStmt:
+            result = std::make_unique<NullStmt>();
+            break;
+        case NodeKind::BreakStmt:
+            result = std::make_unique<BreakStmt>();
+            break;
+        case NodeKind::ContinueStmt:
+            result = std::make_unique<ContinueStmt>();
+            break;
+        case NodeKind::ExprStmt:
+            result = std::make_unique<ExprStmt>(node_as<Expression>());
+            break;
+        case NodeKind::StructDeclStmt: {
+            std::string name = str();
+            const auto n = count();
+            std::vector<std::pair<std::string, std::unique_ptr<Expression>>> init_vec;
+            for (uint32_t i = 0; i < n; ++i) {
+                std::string field = str();
+                init_vec.emplace_back(field, node_as<Expression>());
+            }
+            result = std::make_unique<StructDeclStmt>(name, std::move(init_vec));
+            break;
+        }
+        case NodeKind::DefineStmt: {
+            std::string name = str();
+            result = std::make_unique<DefineStmt>(name, node_as<Expression>());
+            break;
+        }
+        case NodeKind::BigIntDeclStmt: {
+            std::string name = str();
+            result = std::make_unique<BigIntDeclStmt>(name, node_as<Expression>());
+            break;
+        }
+    }
+    if (kind <= NodeKind::ArrayExpr) static_cast<Expression*>(result.get())->span = span;
+    return result;
+}
+
+void write_header(Writer& w, const CacheKey& key) {
+    w.put<uint32_t>(cache_magic);
+    w.put<uint32_t>(cache_version);
+    w.put<int64_t>(key.mtime);
+    w.put<uint64_t>(key.size);
+    w.put<uint64_t>(key.hash);
+    w.str(key.path);
+}
+
+std::unique_ptr<ASTNode> load_cache(const std::string& file, const CacheKey& key) {
+    MappedFile cache(file);
+    if (!cache) return nullptr;
+    try {
+        Reader r(cache.view(), key.size);
+        if (r.get<uint32_t>() != cache_magic || r.get<uint32_t>() != cache_version) return nullptr;
+        if (r.get<int64_t>() != key.mtime || r.get<uint64_t>() != key.size || r.get<uint64_t>() != key.hash) return nullptr;
+        if (r.str() != key.path) return nullptr;
+        // 节点数据的哈希：文件被截断或改写时直接回退，不去解码错误的数据
+        if (r.get<uint64_t>() != fnv1a(r.rest())) return nullptr;
+        auto ast = r.node();
+        if (!ast || !r.at_end()) return nullptr;
+        return ast;
+    } catch (const std::exception&) {
+        return nullptr;
+    }
+}
+
+void store_cache(const std::string& file, const CacheKey& key, const ASTNode* ast) {
+    Writer body;
+    body.node(ast);
+    Writer w;
+    write_header(w, key);
+    w.put<uint64_t>(fnv1a(body.out));
+    w.out += body.out;
+    // 先写临时文件再改名，并发运行的进程不会读到写了一半的缓存；
+    // 临时文件名带上线程号，同一进程内的预解析线程之间也互不覆盖
+#ifdef _WIN32
+    std::string tmp = file + ".tmp" + std::to_string(GetCurrentProcessId());
+#else
+    std::string tmp = file + ".tmp" + std::to_string(::getpid());
+#endif
+    tmp += "." + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) return;
+        out.write(w.out.data(), static_cast<std::streamsize>(w.out.size()));
+        if (!out) {
+            out.close();
+            std::error_code ec;
+            std::filesystem::remove(tmp, ec);
+            return;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, file, ec);
+    if (ec) std::filesystem::remove(tmp, ec);
+}
+
+}// namespace
+
+std::string ModuleCache::cache_path(const std::string& path) {
+    std::filesystem::path p(path);
+    if (p.extension() == ".lm") return p.replace_extension(".lmc").string();
+    return path + ".lmc";
+}
+
+bool ModuleCache::enabled() {
+    static const bool on = std::getenv("LAMINA_NO_CACHE") == nullptr;
+    return on;
+}
+
+SyntaxTree ModuleCache::parse(const std::string& path, std::shared_ptr<const MappedFile> file, std::string* diagnostics) {
+    const std::string_view source = file->view();
+    CacheKey key;
+    const bool use_cache = enabled() && make_key(path, source, key);
+    const std::string cache_file = use_cache ? cache_path(path) : std::string();
+    if (use_cache) {
+        SyntaxTree tree;
+        tree.arena = std::make_unique<AstArena>();
+        {
+            AstArena::Scope scope(*tree.arena);
+            tree.root = load_cache(cache_file, key);
+        }
+        if (tree.root) {
+            tree.source = source;
+            tree.source_owner = std::move(file);
+            return tree;
+        }
+    }
+
+    // 暂存前端的诊断输出：有输出的源码不写缓存，否则命中缓存时这些信息会丢失
+    std::ostringstream captured;
+    auto emit = [&](const std::string& text) {
+        if (diagnostics) {
+            *diagnostics += text;
+        } else {
+            std::cerr << text;
+        }
+    };
+    SyntaxTree tree;
+    try {
+        DiagnosticCapture capture(captured);
+        tree = Parser::parse_tree(std::move(file), source);
+    } catch (...) {
+        emit(captured.str());
+        throw;
+    }
+    const std::string printed = captured.str();
+    emit(printed);
+
+    if (use_cache && tree.root && printed.empty()) store_cache(cache_file, key, tree.root.get());
+    return tree;
+}
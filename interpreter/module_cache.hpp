@@ -0,0 +1,56 @@
+#pragma once
+#include "ast.hpp"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#ifdef _WIN32
+#ifdef LAMINA_CORE_EXPORTS
+#define LAMINA_API __declspec(dllexport)
+#else
+#define LAMINA_API __declspec(dllimport)
+#endif
+#else
+#define LAMINA_API
+#endif
+
+/*
+    脚本的解析缓存：Parser::parse 的结果序列化到源文件旁的 .lmc 文件（foo.lm -> foo.lmc）。
+    缓存以源文件的绝对路径、修改时间、大小和内容哈希为键，任一不符即重新解析并覆盖；
+    命中时只做内存映射和反序列化，不再词法分析和语法分析。
+    缓存保存 Resolver 之前的 AST，表达式只记录源码区间，格式与机器相关，只在本机复用
+ */
+
+// 只读映射整个文件；Windows 下退化为一次性读入
+class LAMINA_API MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    explicit operator bool() const { return opened; }
+    std::string_view view() const { return {data, size}; }
+
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+    bool opened = false;
+    bool mapped = false;
+#ifdef _WIN32
+    std::string buffer;
+#endif
+};
+
+class LAMINA_API ModuleCache {
+public:
+    // 解析 path 处已映射的源码，优先使用有效的 .lmc 缓存；语法错误时 root 为空。
+    // 词法/语法分析没有输出任何诊断信息时才写缓存，命中缓存与重新解析的输出因此一致。
+    // diagnostics 非空时诊断信息追加到其中，由调用方在合适的时机打印
+    static SyntaxTree parse(const std::string& path, std::shared_ptr<const MappedFile> file, std::string* diagnostics = nullptr);
+    // 源文件对应的缓存文件路径
+    static std::string cache_path(const std::string& path);
+    // 设置环境变量 LAMINA_NO_CACHE 时既不读也不写缓存
+    static bool enabled();
+};
@@ -20,7 +20,7 @@ LaminaValue ModuleLoader::valueToLamina(const Value& val) {
     if (val.type == Value::Type::Null) {
         result = LAMINA_MAKE_NULL();
     } else if (val.type == Value::Type::Int) {
-        result = LAMINA_MAKE_INT(std::get<int>(val.data));
+        result = LAMINA_MAKE_INT(val.get<int>());
     } else if (val.type == Value::Type::Float) {
         result = LAMINA_MAKE_INT(static_cast<int>(val.as_number()));
     } else if (val.type == Value::Type::String) {
@@ -0,0 +1,175 @@
+// macOS 只在定义 _XOPEN_SOURCE 时声明 ucontext 接口
+#if defined(__APPLE__) && !defined(_XOPEN_SOURCE)
+#define _XOPEN_SOURCE 700
+#endif
+#include "native_stack.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#define LAMINA_STACK_FIBER
+#elif defined(__GLIBC__) || defined(__APPLE__) || defined(__FreeBSD__)
+#include <ucontext.h>
+#define LAMINA_STACK_UCONTEXT
+#endif
+
+#if defined(LAMINA_STACK_UCONTEXT) && defined(__clang__)
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+namespace {
+
+// 每个栈段的大小，以及切换前至少保留的余量（留给两次检查之间的调用和内置函数）
+constexpr size_t segment_size = size_t(1) << 20;
+constexpr size_t headroom = size_t(256) << 10;
+// 线程自己的栈上允许使用的字节数，从第一次检查的位置算起
+constexpr size_t thread_stack_budget = size_t(256) << 10;
+// 最多缓存的空闲栈段个数，其余用完即释放
+constexpr size_t max_pooled_segments = 8;
+
+// 当前栈段的下限：栈向低地址增长，越过它即视为余量不足；0 表示尚未初始化
+thread_local uintptr_t limit = 0;
+
+uintptr_t stack_position() {
+    char marker;
+    return reinterpret_cast<uintptr_t>(&marker);
+}
+
+// 切换到新栈段执行的任务，异常留在任务中，回到原栈后再抛出
+struct Task {
+    const std::function<void()>* fn = nullptr;
+    std::exception_ptr error;
+#ifdef LAMINA_STACK_FIBER
+    LPVOID caller = nullptr;
+#endif
+};
+
+thread_local Task* current_task = nullptr;
+
+void run_task(Task* task) {
+    try {
+        (*task->fn)();
+    } catch (...) {
+        task->error = std::current_exception();
+    }
+}
+
+#ifdef LAMINA_STACK_FIBER
+
+// Fiber 自带栈，复用时直接切换进去执行下一个任务
+struct Segment {
+    LPVOID fiber = nullptr;
+    ~Segment() {
+        if (fiber) DeleteFiber(fiber);
+    }
+};
+
+VOID CALLBACK segment_entry(LPVOID) {
+    while (true) {
+        limit = stack_position() - (segment_size - headroom);
+        Task* task = current_task;
+        run_task(task);
+        SwitchToFiber(task->caller);
+    }
+}
+
+#elif defined(LAMINA_STACK_UCONTEXT)
+
+struct Segment {
+    std::unique_ptr<char[]> memory{new char[segment_size]};
+};
+
+// 执行完毕后经 uc_link 回到调用方
+void segment_entry() {
+    run_task(current_task);
+}
+
+#else
+
+struct Segment {};
+
+#endif
+
+struct SegmentPool {
+    std::vector<std::unique_ptr<Segment>> free;
+
+    std::unique_ptr<Segment> take() {
+        if (free.empty()) return std::make_unique<Segment>();
+        std::unique_ptr<Segment> segment = std::move(free.back());
+        free.pop_back();
+        return segment;
+    }
+    void give(std::unique_ptr<Segment> segment) {
+        if (free.size() < max_pooled_segments) free.push_back(std::move(segment));
+    }
+};
+
+thread_local SegmentPool pool;
+
+}// namespace
+
+namespace native_stack {
+
+bool exhausted() {
+    const uintptr_t here = stack_position();
+    if (limit == 0) limit = here - thread_stack_budget;
+    return here < limit;
+}
+
+bool segments_supported() {
+#if defined(LAMINA_STACK_FIBER) || defined(LAMINA_STACK_UCONTEXT)
+    return true;
+#else
+    return false;
+#endif
+}
+
+void run_on_new_segment(const std::function<void()>& fn) {
+#if defined(LAMINA_STACK_FIBER) || defined(LAMINA_STACK_UCONTEXT)
+    Task task;
+    task.fn = &fn;
+    std::unique_ptr<Segment> segment = pool.take();
+    const uintptr_t saved_limit = limit;
+    Task* const saved_task = current_task;
+
+#ifdef LAMINA_STACK_FIBER
+    // 切换 Fiber 前当前线程自身也必须是 Fiber
+    static thread_local LPVOID thread_fiber = nullptr;
+    if (!thread_fiber) thread_fiber = IsThreadAFiber() ? GetCurrentFiber() : ConvertThreadToFiber(nullptr);
+    if (!thread_fiber) throw std::runtime_error("Cannot switch native stack");
+    if (!segment->fiber) {
+        segment->fiber = CreateFiberEx(0, segment_size, FIBER_FLAG_FLOAT_SWITCH, segment_entry, nullptr);
+        if (!segment->fiber) throw std::runtime_error("Cannot allocate native stack segment");
+    }
+    task.caller = GetCurrentFiber();
+    current_task = &task;
+    SwitchToFiber(segment->fiber);
+#else
+    ucontext_t caller;
+    ucontext_t context;
+    getcontext(&context);
+    context.uc_stack.ss_sp = segment->memory.get();
+    context.uc_stack.ss_size = segment_size;
+    context.uc_link = &caller;
+    makecontext(&context, segment_entry, 0);
+    current_task = &task;
+    limit = reinterpret_cast<uintptr_t>(segment->memory.get()) + headroom;
+    swapcontext(&caller, &context);
+#endif
+
+    current_task = saved_task;
+    limit = saved_limit;
+    pool.give(std::move(segment));
+    if (task.error) std::rethrow_exception(task.error);
+#else
+    fn();
+#endif
+}
+
+}// namespace native_stack
@@ -0,0 +1,30 @@
+#pragma once
+#include <functional>
+
+#ifdef _WIN32
+#ifdef LAMINA_CORE_EXPORTS
+#define LAMINA_API __declspec(dllexport)
+#else
+#define LAMINA_API __declspec(dllimport)
+#endif
+#else
+#define LAMINA_API
+#endif
+
+/*
+    原生栈分段：树遍历解释器和闭包层的 Lamina 调用按原生递归执行，
+    当前栈段余量不足时，后续调用切换到堆上分配的新栈段继续执行，
+    递归深度因此不受原生栈大小限制，只受 Interpreter::max_recursion_depth（10^5）限制；
+    栈段的内存随深度线性增长，10^6 层的递归应使用 --engine=vm。
+    POSIX 使用 ucontext，Windows 使用 Fiber；其他平台不能切换，余量不足时由调用方报告递归过深
+ */
+namespace native_stack {
+
+// 当前线程所在栈段的余量是否已不足
+LAMINA_API bool exhausted();
+// 当前平台能否切换栈段
+LAMINA_API bool segments_supported();
+// 在新的栈段上执行 fn，返回后回到原栈；fn 抛出的异常在原栈上重新抛出
+LAMINA_API void run_on_new_segment(const std::function<void()>& fn);
+
+}// namespace native_stack
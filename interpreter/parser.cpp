@@ -7,22 +7,41 @@
 
 // Debug output macro - no output if DEBUG is false
 #define DEBUG_OUT \
-    if (false) std::cerr
+    if (false) frontend_diagnostics()
+
+// 运算符 token 到 BinaryOp 的映射，仅用于 parse_comparison ... parse_power 已确认过的 token
+static BinaryOp binary_op_from_token(TokenType type) {
+    switch (type) {
+        case TokenType::Plus: return BinaryOp::Add;
+        case TokenType::Minus: return BinaryOp::Sub;
+        case TokenType::Star: return BinaryOp::Mul;
+        case TokenType::Slash: return BinaryOp::Div;
+        case TokenType::Percent: return BinaryOp::Mod;
+        case TokenType::Caret: return BinaryOp::Pow;
+        case TokenType::Equal: return BinaryOp::Eq;
+        case TokenType::NotEqual: return BinaryOp::Ne;
+        case TokenType::Less: return BinaryOp::Lt;
+        case TokenType::LessEqual: return BinaryOp::Le;
+        case TokenType::Greater: return BinaryOp::Gt;
+        case TokenType::GreaterEqual:
+        default: return BinaryOp::Ge;
+    }
+}
 
 std::unique_ptr<Expression> Parser::parse_expression(const std::vector<Token>& tokens, size_t& i) {
     // Safety check
     if (i >= tokens.size() || tokens[i].type == TokenType::EndOfFile) {
-        std::cerr << "Error: Attempting to parse expression at end of input" << std::endl;
+        frontend_diagnostics() << "Error: Attempting to parse expression at end of input" << std::endl;
         return nullptr;
     }
 
     size_t expr_start = i;
     auto expr = parse_comparison(tokens, i);
     size_t expr_end = i;
-    if (expr) {
-        std::string src;
-        for (size_t j = expr_start; j < expr_end; ++j) src += tokens[j].text;
-        expr->source = src;
+    if (expr && expr_end > expr_start) {
+        const Token& first = tokens[expr_start];
+        const Token& last = tokens[expr_end - 1];
+        expr->span = {first.offset, last.offset + last.length - first.offset, first.line};
     }
     return expr;
 }
@@ -32,7 +51,7 @@ std::unique_ptr<Expression> Parser::parse_comparison(const std::vector<Token>& t
     while (i < tokens.size() && (tokens[i].type == TokenType::Equal || tokens[i].type == TokenType::NotEqual ||
                                  tokens[i].type == TokenType::Less || tokens[i].type == TokenType::LessEqual ||
                                  tokens[i].type == TokenType::Greater || tokens[i].type == TokenType::GreaterEqual)) {
-        std::string op = tokens[i].text;
+        BinaryOp op = binary_op_from_token(tokens[i].type);
         ++i;
         auto right = parse_addition(tokens, i);
         left = std::make_unique<BinaryExpr>(op, std::move(left), std::move(right));
@@ -43,7 +62,7 @@ std::unique_ptr<Expression> Parser::parse_comparison(const std::vector<Token>& t
 std::unique_ptr<Expression> Parser::parse_addition(const std::vector<Token>& tokens, size_t& i) {
     auto left = parse_term(tokens, i);
     while (i < tokens.size() && (tokens[i].type == TokenType::Plus || tokens[i].type == TokenType::Minus)) {
-        std::string op = tokens[i].text;
+        BinaryOp op = binary_op_from_token(tokens[i].type);
         ++i;
         auto right = parse_term(tokens, i);
         left = std::make_unique<BinaryExpr>(op, std::move(left), std::move(right));
@@ -55,7 +74,7 @@ std::unique_ptr<Expression> Parser::parse_term(const std::vector<Token>& tokens,
     auto left = parse_power(tokens, i);
     while (i < tokens.size() && (tokens[i].type == TokenType::Star || tokens[i].type == TokenType::Slash ||
                                  tokens[i].type == TokenType::Percent)) {
-        std::string op = tokens[i].text;
+        BinaryOp op = binary_op_from_token(tokens[i].type);
         ++i;
         auto right = parse_power(tokens, i);
         left = std::make_unique<BinaryExpr>(op, std::move(left), std::move(right));
@@ -66,7 +85,7 @@ std::unique_ptr<Expression> Parser::parse_term(const std::vector<Token>& tokens,
 std::unique_ptr<Expression> Parser::parse_power(const std::vector<Token>& tokens, size_t& i) {
     auto left = parse_unary(tokens, i);
     while (i < tokens.size() && tokens[i].type == TokenType::Caret) {
-        std::string op = tokens[i].text;
+        BinaryOp op = binary_op_from_token(tokens[i].type);
         ++i;
         auto right = parse_unary(tokens, i);
         left = std::make_unique<BinaryExpr>(op, std::move(left), std::move(right));
@@ -81,7 +100,7 @@ std::unique_ptr<Expression> Parser::parse_unary(const std::vector<Token>& tokens
     if (tokens[i].type == TokenType::Minus) {
         ++i;
         auto operand = parse_unary(tokens, i);
-        return std::make_unique<UnaryExpr>("-", std::move(operand));
+        return std::make_unique<UnaryExpr>(UnaryOp::Neg, std::move(operand));
     }
 
     // Parse primary expression first
@@ -90,7 +109,7 @@ std::unique_ptr<Expression> Parser::parse_unary(const std::vector<Token>& tokens
     // Handle postfix unary operators (like factorial)
     while (i < tokens.size() && tokens[i].type == TokenType::Bang) {
         ++i;// consume '!'
-        expr = std::make_unique<UnaryExpr>("!", std::move(expr));
+        expr = std::make_unique<UnaryExpr>(UnaryOp::Fact, std::move(expr));
     }
 
     return expr;
@@ -102,9 +121,9 @@ std::unique_ptr<Expression> Parser::parse_primary(const std::vector<Token>& toke
     DEBUG_OUT << "Debug - parse_primary: token[" << i << "] = '" << tokens[i].text
               << "' (type=" << static_cast<int>(tokens[i].type) << ")" << std::endl;
     if (tokens[i].type == TokenType::Number) {
-        return std::make_unique<LiteralExpr>(tokens[i++].text, Value::Type::Int);
+        return std::make_unique<LiteralExpr>(std::string(tokens[i++].text), Value::Type::Int);
     } else if (tokens[i].type == TokenType::String) {
-        return std::make_unique<LiteralExpr>(tokens[i++].text, Value::Type::String);
+        return std::make_unique<LiteralExpr>(std::string(tokens[i++].text), Value::Type::String);
     } else if (tokens[i].type == TokenType::True) {
         i++;
         return std::make_unique<LiteralExpr>("true", Value::Type::Bool);
@@ -126,20 +145,21 @@ std::unique_ptr<Expression> Parser::parse_primary(const std::vector<Token>& toke
             if (tokens[i].type == TokenType::Comma) {
                 ++i;// Skip ','
             } else if (tokens[i].type != TokenType::RBracket) {
-                std::cerr << "Error: Expected ',' or ']' in array literal" << std::endl;
+                frontend_diagnostics() << "Error: Expected ',' or ']' in array literal" << std::endl;
                 return nullptr;
             }
         }
 
         if (i >= tokens.size() || tokens[i].type != TokenType::RBracket) {
-            std::cerr << "Error: Unterminated array literal, expected ']'" << std::endl;
+            frontend_diagnostics() << "Error: Unterminated array literal, expected ']'" << std::endl;
             return nullptr;
         }
 
         ++i;// Skip ']'
         return std::make_unique<ArrayExpr>(std::move(elements));
     } else if (tokens[i].type == TokenType::Identifier) {
-        std::string name = tokens[i].text;
+        const size_t name_start = i;
+        std::string name(tokens[i].text);
         // std::cerr << "DEBUG: Found identifier '" << name << "' at token " << i << std::endl;
         ++i;
 
@@ -149,11 +169,11 @@ std::unique_ptr<Expression> Parser::parse_primary(const std::vector<Token>& toke
             ++i;// Skip '.'
             if (i < tokens.size() && tokens[i].type == TokenType::Identifier) {
                 //     std::cerr << "DEBUG: Found second identifier '" << tokens[i].text << "' at token " << i << std::endl;
-                name += "." + tokens[i].text;// 保持点格式
+                name.append(".").append(tokens[i].text);// 保持点格式
                 ++i;
                 //   std::cerr << "DEBUG: Converted to namespace syntax: '" << name << "'" << std::endl;
             } else {
-                std::cerr << "Error: Expected identifier after '.'" << std::endl;
+                frontend_diagnostics() << "Error: Expected identifier after '.'" << std::endl;
                 return nullptr;
             }
         } else {
@@ -172,18 +192,23 @@ std::unique_ptr<Expression> Parser::parse_primary(const std::vector<Token>& toke
                 if (tokens[i].type == TokenType::Comma) {
                     ++i;// Skip ','
                 } else if (tokens[i].type != TokenType::RParen) {
-                    std::cerr << "Error: Expected ',' or ')' in function call" << std::endl;
+                    frontend_diagnostics() << "Error: Expected ',' or ')' in function call" << std::endl;
                     return nullptr;
                 }
             }
 
             if (i >= tokens.size() || tokens[i].type != TokenType::RParen) {
-                std::cerr << "Error: Unterminated function call, expected ')'" << std::endl;
+                frontend_diagnostics() << "Error: Unterminated function call, expected ')'" << std::endl;
                 return nullptr;
             }
 
             ++i;// Skip ')'
-            return std::make_unique<CallExpr>(name, std::move(args));
+            auto call = std::make_unique<CallExpr>(name, std::move(args));
+            // 嵌套在其他表达式中的调用也记录位置，调用栈回溯按它给出行号
+            const Token& first = tokens[name_start];
+            const Token& last = tokens[i - 1];
+            call->span = {first.offset, last.offset + last.length - first.offset, first.line};
+            return call;
         }
         // 否则作为普通变量处理
         return std::make_unique<VarExpr>(name);
@@ -192,7 +217,7 @@ std::unique_ptr<Expression> Parser::parse_primary(const std::vector<Token>& toke
         auto expr = parse_expression(tokens, i);
 
         if (i >= tokens.size() || tokens[i].type != TokenType::RParen) {
-            std::cerr << "Error: Unterminated parenthesized expression, expected ')'" << std::endl;
+            frontend_diagnostics() << "Error: Unterminated parenthesized expression, expected ')'" << std::endl;
             return nullptr;
         }
 
@@ -200,31 +225,31 @@ std::unique_ptr<Expression> Parser::parse_primary(const std::vector<Token>& toke
         return expr;
     }
 
-    std::cerr << "Error: Unexpected token in expression: " << tokens[i].text << std::endl;
+    frontend_diagnostics() << "Error: Unexpected token in expression: " << tokens[i].text << std::endl;
     return nullptr;
 }
 
 // Helper function: print token context for error reporting
 static void print_context(const std::vector<Token>& tokens, size_t pos, int context_size = 5) {
-    std::cerr << "Context:" << std::endl;
+    frontend_diagnostics() << "Context:" << std::endl;
     std::string context;
     for (const auto& t: tokens) {
-        context += t.text + " ";
+        context.append(t.text).append(" ");
     }
 
-    std::cerr << context << "" << std::endl;
+    frontend_diagnostics() << context << "" << std::endl;
 
     for (size_t i = 0; i < context.size(); ++i) {
-        if (i == tokens[pos].column) std::cerr << "^";
+        if (i == tokens[pos].column) frontend_diagnostics() << "^";
         else
-            std::cerr << "~";
+            frontend_diagnostics() << "~";
     }
-    std::cerr << std::endl;
+    frontend_diagnostics() << std::endl;
 
     // Print line and column position indicators
-    std::cerr << "Position: ";
-    std::cerr << "\033[36m line " << tokens[pos].line << " | " << "col " << tokens[pos].column << "\033[0m ";
-    std::cerr << std::endl;
+    frontend_diagnostics() << "Position: ";
+    frontend_diagnostics() << "\033[36m line " << tokens[pos].line << " | " << "col " << tokens[pos].column << "\033[0m ";
+    frontend_diagnostics() << std::endl;
 }
 
 std::unique_ptr<BlockStmt> Parser::parse_block(const std::vector<Token>& tokens, size_t& i, bool is_global) {
@@ -242,7 +267,7 @@ std::unique_ptr<BlockStmt> Parser::parse_block(const std::vector<Token>& tokens,
               << (is_global ? "global" : "local")
               << ", depth=" << current_block_depth
               << ", position=" << start_line << ":" << start_col
-              << ", current token=" << (i < tokens.size() ? "'" + tokens[i].text + "'" : "EOF")
+              << ", current token=" << (i < tokens.size() ? "'" + std::string(tokens[i].text) + "'" : "EOF")
               << std::endl;
 
     // Record start token position for error reporting
@@ -265,25 +290,25 @@ std::unique_ptr<BlockStmt> Parser::parse_block(const std::vector<Token>& tokens,
         if (tokens[i].type == TokenType::EndOfFile) {
             if (!is_global) {
                 // Local block ended unexpectedly at EOF, provide detailed error info
-                std::cerr << "\033[31mError: Missing closing brace '}' - block started at line " << start_line
+                frontend_diagnostics() << "\033[31mError: Missing closing brace '}' - block started at line " << start_line
                           << " col " << start_col
                           << ", not closed before end of file\033[0m" << std::endl;
 
                 // Output context around the block start to help locate the issue
-                std::cerr << "Block start context:" << std::endl;
+                frontend_diagnostics() << "Block start context:" << std::endl;
                 size_t context_start = block_start_index > 5 ? block_start_index - 5 : 0;
                 size_t context_end = std::min(block_start_index + 5, tokens.size() - 1);
                 for (size_t j = context_start; j <= context_end; j++) {
                     if (j == block_start_index) {
-                        std::cerr << "[" << tokens[j].text << "] ";
+                        frontend_diagnostics() << "[" << tokens[j].text << "] ";
                     } else {
-                        std::cerr << tokens[j].text << " ";
+                        frontend_diagnostics() << tokens[j].text << " ";
                     }
                 }
-                std::cerr << std::endl;
+                frontend_diagnostics() << std::endl;
 
                 // Show block content summary
-                std::cerr << "Block contains " << block->statements.size() << " statements" << std::endl;
+                frontend_diagnostics() << "Block contains " << block->statements.size() << " statements" << std::endl;
 
                 current_block_depth--;
                 // Throw exception instead of direct exit, let caller recover
@@ -303,7 +328,7 @@ std::unique_ptr<BlockStmt> Parser::parse_block(const std::vector<Token>& tokens,
             block->statements.push_back(std::move(stmt));
         } else if (i < tokens.size() && tokens[i].type != TokenType::EndOfFile) {
             // Only report error if not at end of file and parsing failed
-            std::cerr << "\033[31mError: Invalid or unexpected statement at token " << i
+            frontend_diagnostics() << "\033[31mError: Invalid or unexpected statement at token " << i
                       << " (line " << tokens[i].line
                       << " col " << tokens[i].column
                       << "): "
@@ -315,7 +340,7 @@ std::unique_ptr<BlockStmt> Parser::parse_block(const std::vector<Token>& tokens,
         } else {
             // Reached end of file, should be global block at this point
             if (!is_global) {
-                std::cerr << "\033[31mError: Unexpected end of file, missing block closure, started at line " << start_line << "\033[0m" << std::endl;
+                frontend_diagnostics() << "\033[31mError: Unexpected end of file, missing block closure, started at line " << start_line << "\033[0m" << std::endl;
                 current_block_depth--;
                 throw std::runtime_error("Parse error: Unclosed block, missing closing brace");
             }
@@ -325,7 +350,7 @@ std::unique_ptr<BlockStmt> Parser::parse_block(const std::vector<Token>& tokens,
         // Check progress to avoid infinite loops
         if (i >= tokens.size()) {
             if (!is_global) {
-                std::cerr << "\033[31mError: Unexpected end of file, missing block closure, started at line " << start_line << "\033[0m" << std::endl;
+                frontend_diagnostics() << "\033[31mError: Unexpected end of file, missing block closure, started at line " << start_line << "\033[0m" << std::endl;
                 current_block_depth--;
                 throw std::runtime_error("Parse error: Unclosed block, missing closing brace");
             }
@@ -359,16 +384,16 @@ std::unique_ptr<StructDeclStmt> Parser::parse_struct(const std::vector<Token>& t
 
     ++i;// Skip 'struct'
     if (i >= tokens.size()) {
-        std::cerr << "\033[31mError: struct statement ended unexpectedly, missing the name\033[0m" << std::endl;
+        frontend_diagnostics() << "\033[31mError: struct statement ended unexpectedly, missing the name\033[0m" << std::endl;
         print_context(tokens, struct_start_index);
         return nullptr;
     }
 
-    const auto& struct_name = tokens[i].text;
+    const std::string struct_name(tokens[i].text);
     std::vector<std::pair<std::string, std::unique_ptr<Expression>>> init_vec;
     ++i;
     if (i >= tokens.size()) {
-        std::cerr << "\033[31mError: struct statement ended unexpectedly, missing the body\033[0m" << std::endl;
+        frontend_diagnostics() << "\033[31mError: struct statement ended unexpectedly, missing the body\033[0m" << std::endl;
         print_context(tokens, struct_start_index);
         return nullptr;
     }
@@ -376,7 +401,7 @@ std::unique_ptr<StructDeclStmt> Parser::parse_struct(const std::vector<Token>& t
     if (tokens[i].type == TokenType::LBrace) {
         ++i;// Consume opening brace
     } else {
-        std::cerr << "\033[31mError: struct statement missing opening brace '{'\033[0m" << std::endl;
+        frontend_diagnostics() << "\033[31mError: struct statement missing opening brace '{'\033[0m" << std::endl;
         print_context(tokens, i);
     }
 
@@ -386,15 +411,15 @@ std::unique_ptr<StructDeclStmt> Parser::parse_struct(const std::vector<Token>& t
     while (i < tokens.size() &&
            tokens[i].type != TokenType::RBrace) {
         if (!(i < tokens.size() && tokens[i].type == TokenType::Identifier)) {
-            std::cerr << "\033[31mError: struct statement missing the sub name instead of '" << tokens[i].text << "'\033[0m" << std::endl;
+            frontend_diagnostics() << "\033[31mError: struct statement missing the sub name instead of '" << tokens[i].text << "'\033[0m" << std::endl;
             print_context(tokens, i);
             return nullptr;
         };
-        std::string sub_name = tokens[i].text;
+        std::string sub_name(tokens[i].text);
         ++i;
 
         if (!(i < tokens.size() && tokens[i].type == TokenType::Assign)) {
-            std::cerr << "\033[31mError: struct member missing '=' after identifier '" << sub_name << "' (line " << tokens[i].line << ")\033[0m" << std::endl;
+            frontend_diagnostics() << "\033[31mError: struct member missing '=' after identifier '" << sub_name << "' (line " << tokens[i].line << ")\033[0m" << std::endl;
             print_context(tokens, i);
             return nullptr;
         }
@@ -403,14 +428,14 @@ std::unique_ptr<StructDeclStmt> Parser::parse_struct(const std::vector<Token>& t
         std::unique_ptr<Expression> sub_expr = parse_expression(tokens, i);
         while (i < tokens.size() && tokens[i].type != TokenType::Semicolon) ++i;
         if (i >= tokens.size() || tokens[i].type != TokenType::Semicolon) {
-            std::cerr << "\033[31mError: struct sub item need ends with ';' (line " << tokens[i - 1].line << ")\033[0m" << std::endl;
+            frontend_diagnostics() << "\033[31mError: struct sub item need ends with ';' (line " << tokens[i - 1].line << ")\033[0m" << std::endl;
             print_context(tokens, i);
             return nullptr;
         }
         ++i;
 
         if (!sub_expr) {
-            std::cerr << "\033[31mError: struct sub item need init val" << std::endl;
+            frontend_diagnostics() << "\033[31mError: struct sub item need init val" << std::endl;
             print_context(tokens, i);
             return nullptr;
         }
@@ -419,7 +444,7 @@ std::unique_ptr<StructDeclStmt> Parser::parse_struct(const std::vector<Token>& t
     }
 
     if (i >= tokens.size() || tokens[i].type != TokenType::RBrace) {
-        std::cerr << "\033[31mError: struct body missing closing brace '}' (line " << tokens[i - 1].line << ")\033[0m" << std::endl;
+        frontend_diagnostics() << "\033[31mError: struct body missing closing brace '}' (line " << tokens[i - 1].line << ")\033[0m" << std::endl;
         print_context(tokens, i);
         return nullptr;
     }
@@ -446,7 +471,7 @@ std::unique_ptr<Statement> Parser::parse_while(const std::vector<Token>& tokens,
 
     // Check for opening parenthesis
     if (i >= tokens.size() || tokens[i].type != TokenType::LParen) {
-        std::cerr << "\033[31mError: Missing opening parenthesis '(' after while statement\033[0m" << std::endl;
+        frontend_diagnostics() << "\033[31mError: Missing opening parenthesis '(' after while statement\033[0m" << std::endl;
         print_context(tokens, i > 0 ? i - 1 : 0);
 
         // Try to recover: look for opening parenthesis or opening brace
@@ -465,14 +490,14 @@ std::unique_ptr<Statement> Parser::parse_while(const std::vector<Token>& tokens,
 
     // Parse condition
     if (i >= tokens.size()) {
-        std::cerr << "\033[31mError: while statement ended unexpectedly, missing condition expression\033[0m" << std::endl;
+        frontend_diagnostics() << "\033[31mError: while statement ended unexpectedly, missing condition expression\033[0m" << std::endl;
         print_context(tokens, while_start_index);
         return nullptr;
     }
 
     auto cond = parse_expression(tokens, i);
     if (!cond) {
-        std::cerr << "\033[31mError: while statement missing valid condition expression\033[0m" << std::endl;
+        frontend_diagnostics() << "\033[31mError: while statement missing valid condition expression\033[0m" << std::endl;
         print_context(tokens, i);
 
         // Try to recover: create a condition that's always true
@@ -490,7 +515,7 @@ std::unique_ptr<Statement> Parser::parse_while(const std::vector<Token>& tokens,
 
     // Check for closing parenthesis
     if (i >= tokens.size()) {
-        std::cerr << "\033[31mError: while statement condition ended unexpectedly, missing closing parenthesis\033[0m" << std::endl;
+        frontend_diagnostics() << "\033[31mError: while statement condition ended unexpectedly, missing closing parenthesis\033[0m" << std::endl;
         print_context(tokens, while_start_index);
         return nullptr;
     }
@@ -498,7 +523,7 @@ std::unique_ptr<Statement> Parser::parse_while(const std::vector<Token>& tokens,
     if (tokens[i].type == TokenType::RParen) {
         ++i;// Consume closing parenthesis
     } else {
-        std::cerr << "\033[31mError: while statement condition missing closing parenthesis ')', after line " << tokens[i - 1].line << "\033[0m" << std::endl;
+        frontend_diagnostics() << "\033[31mError: while statement condition missing closing parenthesis ')', after line " << tokens[i - 1].line << "\033[0m" << std::endl;
         print_context(tokens, i);
 
         // Try to recover: look for opening brace
@@ -513,7 +538,7 @@ std::unique_ptr<Statement> Parser::parse_while(const std::vector<Token>& tokens,
 
     // Check for opening brace
     if (i >= tokens.size()) {
-        std::cerr << "\033[31mError: while statement ended unexpectedly after closing parenthesis, missing loop body\033[0m" << std::endl;
+        frontend_diagnostics() << "\033[31mError: while statement ended unexpectedly after closing parenthesis, missing loop body\033[0m" << std::endl;
         print_context(tokens, while_start_index);
         return nullptr;
     }
@@ -521,7 +546,7 @@ std::unique_ptr<Statement> Parser::parse_while(const std::vector<Token>& tokens,
     if (tokens[i].type == TokenType::LBrace) {
         ++i;// Consume opening brace
     } else {
-        std::cerr << "\033[31mError: while statement missing opening brace '{'\033[0m" << std::endl;
+        frontend_diagnostics() << "\033[31mError: while statement missing opening brace '{'\033[0m" << std::endl;
         print_context(tokens, i);
 
         // Try to recover: create an empty block and return
@@ -537,7 +562,7 @@ std::unique_ptr<Statement> Parser::parse_while(const std::vector<Token>& tokens,
         body = parse_block(tokens, i, false);
         DEBUG_OUT << "Debug - while loop body parsing completed, contains " << body->statements.size() << " statements" << std::endl;
     } catch (const std::exception& e) {
-        std::cerr << "Error: Error parsing while loop body: " << e.what() << std::endl;
+        frontend_diagnostics() << "Error: Error parsing while loop body: " << e.what() << std::endl;
         // Create empty block as recovery measure
         body = std::make_unique<BlockStmt>();
 
@@ -564,13 +589,13 @@ std::unique_ptr<Statement> Parser::parse_statement(const std::vector<Token>& tok
     // Handle include statements first - only support quoted strings
     if (tokens[i].type == TokenType::Include && i + 1 < tokens.size()) {
         if (tokens[i + 1].type != TokenType::String) {
-            std::cerr << "Error: Include statement requires a quoted string (e.g., include \"filename\";)" << std::endl;
+            frontend_diagnostics() << "Error: Include statement requires a quoted string (e.g., include \"filename\";)" << std::endl;
             return nullptr;
         }
-        std::string mod = tokens[i + 1].text;
+        std::string mod(tokens[i + 1].text);
         i += 2;
         if (i >= tokens.size() || tokens[i].type != TokenType::Semicolon) {
-            std::cerr << "Error: Missing semicolon ';' after include statement" << std::endl;
+            frontend_diagnostics() << "Error: Missing semicolon ';' after include statement" << std::endl;
             return nullptr;
         }
         ++i;
@@ -580,7 +605,7 @@ std::unique_ptr<Statement> Parser::parse_statement(const std::vector<Token>& tok
     // Handle function definitions next, before other statement types
     if (tokens[i].type == TokenType::Func && i + 2 < tokens.size() &&
         tokens[i + 1].type == TokenType::Identifier && tokens[i + 2].type == TokenType::LParen) {
-        std::string name = tokens[i + 1].text;
+        std::string name(tokens[i + 1].text);
         int func_line = tokens[i].line;
         int func_col = tokens[i].column;
         DEBUG_OUT << "Debug - Starting function parsing: " << name << " at line " << func_line << " col " << func_col << std::endl;
@@ -592,12 +617,12 @@ std::unique_ptr<Statement> Parser::parse_statement(const std::vector<Token>& tok
         std::vector<std::string> params;
         while (i < tokens.size() && tokens[i].type != TokenType::RParen) {
             if (tokens[i].type == TokenType::Identifier) {
-                params.push_back(tokens[i].text);
+                params.emplace_back(tokens[i].text);
                 ++i;
                 if (i < tokens.size() && tokens[i].type == TokenType::Comma) {
                     ++i;
                 } else if (i < tokens.size() && tokens[i].type != TokenType::RParen) {
-                    std::cerr << "\033[31mError: Function '" << name << "' parameter list missing comma, found: "
+                    frontend_diagnostics() << "\033[31mError: Function '" << name << "' parameter list missing comma, found: "
                               << tokens[i].text << " at line " << tokens[i].line << "\033[0m" << std::endl;
                     // Try to recover: look for closing parenthesis or comma
                     while (i < tokens.size() &&
@@ -610,7 +635,7 @@ std::unique_ptr<Statement> Parser::parse_statement(const std::vector<Token>& tok
                     }
                 }
             } else {
-                std::cerr << "\033[31mError: Function '" << name << "' parameter list has invalid token: "
+                frontend_diagnostics() << "\033[31mError: Function '" << name << "' parameter list has invalid token: "
                           << tokens[i].text << " at line " << tokens[i].line << "\033[0m" << std::endl;
 
                 // Try to recover: look for next comma or closing parenthesis
@@ -626,7 +651,7 @@ std::unique_ptr<Statement> Parser::parse_statement(const std::vector<Token>& tok
         }
 
         if (i >= tokens.size()) {
-            std::cerr << "\033[31mError: Function '" << name << "' ended unexpectedly while parsing parameters, started at line " << func_line << "\033[0m" << std::endl;
+            frontend_diagnostics() << "\033[31mError: Function '" << name << "' ended unexpectedly while parsing parameters, started at line " << func_line << "\033[0m" << std::endl;
             // Output context around function start
             print_context(tokens, func_start_index);
             return nullptr;
@@ -635,7 +660,7 @@ std::unique_ptr<Statement> Parser::parse_statement(const std::vector<Token>& tok
         if (tokens[i].type == TokenType::RParen) {
             ++i;// Consume closing parenthesis
         } else {
-            std::cerr << "\033[31mError: Function '" << name << "' parameter list missing closing parenthesis, after line " << tokens[i - 1].line << " col " << tokens[i - 1].column << "\033[0m" << std::endl;
+            frontend_diagnostics() << "\033[31mError: Function '" << name << "' parameter list missing closing parenthesis, after line " << tokens[i - 1].line << " col " << tokens[i - 1].column << "\033[0m" << std::endl;
             print_context(tokens, i);
             // Try to recover: look for opening brace
             while (i < tokens.size() && tokens[i].type != TokenType::LBrace) {
@@ -647,7 +672,7 @@ std::unique_ptr<Statement> Parser::parse_statement(const std::vector<Token>& tok
         }
 
         if (i >= tokens.size()) {
-            std::cerr << "\033[31mError: Function '" << name << "' ended unexpectedly after closing parenthesis\033[0m" << std::endl;
+            frontend_diagnostics() << "\033[31mError: Function '" << name << "' ended unexpectedly after closing parenthesis\033[0m" << std::endl;
             return nullptr;
         }
 
@@ -655,7 +680,7 @@ std::unique_ptr<Statement> Parser::parse_statement(const std::vector<Token>& tok
             ++i;// Consume opening brace
             DEBUG_OUT << "Debug - Starting function '" << name << "' body parsing, line " << tokens[i - 1].line << " col " << tokens[i - 1].column << std::endl;
         } else {
-            std::cerr << "\033[31mError: Function '" << name << "' definition missing opening brace '{', after line " << tokens[i - 1].line << "\033[0m" << std::endl;
+            frontend_diagnostics() << "\033[31mError: Function '" << name << "' definition missing opening brace '{', after line " << tokens[i - 1].line << "\033[0m" << std::endl;
             print_context(tokens, i);
             return nullptr;
         }
@@ -669,7 +694,7 @@ std::unique_ptr<Statement> Parser::parse_statement(const std::vector<Token>& tok
             // Note: parse_block now handles the closing brace, so no need to check again
             return std::make_unique<FuncDefStmt>(name, params, std::move(body));
         } catch (const std::exception& e) {
-            std::cerr << "\033[31mError: Error parsing function '" << name << "' body: " << e.what() << "\033[0m" << std::endl;
+            frontend_diagnostics() << "\033[31mError: Error parsing function '" << name << "' body: " << e.what() << "\033[0m" << std::endl;
             // Try to recover: look for closing brace or function definition end marker
             while (i < tokens.size() && tokens[i].type != TokenType::RBrace) {
                 ++i;
@@ -692,65 +717,65 @@ std::unique_ptr<Statement> Parser::parse_statement(const std::vector<Token>& tok
 
     if (tokens[i].type == TokenType::Define && i + 2 < tokens.size() &&
         tokens[i + 1].type == TokenType::Identifier) {
-        std::string name = tokens[i + 1].text;
+        std::string name(tokens[i + 1].text);
         i += 2;
         auto expr = parse_expression(tokens, i);
         if (!expr) {
-            std::cerr << "Error: Missing expression in define statement for '" << name << "'" << std::endl;
+            frontend_diagnostics() << "Error: Missing expression in define statement for '" << name << "'" << std::endl;
             return nullptr;
         }
         if (i >= tokens.size() || tokens[i].type != TokenType::Semicolon) {
-            std::cerr << "Error: Missing semicolon ';' after define statement" << std::endl;
+            frontend_diagnostics() << "Error: Missing semicolon ';' after define statement" << std::endl;
             return nullptr;
         }
         ++i;
         return std::make_unique<DefineStmt>(name, std::move(expr));
     } else if (tokens[i].type == TokenType::Bigint && i + 1 < tokens.size() &&
                tokens[i + 1].type == TokenType::Identifier) {
-        std::string name = tokens[i + 1].text;
+        std::string name(tokens[i + 1].text);
         i += 2;
         std::unique_ptr<Expression> init_value = nullptr;
         if (i < tokens.size() && tokens[i].type == TokenType::Assign) {
             ++i;
             init_value = parse_expression(tokens, i);
             if (!init_value) {
-                std::cerr << "Error: Missing expression in bigint declaration for '" << name << "'" << std::endl;
+                frontend_diagnostics() << "Error: Missing expression in bigint declaration for '" << name << "'" << std::endl;
                 return nullptr;
             }
         }
         if (i >= tokens.size() || tokens[i].type != TokenType::Semicolon) {
-            std::cerr << "Error: Missing semicolon ';' after bigint declaration" << std::endl;
+            frontend_diagnostics() << "Error: Missing semicolon ';' after bigint declaration" << std::endl;
             return nullptr;
         }
         ++i;
         return std::make_unique<BigIntDeclStmt>(name, std::move(init_value));
     } else if (tokens[i].type == TokenType::Var && tokens[i + 1].type == TokenType::Identifier && tokens[i + 2].type == TokenType::Assign) {
-        std::string name = tokens[i + 1].text;
+        std::string name(tokens[i + 1].text);
         DEBUG_OUT << "Debug - Parsing variable declaration: " << name << std::endl;
         i += 3;
         DEBUG_OUT << "Debug - About to parse expression for variable " << name << std::endl;
         auto expr = parse_expression(tokens, i);
         DEBUG_OUT << "Debug - Expression parsing result: " << (expr ? "success" : "failed") << std::endl;
         if (!expr) {
-            std::cerr << "Error: Missing expression in variable declaration for '" << name << "'" << std::endl;
+            frontend_diagnostics() << "Error: Missing expression in variable declaration for '" << name << "'" << std::endl;
             return nullptr;
         }
         if (i >= tokens.size() || tokens[i].type != TokenType::Semicolon) {
-            std::cerr << "Error: Missing semicolon ';' after variable declaration" << std::endl;
+            frontend_diagnostics() << "Error: Missing semicolon ';' after variable declaration" << std::endl;
             return nullptr;
         }
         ++i;
         return std::make_unique<VarDeclStmt>(name, std::move(expr));
     } else if (tokens[i].type == TokenType::Identifier && tokens[i + 1].type == TokenType::Assign) {
-        std::string name = tokens[i].text;
+        std::string name(tokens[i].text);
         i += 2;
         auto expr = parse_expression(tokens, i);
         if (!expr) {
-            std::cerr << "Error: Missing expression in assignment to '" << name << "'" << std::endl;
+            frontend_diagnostics() << "Error: Missing expression in assignment to '" << name << "'" << std::endl;
             return nullptr;
         }
         if (i >= tokens.size() || tokens[i].type != TokenType::Semicolon) {
-            std::cerr << "Error: Missing semicolon ';' after assignment" << std::endl;
+            frontend_diagnostics() << "Error: Missing semicolon ';' after assignment" << std::endl;
             return nullptr;
         }
         ++i;
@@ -760,11 +785,11 @@ std::unique_ptr<Statement> Parser::parse_statement(const std::vector<Token>& tok
         ++i;
         auto expr = parse_expression(tokens, i);
         if (!expr) {
-            std::cerr << "Error: Missing expression in return statement" << std::endl;
+            frontend_diagnostics() << "Error: Missing expression in return statement" << std::endl;
             return nullptr;
         }
         if (i >= tokens.size() || tokens[i].type != TokenType::Semicolon) {
-            std::cerr << "Error: Missing semicolon ';' after return statement" << std::endl;
+            frontend_diagnostics() << "Error: Missing semicolon ';' after return statement" << std::endl;
             return nullptr;
         }
         ++i;
@@ -772,7 +797,7 @@ std::unique_ptr<Statement> Parser::parse_statement(const std::vector<Token>& tok
     } else if (tokens[i].type == TokenType::Break) {
         ++i;
         if (i >= tokens.size() || tokens[i].type != TokenType::Semicolon) {
-            std::cerr << "Error: Missing semicolon ';' after break statement" << std::endl;
+            frontend_diagnostics() << "Error: Missing semicolon ';' after break statement" << std::endl;
             return nullptr;
         }
         ++i;
@@ -780,7 +805,7 @@ std::unique_ptr<Statement> Parser::parse_statement(const std::vector<Token>& tok
     } else if (tokens[i].type == TokenType::Continue) {
         ++i;
         if (i >= tokens.size() || tokens[i].type != TokenType::Semicolon) {
-            std::cerr << "Error: Missing semicolon ';' after continue statement" << std::endl;
+            frontend_diagnostics() << "Error: Missing semicolon ';' after continue statement" << std::endl;
             return nullptr;
         }
         ++i;
@@ -800,7 +825,7 @@ std::unique_ptr<Statement> Parser::parse_statement(const std::vector<Token>& tok
 
         // Check for left parenthesis
         if (i >= tokens.size() || tokens[i].type != TokenType::LParen) {
-            std::cerr << "Error: Missing left parenthesis '(' after if statement" << std::endl;
+            frontend_diagnostics() << "Error: Missing left parenthesis '(' after if statement" << std::endl;
             print_context(tokens, i > 0 ? i - 1 : 0);
 
             // Try to recover: look for left parenthesis or left brace
@@ -819,14 +844,14 @@ std::unique_ptr<Statement> Parser::parse_statement(const std::vector<Token>& tok
 
         // Parse condition
         if (i >= tokens.size()) {
-            std::cerr << "Error: if statement ended unexpectedly, missing condition expression" << std::endl;
+            frontend_diagnostics() << "Error: if statement ended unexpectedly, missing condition expression" << std::endl;
             print_context(tokens, if_start_index);
             return nullptr;
         }
 
         auto cond = parse_expression(tokens, i);
         if (!cond) {
-            std::cerr << "Error: if statement missing valid condition expression" << std::endl;
+            frontend_diagnostics() << "Error: if statement missing valid condition expression" << std::endl;
             print_context(tokens, i);
 
             // Try to recover: look for right parenthesis
@@ -841,7 +866,7 @@ std::unique_ptr<Statement> Parser::parse_statement(const std::vector<Token>& tok
 
         // Check right parenthesis
         if (i >= tokens.size()) {
-            std::cerr << "Error: if statement condition ended unexpectedly, missing right parenthesis" << std::endl;
+            frontend_diagnostics() << "Error: if statement condition ended unexpectedly, missing right parenthesis" << std::endl;
             print_context(tokens, if_start_index);
             return nullptr;
         }
@@ -849,7 +874,7 @@ std::unique_ptr<Statement> Parser::parse_statement(const std::vector<Token>& tok
         if (tokens[i].type == TokenType::RParen) {
             ++i;// Consume right parenthesis
         } else {
-            std::cerr << "Error: if statement condition missing right parenthesis ')', after line " << tokens[i - 1].line << std::endl;
+            frontend_diagnostics() << "Error: if statement condition missing right parenthesis ')', after line " << tokens[i - 1].line << std::endl;
             print_context(tokens, i);
 
             // Try to recover: look for left brace
@@ -864,7 +889,7 @@ std::unique_ptr<Statement> Parser::parse_statement(const std::vector<Token>& tok
 
         // Check left brace
         if (i >= tokens.size()) {
-            std::cerr << "Error: if statement ended unexpectedly after right parenthesis, missing body" << std::endl;
+            frontend_diagnostics() << "Error: if statement ended unexpectedly after right parenthesis, missing body" << std::endl;
             print_context(tokens, if_start_index);
             return nullptr;
         }
@@ -872,7 +897,7 @@ std::unique_ptr<Statement> Parser::parse_statement(const std::vector<Token>& tok
         if (tokens[i].type == TokenType::LBrace) {
             ++i;// Consume left brace
         } else {
-            std::cerr << "Error: if statement missing left brace '{'" << std::endl;
+            frontend_diagnostics() << "Error: if statement missing left brace '{'" << std::endl;
             print_context(tokens, i);
 
             // Try to recover: create an empty block and return
@@ -888,7 +913,7 @@ std::unique_ptr<Statement> Parser::parse_statement(const std::vector<Token>& tok
             thenBlock = parse_block(tokens, i, false);
             DEBUG_OUT << "Debug - if then block parsing completed, contains " << thenBlock->statements.size() << " statements" << std::endl;
         } catch (const std::exception& e) {
-            std::cerr << "Error: Error parsing if then block: " << e.what() << std::endl;
+            frontend_diagnostics() << "Error: Error parsing if then block: " << e.what() << std::endl;
             // Create empty block as recovery measure
             thenBlock = std::make_unique<BlockStmt>();
 
@@ -913,7 +938,7 @@ std::unique_ptr<Statement> Parser::parse_statement(const std::vector<Token>& tok
             DEBUG_OUT << "Debug - Starting else block parsing, line " << else_line << std::endl;
 
             if (i >= tokens.size()) {
-                std::cerr << "Error: else keyword ended unexpectedly" << std::endl;
+                frontend_diagnostics() << "Error: else keyword ended unexpectedly" << std::endl;
                 return std::make_unique<IfStmt>(std::move(cond), std::move(thenBlock), nullptr);
             }
 
@@ -927,7 +952,7 @@ std::unique_ptr<Statement> Parser::parse_statement(const std::vector<Token>& tok
                     elseBlock->statements.push_back(std::move(nestedIf));
                     DEBUG_OUT << "Debug - else if parsing completed" << std::endl;
                 } else {
-                    std::cerr << "Error: else if parsing failed" << std::endl;
+                    frontend_diagnostics() << "Error: else if parsing failed" << std::endl;
                     return std::make_unique<IfStmt>(std::move(cond), std::move(thenBlock), nullptr);
                 }
             } else if (tokens[i].type == TokenType::LBrace) {
@@ -939,12 +964,12 @@ std::unique_ptr<Statement> Parser::parse_statement(const std::vector<Token>& tok
                     elseBlock = parse_block(tokens, i, false);
                     DEBUG_OUT << "Debug - else block parsing completed, contains " << elseBlock->statements.size() << " statements" << std::endl;
                 } catch (const std::exception& e) {
-                    std::cerr << "Error: Error parsing else block: " << e.what() << std::endl;
+                    frontend_diagnostics() << "Error: Error parsing else block: " << e.what() << std::endl;
                     // Create empty block as recovery measure
                     elseBlock = std::make_unique<BlockStmt>();
                 }
             } else {
-                std::cerr << "Error: else block missing left brace '{'" << std::endl;
+                frontend_diagnostics() << "Error: else block missing left brace '{'" << std::endl;
                 print_context(tokens, i);
 
                 // Return if statement without else block
@@ -961,7 +986,7 @@ std::unique_ptr<Statement> Parser::parse_statement(const std::vector<Token>& tok
         if (i < tokens.size() && tokens[i].type != TokenType::EndOfFile) {
             auto expr = parse_expression(tokens, i);
             if (i >= tokens.size() || tokens[i].type != TokenType::Semicolon) {
-                std::cerr << "Error: Missing semicolon ';' after expression statement" << std::endl;
+                frontend_diagnostics() << "Error: Missing semicolon ';' after expression statement" << std::endl;
                 return nullptr;
             }
             ++i;
@@ -972,41 +997,52 @@ std::unique_ptr<Statement> Parser::parse_statement(const std::vector<Token>& tok
     // Add more detailed debug output and error handling at the end
     if (i < tokens.size()) {
         // Encountered an unrecognized token, provide detailed context
-        std::cerr << "\033[1;31mError:\033[0m Unrecognized syntax element '" << tokens[i].text
+        frontend_diagnostics() << "\033[1;31mError:\033[0m Unrecognized syntax element '" << tokens[i].text
                   << "' (type=" << static_cast<int>(tokens[i].type)
                   << ") at line " << tokens[i].line
                   << " column " << tokens[i].column << std::endl;
 
         // Print context
-        std::cerr << "\033[1;33mContext:\033[0m ";
+        frontend_diagnostics() << "\033[1;33mContext:\033[0m ";
         size_t context_start = i > 5 ? i - 5 : 0;
         size_t context_end = std::min(i + 5, tokens.size() - 1);
 
         for (size_t j = context_start; j <= context_end; j++) {
             if (j == i) {
-                std::cerr << "\033[1;31m[" << tokens[j].text << "]\033[0m ";
+                frontend_diagnostics() << "\033[1;31m[" << tokens[j].text << "]\033[0m ";
             } else {
-                std::cerr << tokens[j].text << " ";
+                frontend_diagnostics() << tokens[j].text << " ";
             }
         }
-        std::cerr << std::endl;
+        frontend_diagnostics() << std::endl;
 
         // Try to provide possible error causes
         if (tokens[i].type == TokenType::RBrace) {
-            std::cerr << "Hint: Found extra closing brace '}', may be a block nesting issue" << std::endl;
+            frontend_diagnostics() << "Hint: Found extra closing brace '}', may be a block nesting issue" << std::endl;
         } else if (tokens[i].type == TokenType::RParen) {
-            std::cerr << "Hint: Found extra closing parenthesis ')', check expressions or conditional statements" << std::endl;
+            frontend_diagnostics() << "Hint: Found extra closing parenthesis ')', check expressions or conditional statements" << std::endl;
         } else if (tokens[i].type == TokenType::Else) {
-            std::cerr << "Hint: 'else' keyword missing complete if statement before it" << std::endl;
+            frontend_diagnostics() << "Hint: 'else' keyword missing complete if statement before it" << std::endl;
         }
     } else {
-        std::cerr << "\033[31mError: Parser ended unexpectedly at end of file\033[0m" << std::endl;
+        frontend_diagnostics() << "\033[31mError: Parser ended unexpectedly at end of file\033[0m" << std::endl;
     }
 
     // Return null pointer to indicate parsing failure
     return nullptr;
 }
 
+SyntaxTree Parser::parse_tree(std::shared_ptr<const void> source_owner, std::string_view source) {
+    SyntaxTree tree;
+    tree.source_owner = std::move(source_owner);
+    tree.source = source;
+    tree.arena = std::make_unique<AstArena>();
+    AstArena::Scope scope(*tree.arena);
+    auto tokens = Lexer::tokenize(source);
+    tree.root = parse(tokens.tokens);
+    return tree;
+}
+
 std::unique_ptr<ASTNode> Parser::parse(const std::vector<Token>& tokens) {
     size_t i = 0;
     try {
@@ -1015,14 +1051,14 @@ std::unique_ptr<ASTNode> Parser::parse(const std::vector<Token>& tokens) {
 
         // Verify that all tokens were consumed
         if (i < tokens.size() && tokens[i].type != TokenType::EndOfFile) {
-            std::cerr << "\033[33mWarning: Unprocessed tokens remain after parsing completion, starting from position " << i << "\033[0m" << std::endl;
-            std::cerr << "First unprocessed token: " << tokens[i].text
+            frontend_diagnostics() << "\033[33mWarning: Unprocessed tokens remain after parsing completion, starting from position " << i << "\033[0m" << std::endl;
+            frontend_diagnostics() << "First unprocessed token: " << tokens[i].text
                       << " (line " << tokens[i].line << ")" << std::endl;
         }
 
         return result;
     } catch (const std::exception& e) {
-        std::cerr << "\033[31mParse error: " << e.what() << "\033[0m" << std::endl;
+        frontend_diagnostics() << "\033[31mParse error: " << e.what() << "\033[0m" << std::endl;
         return nullptr;
     }
 }
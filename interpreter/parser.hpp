@@ -16,6 +16,8 @@
 class LAMINA_API Parser {
 public:
     static std::unique_ptr<ASTNode> parse(const std::vector<Token>& tokens);
+    // 词法分析并解析整段源码，节点分配在新建的 AstArena 中；source_owner 须拥有 source 指向的内存
+    static SyntaxTree parse_tree(std::shared_ptr<const void> source_owner, std::string_view source);
     static std::unique_ptr<Expression> parse_expression(const std::vector<Token>& tokens, size_t& i);
     // 解析不同层级的表达式，处理正确的运算符优先级
     static std::unique_ptr<Expression> parse_comparison(const std::vector<Token>& tokens, size_t& i);
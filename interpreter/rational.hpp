@@ -12,17 +12,7 @@ private:
 
     // 求最大公约数
     static BigInt gcd(const BigInt& a, const BigInt& b) {
-        BigInt abs_a = a;
-        abs_a.negative = false;
-        BigInt abs_b = b;
-        abs_b.negative = false;
-
-        while (!abs_b.is_zero()) {
-            BigInt temp = abs_b;
-            abs_b = abs_a % abs_b;
-            abs_a = temp;
-        }
-        return abs_a;
+        return BigInt::gcd(a, b);
     }
 
     // 化简分数
@@ -39,9 +29,9 @@ private:
 
         // 化简
         BigInt g = gcd(numerator, denominator);
-        if (!g.is_zero() && !(g.digits.size() == 1 && g.digits[0] == 1)) {
-            numerator = numerator / g;
-            denominator = denominator / g;
+        if (!g.is_zero() && !g.is_one()) {
+            numerator /= g;
+            denominator /= g;
         }
     }
 
@@ -104,7 +94,7 @@ public:
 
     // 判断是否为整数
     bool is_integer() const {
-        return denominator.digits.size() == 1 && denominator.digits[0] == 1;
+        return denominator.is_one();
     }
 
     // 判断是否为零
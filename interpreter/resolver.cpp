@@ -0,0 +1,220 @@
+#include "resolver.hpp"
+
+namespace {
+
+// 收集函数体内被赋值的名字（不进入嵌套函数定义）
+void collect_locals(const Statement* node, std::vector<std::string>& locals) {
+    if (!node) return;
+    auto add = [&locals](const std::string& name) {
+        for (const auto& l: locals) {
+            if (l == name) return;
+        }
+        locals.push_back(name);
+    };
+    switch (node->kind) {
+        case NodeKind::VarDeclStmt:
+            add(static_cast<const VarDeclStmt*>(node)->name);
+            break;
+        case NodeKind::AssignStmt:
+            add(static_cast<const AssignStmt*>(node)->name);
+            break;
+        case NodeKind::BigIntDeclStmt:
+            add(static_cast<const BigIntDeclStmt*>(node)->name);
+            break;
+        case NodeKind::StructDeclStmt:
+            add(static_cast<const StructDeclStmt*>(node)->name);
+            break;
+        case NodeKind::IfStmt: {
+            auto* ifs = static_cast<const IfStmt*>(node);
+            collect_locals(ifs->thenBlock.get(), locals);
+            collect_locals(ifs->elseBlock.get(), locals);
+            break;
+        }
+        case NodeKind::WhileStmt:
+            collect_locals(static_cast<const WhileStmt*>(node)->body.get(), locals);
+            break;
+        case NodeKind::BlockStmt:
+            for (const auto& stmt: static_cast<const BlockStmt*>(node)->statements) {
+                collect_locals(stmt.get(), locals);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+}// namespace
+
+void Resolver::resolve(BlockStmt* block) {
+    if (!block) return;
+    for (auto& stmt: block->statements) resolve_statement(stmt.get());
+}
+
+void Resolver::resolve_function(FuncDefStmt* func) {
+    // 参数在前；重名参数沿用同一个槽位，后传入的值覆盖先传入的
+    func->locals.clear();
+    func->param_slots.clear();
+    for (const auto& p: func->params) {
+        size_t i = 0;
+        while (i < func->locals.size() && func->locals[i] != p) ++i;
+        if (i == func->locals.size()) func->locals.push_back(p);
+        func->param_slots.push_back(static_cast<int>(i));
+    }
+    collect_locals(func->body.get(), func->locals);
+    for (const auto& name: func->locals) globals.shadowed[globals.slot(name)] = 1;
+
+    std::unordered_map<std::string, int> slots;
+    for (size_t i = 0; i < func->locals.size(); ++i) {
+        slots[func->locals[i]] = static_cast<int>(i);
+    }
+    const auto* saved = locals;
+    const int saved_loop_depth = loop_depth;
+    std::unordered_set<std::string> saved_assigned(func->params.begin(), func->params.end());
+    assigned.swap(saved_assigned);
+    locals = &slots;
+    loop_depth = 0;
+    resolve(func->body.get());
+    locals = saved;
+    loop_depth = saved_loop_depth;
+    assigned.swap(saved_assigned);
+}
+
+void Resolver::declare(const std::string& name) {
+    if (locals) assigned.insert(name);
+}
+
+void Resolver::note_read(const Binding& binding, const std::string& name) {
+    if (!locals) return;
+    if (binding.scope == Binding::Scope::Local && assigned.count(name)) return;
+    globals.dynamic_reads.insert(name);
+}
+
+void Resolver::bind(Binding& binding, const std::string& name) {
+    if (locals) {
+        auto it = locals->find(name);
+        if (it != locals->end()) {
+            binding.scope = Binding::Scope::Local;
+            binding.index = it->second;
+            return;
+        }
+    }
+    binding.scope = Binding::Scope::Global;
+    binding.index = globals.slot(name);
+}
+
+void Resolver::resolve_statement(Statement* node) {
+    if (!node) return;
+    switch (node->kind) {
+        case NodeKind::VarDeclStmt: {
+            auto* v = static_cast<VarDeclStmt*>(node);
+            resolve_expression(v->expr.get());
+            bind(v->binding, v->name);
+            declare(v->name);
+            break;
+        }
+        case NodeKind::AssignStmt: {
+            auto* a = static_cast<AssignStmt*>(node);
+            resolve_expression(a->expr.get());
+            bind(a->binding, a->name);
+            declare(a->name);
+            break;
+        }
+        case NodeKind::BigIntDeclStmt: {
+            auto* bi = static_cast<BigIntDeclStmt*>(node);
+            resolve_expression(bi->init_value.get());
+            bind(bi->binding, bi->name);
+            declare(bi->name);
+            break;
+        }
+        case NodeKind::StructDeclStmt: {
+            auto* s = static_cast<StructDeclStmt*>(node);
+            for (auto& [n, e]: s->init_vec) resolve_expression(e.get());
+            bind(s->binding, s->name);
+            declare(s->name);
+            break;
+        }
+        case NodeKind::DefineStmt:
+            resolve_expression(static_cast<DefineStmt*>(node)->value.get());
+            break;
+        case NodeKind::IfStmt: {
+            auto* ifs = static_cast<IfStmt*>(node);
+            resolve_expression(ifs->condition.get());
+            // 分支内的赋值不一定执行，离开分支后恢复
+            const auto before = assigned;
+            resolve(ifs->thenBlock.get());
+            assigned = before;
+            resolve(ifs->elseBlock.get());
+            assigned = before;
+            break;
+        }
+        case NodeKind::WhileStmt: {
+            auto* ws = static_cast<WhileStmt*>(node);
+            resolve_expression(ws->condition.get());
+            const auto before = assigned;
+            ++loop_depth;
+            resolve(ws->body.get());
+            --loop_depth;
+            assigned = before;
+            break;
+        }
+        case NodeKind::FuncDefStmt:
+            resolve_function(static_cast<FuncDefStmt*>(node));
+            break;
+        case NodeKind::BlockStmt:
+            resolve(static_cast<BlockStmt*>(node));
+            break;
+        case NodeKind::ReturnStmt: {
+            auto* ret = static_cast<ReturnStmt*>(node);
+            resolve_expression(ret->expr.get());
+            ret->tail_call = locals && loop_depth == 0 && ret->expr && ret->expr->kind == NodeKind::CallExpr;
+            break;
+        }
+        case NodeKind::ExprStmt:
+            resolve_expression(static_cast<ExprStmt*>(node)->expr.get());
+            break;
+        default:
+            break;
+    }
+}
+
+void Resolver::resolve_expression(Expression* node) {
+    if (!node) return;
+    switch (node->kind) {
+        case NodeKind::IdentifierExpr: {
+            auto* id = static_cast<IdentifierExpr*>(node);
+            bind(id->binding, id->name);
+            note_read(id->binding, id->name);
+            break;
+        }
+        case NodeKind::VarExpr: {
+            auto* var = static_cast<VarExpr*>(node);
+            bind(var->binding, var->name);
+            note_read(var->binding, var->name);
+            break;
+        }
+        case NodeKind::BinaryExpr: {
+            auto* bin = static_cast<BinaryExpr*>(node);
+            resolve_expression(bin->left.get());
+            resolve_expression(bin->right.get());
+            break;
+        }
+        case NodeKind::UnaryExpr:
+            resolve_expression(static_cast<UnaryExpr*>(node)->operand.get());
+            break;
+        case NodeKind::CallExpr: {
+            auto* call = static_cast<CallExpr*>(node);
+            for (auto& arg: call->args) resolve_expression(arg.get());
+            // 被调名可能是调用者帧中保存函数名的变量（"__function_" 间接调用）
+            if (locals) globals.dynamic_reads.insert(call->callee);
+            break;
+        }
+        case NodeKind::NamespaceCallExpr:
+            for (auto& arg: static_cast<NamespaceCallExpr*>(node)->args) resolve_expression(arg.get());
+            break;
+        case NodeKind::ArrayExpr:
+            for (auto& element: static_cast<ArrayExpr*>(node)->elements) resolve_expression(element.get());
+            break;
+        default:
+            break;
+    }
+}
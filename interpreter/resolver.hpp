@@ -0,0 +1,48 @@
+#pragma once
+#include "ast.hpp"
+#include "interpreter.hpp"
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#ifdef _WIN32
+#ifdef LAMINA_CORE_EXPORTS
+#define LAMINA_API __declspec(dllexport)
+#else
+#define LAMINA_API __declspec(dllimport)
+#endif
+#else
+#define LAMINA_API
+#endif
+
+/*
+    变量解析：在 Parser::parse 之后、执行之前遍历 AST，
+    把变量读写绑定到函数帧槽位或全局变量表下标。
+    函数体内被赋值的名字（含参数）是局部变量，其余名字一律视为全局
+ */
+class LAMINA_API Resolver {
+public:
+    explicit Resolver(GlobalTable& globals) : globals(globals) {}
+
+    // 解析顶层代码（脚本、模块或 REPL 输入）
+    void resolve(BlockStmt* block);
+    // 解析单个函数定义，写入 locals / param_slots
+    void resolve_function(FuncDefStmt* func);
+
+private:
+    GlobalTable& globals;
+    // 当前函数的名字 -> 槽位；顶层代码时为空
+    const std::unordered_map<std::string, int>* locals = nullptr;
+    // 当前函数内 while 的嵌套层数，循环内的 return 不作尾调用
+    int loop_depth = 0;
+    // 按源码顺序执行到当前位置时一定已赋值的局部变量：参数，以及所在块及外层块中此前的赋值
+    std::unordered_set<std::string> assigned;
+
+    void resolve_statement(Statement* node);
+    void resolve_expression(Expression* node);
+    void bind(Binding& binding, const std::string& name);
+    // 记录函数体内的变量写入和读取，读取可能按名查找时加入 GlobalTable::dynamic_reads
+    void declare(const std::string& name);
+    void note_read(const Binding& binding, const std::string& name);
+};
@@ -80,9 +80,9 @@ public:
 		std::shared_ptr<SymbolicExpr> hash_obj = SymbolicExpr::number(1);	// 因为是乘法，1为默认状态。此处存储被 hash 的项目对应的值
 		
 		static HashType bigint_hash(const BigInt& rt) {
-			// 直接哈希所有 digits
+			// 直接哈希所有 limbs
 			HashType weight = 1ull, ans = 0ull;
-			for (auto &i : rt.digits) {
+			for (auto &i : rt.limbs) {
 				ans = ans * weight + (i + 3ull);
 				weight *= 17ull;			// 不用 10 减少哈希冲突
 			}
@@ -215,6 +215,12 @@ public:
         return expr;
     }
 
+    // 64 位整数：int 范围内按 int 存放，超出时转为 BigInt
+    static std::shared_ptr<SymbolicExpr> number(int64_t n) {
+        if (n >= INT_MIN && n <= INT_MAX) return number(static_cast<int>(n));
+        return number(::BigInt(n));
+    }
+
     static std::shared_ptr<SymbolicExpr> number(const ::BigInt& bi) {
         auto expr = std::make_shared<SymbolicExpr>(Type::Number);
         expr->number_value = bi;
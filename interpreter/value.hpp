@@ -5,8 +5,11 @@
 #include "symbolic.hpp"
 
 #include <cmath>
+#include <cstdint>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <type_traits>
 #include <variant>
 #include <vector>
 
@@ -25,82 +28,126 @@ LAMINA_API std::string lStruct_to_string(const std::shared_ptr<lStruct>& lstruct
 
 class LAMINA_API Value {
 public:
-    enum class Type { Null,
-					  Infinity,
-                      Bool,
-                      Int,
-                      Float,
-                      String,
-                      Array,
-                      Matrix,
-                      BigInt,
-                      Rational,
-                      Irrational,
-                      lStruct,
-                      Symbolic };
+    enum class Type : unsigned char {
+        Null,
+        Infinity,
+        Bool,
+        Int,
+        Float,
+        String,
+        Array,
+        Matrix,
+        BigInt,
+        Rational,
+        Irrational,
+        lStruct,
+        Symbolic
+    };
     Type type;
-	
-	using DataType = std::variant<
-            std::nullptr_t,
-            bool, int, double, std::string,
-            std::vector<Value>,
-            std::vector<std::vector<Value>>,
-            std::vector<std::pair<std::string, Value>>,
-            ::BigInt, ::Rational, ::Irrational,
-            std::shared_ptr<SymbolicExpr>,
-            std::shared_ptr<lStruct>>;
-    DataType data;
-
-    virtual ~Value() = default;
+
+    /*
+        16 字节的紧凑表示：type 之后是 8 字节负载。
+        Null/Bool/Int/Float/Infinity 直接存放在负载中；
+        其余类型存放在带引用计数的堆盒子里，复制 Value 只增加引用计数，
+        通过 get_mut 修改前若盒子被共享则先复制一份，保持值语义
+     */
+    struct Box {
+        uint32_t refs = 1;
+        virtual ~Box() = default;
+        virtual Box* clone() const = 0;
+    };
+    template<typename T>
+    struct BoxOf;
+    // 矩阵负载：每行是一个数组 Value，与构造它的数组共享同一个盒子，
+    // 由数组的数组构造矩阵时只增加各行的引用计数，不复制元素
+    struct MatrixRows {
+        std::vector<Value> rows;
+
+        size_t size() const { return rows.size(); }
+        bool empty() const { return rows.empty(); }
+        const std::vector<Value>& row(size_t i) const { return rows[i].get<std::vector<Value>>(); }
+        const std::vector<Value>& operator[](size_t i) const { return row(i); }
+    };
 
     // Constructors
-    Value() : type(Type::Null), data(std::in_place_index<0>, nullptr) {}// 0对应std::nullptr_t类型
-
-    // 其他构造函数需要同步修改初始化方式
-    Value(std::nullptr_t) : type(Type::Null), data(std::in_place_index<0>, nullptr) {}
-    Value(bool b) : type(Type::Bool), data(std::in_place_index<1>, b) {}
-    Value(int i) : type(Type::Int), data(std::in_place_index<2>, i) {}
-    Value(const std::string& s) : type(Type::String), data(s) {}
-    Value(const char* s) : type(Type::String), data(std::string(s)) {}
-    Value(const ::BigInt& bi) : type(Type::BigInt), data(bi) {}
-    Value(const ::Rational& r) : type(Type::Rational), data(r) {}
-    Value(const ::Irrational& ir) : type(Type::Irrational), data(ir) {}
-    Value(const std::shared_ptr<lStruct>& lstruct) : type(Type::lStruct), data(lstruct) {}
-    Value(const std::shared_ptr<SymbolicExpr>& sym) : type(Type::Symbolic), data(sym) {}
-	Value(double f) : type(Type::Float), data(std::in_place_index<3>, f) {
+    Value() noexcept : type(Type::Null) { payload.box = nullptr; }
+    Value(std::nullptr_t) noexcept : Value() {}
+    Value(bool b) noexcept : type(Type::Bool) { payload.b = b; }
+    Value(int i) noexcept : type(Type::Int) { payload.i = i; }
+    Value(int64_t i) noexcept : type(Type::Int) { payload.i = i; }
+    Value(const std::string& s) : type(Type::String) { payload.box = make_box(s); }
+    Value(std::string&& s) : type(Type::String) { payload.box = make_box(std::move(s)); }
+    Value(const char* s) : type(Type::String) { payload.box = make_box(std::string(s)); }
+    Value(const ::BigInt& bi) : type(Type::BigInt) { payload.box = make_box(bi); }
+    Value(::BigInt&& bi) : type(Type::BigInt) { payload.box = make_box(std::move(bi)); }
+    Value(const ::Rational& r) : type(Type::Rational) { payload.box = make_box(r); }
+    Value(::Rational&& r) : type(Type::Rational) { payload.box = make_box(std::move(r)); }
+    Value(const ::Irrational& ir) : type(Type::Irrational) { payload.box = make_box(ir); }
+    Value(::Irrational&& ir) : type(Type::Irrational) { payload.box = make_box(std::move(ir)); }
+    Value(std::shared_ptr<lStruct> lstruct) : type(Type::lStruct) { payload.box = make_box(std::move(lstruct)); }
+    Value(std::shared_ptr<SymbolicExpr> sym) : type(Type::Symbolic) { payload.box = make_box(std::move(sym)); }
+	Value(double f) noexcept : type(Type::Float) {
+		payload.f = f;
 		int res = std::isinf(f);
 		if (res) {
 			if (f < 0) res = -1;
 			this->type = Type::Infinity;
-			this->data = DataType(std::in_place_index<2>, res);
+			payload.i = res;
 		}
 	}
-    Value(const std::vector<Value>& arr) {
-        // Check if this is a matrix (array of arrays)
-        bool is_matrix = !arr.empty() && arr[0].is_array();
-        if (is_matrix) {
-            // Convert to matrix
-            std::vector<std::vector<Value>> matrix;
-            for (const auto& row: arr) {
-                if (row.is_array()) {
-                    matrix.push_back(std::get<std::vector<Value>>(row.data));
-                } else {
-                    // Mixed types, treat as array
-                    type = Type::Array;
-                    data = arr;
-                    return;
-                }
-            }
-            type = Type::Matrix;
-            data = matrix;
-        } else {
-            type = Type::Array;
-            data = arr;
-        }
+    // 右值重载直接接管元素，临时数组不再复制一遍
+    Value(const std::vector<Value>& arr);
+    Value(std::vector<Value>&& arr);
+    Value(const std::vector<std::vector<Value>>& mat);
+    Value(std::vector<std::vector<Value>>&& mat);
+
+    // 无穷大，sign 为 1 或 -1
+    static Value infinity(int sign) noexcept {
+        Value v;
+        v.type = Type::Infinity;
+        v.payload.i = sign;
+        return v;
     }
 
-
-    Value(const std::vector<std::vector<Value>>& mat) : type(Type::Matrix), data(mat) {}
+    Value(const Value& other) noexcept : type(other.type), payload(other.payload) {
+        if (is_boxed()) ++payload.box->refs;
+    }
+    Value(Value&& other) noexcept : type(other.type), payload(other.payload) {
+        other.type = Type::Null;
+        other.payload.box = nullptr;
+    }
+    Value& operator=(const Value& other) noexcept {
+        if (other.is_boxed()) ++other.payload.box->refs;
+        release();
+        type = other.type;
+        payload = other.payload;
+        return *this;
+    }
+    Value& operator=(Value&& other) noexcept {
+        if (this != &other) {
+            release();
+            type = other.type;
+            payload = other.payload;
+            other.type = Type::Null;
+            other.payload.box = nullptr;
+        }
+        return *this;
+    }
+    ~Value() { release(); }
+
+    // 读取负载；类型不符时抛出 std::bad_variant_access。
+    // 整数以 int64_t 存放，get<int>() 按值返回并饱和到 int 范围（与 BigInt::to_int 一致）
+    template<typename T>
+    using get_result = std::conditional_t<std::is_same_v<T, int>, int, const T&>;
+    template<typename T>
+    get_result<T> get() const;
+    // 可写访问：共享的盒子先复制，修改不会影响其他副本
+    template<typename T>
+    T& get_mut();
+    // 两个 Value 是否引用同一个盒子
+    bool shares_payload(const Value& other) const noexcept {
+        return is_boxed() && type == other.type && payload.box == other.payload.box;
+    }
 
     // Type checking helpers
     bool is_null() const { return type == Type::Null; }
@@ -119,12 +166,12 @@ public:
     bool is_numeric() const { return type == Type::Int || type == Type::Float || type == Type::BigInt || type == Type::Rational || type == Type::Irrational || type == Type::Symbolic; }
     // Get numeric value as double
     double as_number() const {
-		if (type == Type::Infinity) return (1.0 * std::get<int>(data) / 0.0);
-        if (type == Type::Int) return static_cast<double>(std::get<int>(data));
-        if (type == Type::Float) return std::get<double>(data);
+		if (type == Type::Infinity) return (1.0 * get<int>() / 0.0);
+        if (type == Type::Int) return static_cast<double>(payload.i);
+        if (type == Type::Float) return get<double>();
         if (type == Type::BigInt) {
             // For BigInt, try to convert to int first, then to double
-            const auto& bigint_val = std::get<::BigInt>(data);
+            const auto& bigint_val = get<::BigInt>();
             int int_val = bigint_val.to_int();
             if (int_val == INT_MAX || int_val == INT_MIN) {
                 // BigInt was too large for int, use double conversion
@@ -133,48 +180,55 @@ public:
             return static_cast<double>(int_val);
         }
         if (type == Type::Rational) {
-            return std::get<::Rational>(data).to_double();
+            return get<::Rational>().to_double();
         }
         if (type == Type::Irrational) {
-            return std::get<::Irrational>(data).to_double();
+            return get<::Irrational>().to_double();
         }
         if (type == Type::Symbolic) {
-            return std::get<std::shared_ptr<SymbolicExpr>>(data)->to_double();
+            return get<std::shared_ptr<SymbolicExpr>>()->to_double();
         }
         return 0.0;
     }
 
     // Get numeric value as Rational (for precise calculations)
     ::Rational as_rational() const {
-        if (type == Type::Rational) return std::get<::Rational>(data);
-        if (type == Type::Int) return ::Rational(std::get<int>(data));
-        if (type == Type::Float) return ::Rational::from_double(std::get<double>(data));
+        if (type == Type::Rational) return get<::Rational>();
+        if (type == Type::Int) return ::Rational(as_bigint());
+        if (type == Type::Float) return ::Rational::from_double(get<double>());
         if (type == Type::BigInt) {
-            int int_val = std::get<::BigInt>(data).to_int();
+            int int_val = get<::BigInt>().to_int();
             return ::Rational(int_val);
         }
         if (type == Type::Irrational) {
-            return ::Rational::from_double(std::get<::Irrational>(data).to_double());
+            return ::Rational::from_double(get<::Irrational>().to_double());
         }
         return ::Rational(0);
     }
 
+    // Get numeric value as BigInt, Int is converted exactly and other numbers are truncated
+    ::BigInt as_bigint() const {
+        if (type == Type::BigInt) return get<::BigInt>();
+        if (type == Type::Int) return ::BigInt(payload.i);
+        return ::BigInt(static_cast<int64_t>(as_number()));
+    }
+
     // Get numeric value as Irrational (for exact irrational calculations)
     ::Irrational as_irrational() const {
-        if (type == Type::Irrational) return std::get<::Irrational>(data);
-        if (type == Type::Int) return ::Irrational::constant(std::get<int>(data));
-        if (type == Type::Float) return ::Irrational::constant(std::get<double>(data));
-        if (type == Type::Rational) return ::Irrational::constant(std::get<::Rational>(data).to_double());
+        if (type == Type::Irrational) return get<::Irrational>();
+        if (type == Type::Int) return ::Irrational::constant(static_cast<double>(payload.i));
+        if (type == Type::Float) return ::Irrational::constant(get<double>());
+        if (type == Type::Rational) return ::Irrational::constant(get<::Rational>().to_double());
         if (type == Type::BigInt) {
-            int int_val = std::get<::BigInt>(data).to_int();
+            int int_val = get<::BigInt>().to_int();
             return ::Irrational::constant(int_val);
         }
         return ::Irrational::constant(0);
     }
 	
 	std::shared_ptr<SymbolicExpr> as_symbolic() const {
-		if (type == Type::Infinity) return SymbolicExpr::infinity(std::get<int>(data));
-		if (type == Type::Symbolic) return std::get<std::shared_ptr<SymbolicExpr>>(data);
+		if (type == Type::Infinity) return SymbolicExpr::infinity(get<int>());
+		if (type == Type::Symbolic) return get<std::shared_ptr<SymbolicExpr>>();
 		if (type == Type::Int || type == Type::Float || type == Type::Rational || type == Type::BigInt) {
 			return SymbolicExpr::number(as_rational());
 		}
@@ -194,14 +248,14 @@ public:
     // Get boolean value
     bool as_bool() const {
 		if (type == Type::Infinity) return true;
-        if (type == Type::Bool) return std::get<bool>(data);
-        if (type == Type::Int) return std::get<int>(data) != 0;
-        if (type == Type::Float) return std::get<double>(data) != 0.0;
-        if (type == Type::BigInt) return !std::get<::BigInt>(data).is_zero();
-        if (type == Type::Rational) return !std::get<::Rational>(data).is_zero();
-        if (type == Type::Irrational) return !std::get<::Irrational>(data).is_zero();
-        if (type == Type::String) return !std::get<std::string>(data).empty();
-        if (type == Type::Array) return !std::get<std::vector<Value>>(data).empty();
+        if (type == Type::Bool) return get<bool>();
+        if (type == Type::Int) return payload.i != 0;
+        if (type == Type::Float) return get<double>() != 0.0;
+        if (type == Type::BigInt) return !get<::BigInt>().is_zero();
+        if (type == Type::Rational) return !get<::Rational>().is_zero();
+        if (type == Type::Irrational) return !get<::Irrational>().is_zero();
+        if (type == Type::String) return !get<std::string>().empty();
+        if (type == Type::Array) return !get<std::vector<Value>>().empty();
         return false;
     }
 
@@ -209,15 +263,15 @@ public:
     std::string to_string() const {
         switch (type) {
 			case Type::Infinity:
-				return std::get<int>(data) > 0 ? "inf" : "-inf";
+				return get<int>() > 0 ? "inf" : "-inf";
             case Type::Null:
                 return "null";
             case Type::Bool:
-                return std::get<bool>(data) ? "true" : "false";
+                return get<bool>() ? "true" : "false";
             case Type::Int:
-                return std::to_string(std::get<int>(data));
+                return std::to_string(payload.i);
             case Type::Float: {
-                double val = std::get<double>(data);
+                double val = get<double>();
                 // Remove trailing zeros for cleaner output
                 std::string str = std::to_string(val);
                 str.erase(str.find_last_not_of('0') + 1, std::string::npos);
@@ -225,10 +279,10 @@ public:
                 return str;
             }
             case Type::String:
-                return std::get<std::string>(data);
+                return get<std::string>();
             case Type::Array: {
                 std::string res = "[";
-                const auto& arr = std::get<std::vector<Value>>(data);
+                const auto& arr = get<std::vector<Value>>();
                 for (size_t i = 0; i < arr.size(); ++i) {
                     if (i) res += ", ";
                     res += arr[i].to_string();
@@ -238,13 +292,14 @@ public:
             }
             case Type::Matrix: {
                 std::string res = "[";
-                const auto& mat = std::get<std::vector<std::vector<Value>>>(data);
+                const auto& mat = get<MatrixRows>();
                 for (size_t i = 0; i < mat.size(); ++i) {
                     if (i) res += ", ";
                     res += "[";
-                    for (size_t j = 0; j < mat[i].size(); ++j) {
+                    const auto& row = mat.row(i);
+                    for (size_t j = 0; j < row.size(); ++j) {
                         if (j) res += ", ";
-                        res += mat[i][j].to_string();
+                        res += row[j].to_string();
                     }
                     res += "]";
                 }
@@ -252,19 +307,19 @@ public:
                 return res;
             }
             case Type::BigInt: {
-                return std::get<::BigInt>(data).to_string();
+                return get<::BigInt>().to_string();
             }
             case Type::Rational: {
-                return std::get<::Rational>(data).to_string();
+                return get<::Rational>().to_string();
             }
             case Type::Irrational: {
-                return std::get<::Irrational>(data).to_string();
+                return get<::Irrational>().to_string();
             }
             case Type::Symbolic: {
-                return std::get<std::shared_ptr<SymbolicExpr>>(data)->to_string();
+                return get<std::shared_ptr<SymbolicExpr>>()->to_string();
             }
             case Type::lStruct: {
-                return lStruct_to_string(std::get<std::shared_ptr<lStruct>>(data));
+                return lStruct_to_string(get<std::shared_ptr<lStruct>>());
             }
         }
         return "<unknown>";
@@ -277,8 +332,8 @@ public:
             return Value();
         }
 
-        const auto& a = std::get<std::vector<Value>>(data);
-        const auto& b = std::get<std::vector<Value>>(other.data);
+        const auto& a = get<std::vector<Value>>();
+        const auto& b = other.get<std::vector<Value>>();
 
         if (a.size() != b.size()) {
             std::cerr << "Error: Vector addition requires same dimensions" << std::endl;
@@ -286,15 +341,16 @@ public:
         }
 
         std::vector<Value> result;
+        result.reserve(a.size());
         for (size_t i = 0; i < a.size(); ++i) {
             if (a[i].is_numeric() && b[i].is_numeric()) {
-                result.push_back(Value(a[i].as_number() + b[i].as_number()));
+                result.emplace_back(a[i].as_number() + b[i].as_number());
             } else {
                 std::cerr << "Error: Vector elements must be numeric" << std::endl;
                 return Value();
             }
         }
-        return Value(result);
+        return Value(std::move(result));
     }
 
     Value vector_minus(const Value& other) const {
@@ -303,8 +359,8 @@ public:
             return Value();
         }
 
-        const auto& a = std::get<std::vector<Value>>(data);
-        const auto& b = std::get<std::vector<Value>>(other.data);
+        const auto& a = get<std::vector<Value>>();
+        const auto& b = other.get<std::vector<Value>>();
 
         if (a.size() != b.size()) {
             std::cerr << "Error: Vector minus requires same dimensions" << std::endl;
@@ -312,15 +368,16 @@ public:
         }
 
         std::vector<Value> result;
+        result.reserve(a.size());
         for (size_t i = 0; i < a.size(); ++i) {
             if (a[i].is_numeric() && b[i].is_numeric()) {
-                result.push_back(Value(a[i].as_number() - b[i].as_number()));
+                result.emplace_back(a[i].as_number() - b[i].as_number());
             } else {
                 std::cerr << "Error: Vector elements must be numeric" << std::endl;
                 return Value();
             }
         }
-        return Value(result);
+        return Value(std::move(result));
     }
 
     // Dot product
@@ -330,8 +387,8 @@ public:
             return Value();
         }
 
-        const auto& a = std::get<std::vector<Value>>(data);
-        const auto& b = std::get<std::vector<Value>>(other.data);
+        const auto& a = get<std::vector<Value>>();
+        const auto& b = other.get<std::vector<Value>>();
 
         if (a.size() != b.size()) {
             std::cerr << "Error: Dot product requires same dimensions" << std::endl;
@@ -356,18 +413,19 @@ public:
             return Value();
         }
 
-        const auto& arr = std::get<std::vector<Value>>(data);
+        const auto& arr = get<std::vector<Value>>();
         std::vector<Value> result;
+        result.reserve(arr.size());
 
         for (const auto& elem: arr) {
             if (elem.is_numeric()) {
-                result.push_back(Value(elem.as_number() * scalar));
+                result.emplace_back(elem.as_number() * scalar);
             } else {
                 std::cerr << "Error: Vector elements must be numeric" << std::endl;
                 return Value();
             }
         }
-        return Value(result);
+        return Value(std::move(result));
     }
 
     // Cross product (for 3D vectors)
@@ -377,8 +435,8 @@ public:
             return Value();
         }
 
-        const auto& a = std::get<std::vector<Value>>(data);
-        const auto& b = std::get<std::vector<Value>>(other.data);
+        const auto& a = get<std::vector<Value>>();
+        const auto& b = other.get<std::vector<Value>>();
 
         if (a.size() != 3 || b.size() != 3) {
             std::cerr << "Error: Cross product requires 3D vectors" << std::endl;
@@ -399,7 +457,7 @@ public:
                 Value(a2 * b3 - a3 * b2),
                 Value(a3 * b1 - a1 * b3),
                 Value(a1 * b2 - a2 * b1)};
-        return Value(result);
+        return Value(std::move(result));
     }
 
     // Vector magnitude/norm
@@ -409,7 +467,7 @@ public:
             return Value();
         }
 
-        const auto& arr = std::get<std::vector<Value>>(data);
+        const auto& arr = get<std::vector<Value>>();
         double sum = 0.0;
 
         for (const auto& elem: arr) {
@@ -441,34 +499,37 @@ public:
             return Value();
         }
 
-        const auto& a = std::get<std::vector<std::vector<Value>>>(data);
-        const auto& b = std::get<std::vector<std::vector<Value>>>(other.data);
+        const auto& a = get<MatrixRows>();
+        const auto& b = other.get<MatrixRows>();
 
-        if (a.empty() || b.empty() || a[0].size() != b.size()) {
+        if (a.empty() || b.empty() || a.row(0).size() != b.size()) {
             std::cerr << "Error: Invalid matrix dimensions for multiplication" << std::endl;
             return Value();
         }
 
         size_t rows = a.size();
-        size_t cols = b[0].size();
-        size_t inner = a[0].size();
+        size_t cols = b.row(0).size();
+        size_t inner = a.row(0).size();
 
         std::vector<std::vector<Value>> result(rows, std::vector<Value>(cols, Value(0.0)));
 
         for (size_t i = 0; i < rows; ++i) {
+            const auto& arow = a.row(i);
             for (size_t j = 0; j < cols; ++j) {
                 double sum = 0.0;
                 for (size_t k = 0; k < inner; ++k) {
-                    if (!a[i][k].is_numeric() || !b[k][j].is_numeric()) {
+                    const auto& brow = b.row(k);
+                    if (k >= arow.size() || j >= brow.size() ||
+                        !arow[k].is_numeric() || !brow[j].is_numeric()) {
                         std::cerr << "Error: Matrix elements must be numeric" << std::endl;
                         return Value();
                     }
-                    sum += a[i][k].as_number() * b[k][j].as_number();
+                    sum += arow[k].as_number() * brow[j].as_number();
                 }
                 result[i][j] = Value(sum);
             }
         }
-        return Value(result);
+        return Value(std::move(result));
     }
 
     // Matrix determinant (2x2 and 3x3 only)
@@ -478,7 +539,7 @@ public:
             return Value();
         }
 
-        const auto& mat = std::get<std::vector<std::vector<Value>>>(data);
+        const auto& mat = get<MatrixRows>();
 
         if (mat.size() != mat[0].size()) {
             std::cerr << "Error: Determinant requires a square matrix" << std::endl;
@@ -520,4 +581,137 @@ public:
             return Value();
         }
     }
+
+private:
+    union Payload {
+        bool b;
+        int64_t i;// Int；Infinity 时为符号
+        double f;
+        Box* box;
+    } payload;
+
+    bool is_boxed() const noexcept { return type >= Type::String; }
+    void release() noexcept {
+        if (is_boxed() && --payload.box->refs == 0) delete payload.box;
+    }
+    template<typename T>
+    static Box* make_box(T&& value);
+    // 每个元素都是数组时按矩阵存放
+    static bool is_row_list(const std::vector<Value>& arr);
+    // T 对应的盒装类型
+    template<typename T>
+    static constexpr Type boxed_type();
 };
+
+// 数组按元素连续存放，Value 变大会直接拖慢数组扫描（见 benchmarks/value_bench.cpp）
+static_assert(sizeof(Value) == 16, "Value must stay 16 bytes: type tag plus 8-byte payload");
+
+template<typename T>
+struct Value::BoxOf final : Value::Box {
+    T value;
+    explicit BoxOf(const T& v) : value(v) {}
+    explicit BoxOf(T&& v) : value(std::move(v)) {}
+    Box* clone() const override { return new BoxOf(value); }
+};
+
+template<typename T>
+Value::Box* Value::make_box(T&& value) {
+    return new BoxOf<std::decay_t<T>>(std::forward<T>(value));
+}
+
+template<typename T>
+constexpr Value::Type Value::boxed_type() {
+    if constexpr (std::is_same_v<T, std::string>) return Type::String;
+    else if constexpr (std::is_same_v<T, std::vector<Value>>) return Type::Array;
+    else if constexpr (std::is_same_v<T, MatrixRows>) return Type::Matrix;
+    else if constexpr (std::is_same_v<T, ::BigInt>) return Type::BigInt;
+    else if constexpr (std::is_same_v<T, ::Rational>) return Type::Rational;
+    else if constexpr (std::is_same_v<T, ::Irrational>) return Type::Irrational;
+    else if constexpr (std::is_same_v<T, std::shared_ptr<lStruct>>) return Type::lStruct;
+    else {
+        static_assert(std::is_same_v<T, std::shared_ptr<SymbolicExpr>>, "type is not stored in Value");
+        return Type::Symbolic;
+    }
+}
+
+template<typename T>
+Value::get_result<T> Value::get() const {
+    if constexpr (std::is_same_v<T, int>) {
+        if (type != Type::Int && type != Type::Infinity) throw std::bad_variant_access();
+        if (payload.i > INT_MAX) return INT_MAX;
+        if (payload.i < INT_MIN) return INT_MIN;
+        return static_cast<int>(payload.i);
+    } else if constexpr (std::is_same_v<T, int64_t>) {
+        if (type != Type::Int && type != Type::Infinity) throw std::bad_variant_access();
+        return payload.i;
+    } else if constexpr (std::is_same_v<T, bool>) {
+        if (type != Type::Bool) throw std::bad_variant_access();
+        return payload.b;
+    } else if constexpr (std::is_same_v<T, double>) {
+        if (type != Type::Float) throw std::bad_variant_access();
+        return payload.f;
+    } else {
+        if (type != boxed_type<T>()) throw std::bad_variant_access();
+        return static_cast<const BoxOf<T>*>(payload.box)->value;
+    }
+}
+
+template<typename T>
+T& Value::get_mut() {
+    if constexpr (std::is_same_v<T, int64_t> || std::is_same_v<T, bool> || std::is_same_v<T, double>) {
+        return const_cast<T&>(get<T>());
+    } else {
+        if (type != boxed_type<T>()) throw std::bad_variant_access();
+        if (payload.box->refs > 1) {
+            Box* copy = payload.box->clone();
+            --payload.box->refs;
+            payload.box = copy;
+        }
+        return static_cast<BoxOf<T>*>(payload.box)->value;
+    }
+}
+
+inline bool Value::is_row_list(const std::vector<Value>& arr) {
+    if (arr.empty()) return false;
+    for (const auto& row: arr) {
+        // Mixed types, treat as array
+        if (!row.is_array()) return false;
+    }
+    return true;
+}
+
+inline Value::Value(const std::vector<Value>& arr) {
+    // Check if this is a matrix (array of arrays), rows share the boxes of the source arrays
+    if (is_row_list(arr)) {
+        type = Type::Matrix;
+        payload.box = make_box(MatrixRows{arr});
+    } else {
+        type = Type::Array;
+        payload.box = make_box(arr);
+    }
+}
+
+inline Value::Value(std::vector<Value>&& arr) {
+    if (is_row_list(arr)) {
+        type = Type::Matrix;
+        payload.box = make_box(MatrixRows{std::move(arr)});
+    } else {
+        type = Type::Array;
+        payload.box = make_box(std::move(arr));
+    }
+}
+
+inline Value::Value(const std::vector<std::vector<Value>>& mat) : Value(std::vector<std::vector<Value>>(mat)) {}
+
+inline Value::Value(std::vector<std::vector<Value>>&& mat) : type(Type::Matrix) {
+    MatrixRows matrix;
+    matrix.rows.reserve(mat.size());
+    for (auto& row: mat) {
+        // 直接装箱为数组，不再按数组的数组检测矩阵
+        Value r;
+        r.type = Type::Array;
+        r.payload.box = make_box(std::move(row));
+        matrix.rows.push_back(std::move(r));
+    }
+    payload.box = make_box(std::move(matrix));
+}
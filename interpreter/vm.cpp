@@ -0,0 +1,471 @@
+#include "vm.hpp"
+#include "../extensions/standard/lstruct.hpp"
+#include "bigint.hpp"
+#include "lamina.hpp"
+
+#include <exception>
+#include <iostream>
+
+namespace {
+
+RuntimeError traced_error(const std::string& message, const Interpreter& interpreter) {
+    RuntimeError error(message);
+    error.stack_trace = interpreter.get_stack_trace();
+    return error;
+}
+
+// 复现 ExprStmt 的 catch：StdLibException 继续上抛，其余异常打印后吞掉
+bool report_expr_stmt_error(const std::exception_ptr& error) {
+    try {
+        std::rethrow_exception(error);
+    } catch (const StdLibException&) {
+        return false;
+    } catch (const std::exception& e) {
+        std::cerr << "ERROR: Exception in expression statement: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "ERROR: Unknown exception in expression statement" << std::endl;
+    }
+    return true;
+}
+
+enum class LoopAction { Rethrow, Break, Continue };
+
+// 复现 while 的 catch：循环内的 break/continue 已编译为跳转，这里只处理其他途径抛出的异常
+LoopAction loop_error(std::exception_ptr& error, HandlerKind kind, const Interpreter& interpreter) {
+    const bool is_body = kind == HandlerKind::LoopBody;
+    try {
+        std::rethrow_exception(error);
+    } catch (const BreakException&) {
+        if (is_body) return LoopAction::Break;
+    } catch (const ContinueException&) {
+        if (is_body) return LoopAction::Continue;
+    } catch (const ReturnException&) {
+        if (is_body) return LoopAction::Rethrow;
+    } catch (const std::exception&) {
+    } catch (...) {
+        return LoopAction::Rethrow;
+    }
+    try {
+        std::rethrow_exception(error);
+    } catch (const std::exception& e) {
+        const std::string prefix = is_body ? "Loop body execution error: " : "Loop condition error: ";
+        error = std::make_exception_ptr(traced_error(prefix + e.what(), interpreter));
+    }
+    return LoopAction::Rethrow;
+}
+
+// 在 chunk 中按区间查找处理器，内层在前；外层循环会继续包装内层传出的错误。
+// 找到可恢复的处理器时更新 pc 并返回 true
+bool find_handler(const Chunk& chunk, size_t& pc, std::exception_ptr& error, const Interpreter& interpreter) {
+    const auto at = static_cast<int32_t>(pc - 1);
+    for (const auto& handler: chunk.handlers) {
+        if (at < handler.start || at >= handler.end) continue;
+        if (handler.kind == HandlerKind::ExprStmt) {
+            if (report_expr_stmt_error(error)) {
+                pc = handler.target;
+                return true;
+            }
+        } else {
+            switch (loop_error(error, handler.kind, interpreter)) {
+                case LoopAction::Break:
+                    pc = handler.end;
+                    return true;
+                case LoopAction::Continue:
+                    pc = handler.start;
+                    return true;
+                case LoopAction::Rethrow:
+                    break;
+            }
+        }
+    }
+    return false;
+}
+
+// 异常离开函数 name 时的包装，与树遍历解释器的 eval_CallExpr 一致
+std::exception_ptr function_error(const std::exception_ptr& error, const std::string& name, const Interpreter& interpreter) {
+    try {
+        std::rethrow_exception(error);
+    } catch (RuntimeError& re) {
+        // 就地补全调用栈而不重新抛出副本，深递归出错时逐层返回不再复制整个调用栈
+        if (re.stack_trace.empty()) re.stack_trace = interpreter.get_stack_trace();
+        return error;
+    } catch (const BreakException&) {
+        return std::make_exception_ptr(traced_error("In function '" + name + "': break statement used outside loop", interpreter));
+    } catch (const ContinueException&) {
+        return std::make_exception_ptr(traced_error("In function '" + name + "': continue statement used outside loop", interpreter));
+    } catch (const std::exception& e) {
+        return std::make_exception_ptr(traced_error("In function '" + name + "': " + std::string(e.what()), interpreter));
+    } catch (...) {
+        return error;
+    }
+}
+
+}// namespace
+
+void VM::run(const Chunk& chunk) {
+    execute(chunk);
+}
+
+const CompiledFunction& VM::compiled(const FuncDefStmt* func) {
+    auto it = compiled_functions.find(func);
+    if (it == compiled_functions.end()) {
+        it = compiled_functions.emplace(func, Compiler::compile_function(func)).first;
+    }
+    return it->second;
+}
+
+Value VM::execute(const Chunk& entry) {
+    const size_t entry_depth = activations.size();
+    if (activations.size() == activations.capacity()) ++interpreter.frame_arena.allocations;
+    Activation* act = &activations.emplace_back();
+    act->chunk = &entry;
+    act->base = stack.size();
+    FrameArena& arena = interpreter.frame_arena;
+    act->frame_base = arena.values.size();
+    const Chunk* chunk = act->chunk;
+    size_t frame_base = act->frame_base;
+    size_t pc = 0;
+
+    // 切换到栈顶的 Activation 继续执行
+    auto resume = [&] {
+        act = &activations.back();
+        chunk = act->chunk;
+        frame_base = act->frame_base;
+        pc = act->pc;
+    };
+    // 当前层返回 result；入口层返回时 execute 结束，返回 true
+    Value returned;
+    auto finish = [&](Value result) {
+        stack.resize(act->base);
+        if (activations.size() - 1 == entry_depth) {
+            activations.pop_back();
+            returned = std::move(result);
+            return true;
+        }
+        interpreter.pop_frame();
+        interpreter.pop_scope();
+        activations.pop_back();
+        resume();
+        stack.push_back(std::move(result));
+        return false;
+    };
+
+    while (true) {
+        try {
+            while (true) {
+                const Instruction& ins = chunk->code[pc++];
+                switch (ins.op) {
+                    case OpCode::Const:
+                        stack.push_back(chunk->constants[ins.a]);
+                        break;
+                    case OpCode::LoadLocal:
+                        if (arena.assigned[frame_base + ins.a]) {
+                            stack.push_back(arena.values[frame_base + ins.a]);
+                        } else {
+                            stack.push_back(interpreter.get_variable(chunk->names[ins.b]));
+                        }
+                        break;
+                    case OpCode::StoreLocal:
+                        arena.values[frame_base + ins.a] = std::move(stack.back());
+                        arena.assigned[frame_base + ins.a] = 1;
+                        stack.pop_back();
+                        break;
+                    case OpCode::LoadGlobal:
+                        // 与 Interpreter::load_variable 一致：可能被外层帧遮蔽的名字按名查找
+                        if ((interpreter.frames.size() <= 1 || !interpreter.globals.shadowed[ins.a]) && interpreter.globals.defined[ins.a]) {
+                            stack.push_back(interpreter.globals.values[ins.a]);
+                        } else {
+                            stack.push_back(interpreter.get_variable(chunk->names[ins.b]));
+                        }
+                        break;
+                    case OpCode::StoreGlobal:
+                        interpreter.globals.set(ins.a, std::move(stack.back()));
+                        stack.pop_back();
+                        break;
+                    case OpCode::AppendLocal:
+                    case OpCode::AppendGlobal: {
+                        const size_t first = stack.size() - ins.b;
+                        Value l = std::move(stack[first - 1]);
+                        const bool local = ins.op == OpCode::AppendLocal;
+                        const size_t i = local ? frame_base + ins.a : ins.a;
+                        Value* slot = nullptr;
+                        if (local ? arena.assigned[i] : interpreter.globals.defined[i]) {
+                            slot = local ? &arena.values[i] : &interpreter.globals.values[i];
+                        }
+                        // 槽位仍持有同一个字符串或 BigInt 时交还 l 的引用，让槽位独占缓冲区后原地累加
+                        if (slot && (l.is_string() || l.is_bigint()) && slot->shares_payload(l)) {
+                            l = Value();
+                            for (size_t k = first; k < stack.size(); ++k) {
+                                if (!Interpreter::apply_in_place(BinaryOp::Add, *slot, stack[k])) *slot = interpreter.apply_binary(BinaryOp::Add, *slot, stack[k]);
+                            }
+                        } else {
+                            for (size_t k = first; k < stack.size(); ++k) {
+                                if (!Interpreter::apply_in_place(BinaryOp::Add, l, stack[k])) l = interpreter.apply_binary(BinaryOp::Add, l, stack[k]);
+                            }
+                            if (local) {
+                                arena.values[i] = std::move(l);
+                                arena.assigned[i] = 1;
+                            } else {
+                                interpreter.globals.set(ins.a, std::move(l));
+                            }
+                        }
+                        stack.resize(first - 1);
+                        break;
+                    }
+                    case OpCode::Pop:
+                        stack.pop_back();
+                        break;
+                    case OpCode::Add:
+                    case OpCode::Sub:
+                    case OpCode::Mul:
+                    case OpCode::Div:
+                    case OpCode::Mod:
+                    case OpCode::Pow:
+                    case OpCode::Eq:
+                    case OpCode::Ne:
+                    case OpCode::Lt:
+                    case OpCode::Le:
+                    case OpCode::Gt:
+                    case OpCode::Ge: {
+                        Value r = std::move(stack.back());
+                        stack.pop_back();
+                        Value& l = stack.back();
+                        // OpCode::Add ... OpCode::Ge 与 BinaryOp 顺序一致
+                        const auto op = static_cast<BinaryOp>(static_cast<int>(ins.op) - static_cast<int>(OpCode::Add));
+                        if (Interpreter::apply_in_place(op, l, r)) break;
+                        l = interpreter.apply_binary(op, l, r);
+                        break;
+                    }
+                    case OpCode::Neg:
+                        stack.back() = interpreter.apply_unary(UnaryOp::Neg, std::move(stack.back()));
+                        break;
+                    case OpCode::Fact:
+                        stack.back() = interpreter.apply_unary(UnaryOp::Fact, std::move(stack.back()));
+                        break;
+                    case OpCode::BuildArray: {
+                        std::vector<Value> elements(std::make_move_iterator(stack.end() - ins.a),
+                                                    std::make_move_iterator(stack.end()));
+                        stack.resize(stack.size() - ins.a);
+                        stack.emplace_back(std::move(elements));
+                        break;
+                    }
+                    case OpCode::BuildStruct: {
+                        std::vector<std::pair<std::string, Value>> struct_init_val;
+                        const size_t first = stack.size() - ins.a;
+                        for (int32_t i = 0; i < ins.a; ++i) {
+                            struct_init_val.emplace_back(chunk->names[ins.b + i], std::move(stack[first + i]));
+                        }
+                        stack.resize(first);
+                        stack.push_back(new_lstruct(struct_init_val));
+                        break;
+                    }
+                    case OpCode::ToBigInt: {
+                        Value& val = stack.back();
+                        const std::string& name = chunk->names[ins.a];
+                        if (val.is_bigint()) {
+                            // 已经是BigInt，直接使用
+                        } else if (val.is_int()) {
+                            val = Value(::BigInt(val.get<int64_t>()));
+                        } else if (val.is_string()) {
+                            try {
+                                val = Value(::BigInt(val.get<std::string>()));
+                            } catch (const std::exception&) {
+                                error_and_exit("Invalid BigInt string '" + val.get<std::string>() + "' in declaration of " + name);
+                            }
+                        } else {
+                            error_and_exit("Cannot convert " + val.to_string() + " to BigInt in declaration of " + name);
+                        }
+                        break;
+                    }
+                    case OpCode::Jump:
+                        pc = ins.a;
+                        break;
+                    case OpCode::JumpIfFalse: {
+                        bool cond = stack.back().as_bool();
+                        stack.pop_back();
+                        if (!cond) pc = ins.a;
+                        break;
+                    }
+                    case OpCode::Call:
+                    case OpCode::TailCall: {
+                        const CallSite& site = chunk->calls[ins.a];
+                        const CallCache target = resolve(*chunk, site, frame_base);
+                        if (target.target == CallCache::Target::Function && target.func) {
+                            const CompiledFunction& fn = compiled(target.func);
+                            if (ins.op == OpCode::TailCall && !interpreter.locals_read_by_name(interpreter.frames.back().func)) {
+                                // 尾调用：当前帧直接换成被调函数的帧；帧内局部变量可能被按名读到时按普通调用执行
+                                interpreter.pop_frame();
+                                interpreter.pop_scope();
+                            } else {
+                                if (activations.size() - entry_depth > max_call_depth) {
+                                    throw traced_error("Maximum recursion depth exceeded (" + std::to_string(max_call_depth) + ")", interpreter);
+                                }
+                                act->pc = pc;
+                                if (activations.size() == activations.capacity()) ++arena.allocations;
+                                act = &activations.emplace_back();
+                            }
+                            interpreter.push_frame(target.name_id, SymbolTable::script_id, static_cast<int>(site.line));
+                            bind_call(*act, target.name_id, fn, target.func, site.argc);
+                            // 同步 Interpreter::frames，被调函数可按名读到调用者的局部变量（动态作用域）
+                            interpreter.push_scope(target.func, act->frame_base);
+                            resume();
+                            break;
+                        }
+                        Value result = call_native(target, site);
+                        if (ins.op == OpCode::TailCall) {
+                            if (finish(std::move(result))) return returned;
+                        } else {
+                            stack.push_back(std::move(result));
+                        }
+                        break;
+                    }
+                    case OpCode::DefFunc: {
+                        const FuncDefStmt* func = chunk->functions[ins.a];
+                        interpreter.add_function(func->name, func);
+                        break;
+                    }
+                    case OpCode::Include: {
+                        const std::string& module = chunk->names[ins.a];
+                        if (!interpreter.load_module(module)) {
+                            error_and_exit("Failed to include module '" + module + "'");
+                        }
+                        break;
+                    }
+                    case OpCode::Return: {
+                        if (finish(std::move(stack.back()))) return returned;
+                        break;
+                    }
+                    case OpCode::ReturnNull:
+                        if (finish(Value())) return returned;
+                        break;
+                    case OpCode::ThrowReturn: {
+                        Value result = std::move(stack.back());
+                        stack.pop_back();
+                        throw ReturnException(result);
+                    }
+                    case OpCode::ThrowBreak:
+                        throw BreakException();
+                    case OpCode::ThrowContinue:
+                        throw ContinueException();
+                    default:
+                        throw traced_error("Unknown opcode in VM", interpreter);
+                }
+            }
+        } catch (...) {
+            // 先在当前层找处理器，找不到就带着包装后的错误退回调用者那一层
+            std::exception_ptr error = std::current_exception();
+            while (true) {
+                const bool resumed = find_handler(*chunk, pc, error, interpreter);
+                // 处理器都位于语句边界，此时操作数栈应回到本层起点
+                stack.resize(act->base);
+                if (resumed) break;
+                if (activations.size() - 1 == entry_depth) {
+                    activations.pop_back();
+                    std::rethrow_exception(error);
+                }
+                error = function_error(error, interpreter.symbol_name(act->name_id), interpreter);
+                interpreter.pop_frame();
+                interpreter.pop_scope();
+                activations.pop_back();
+                resume();
+            }
+        }
+    }
+}
+
+CallCache VM::resolve(const Chunk& chunk, const CallSite& site, size_t frame_base) {
+    const std::string& callee = chunk.names[site.name];
+    CallCache target = interpreter.resolve_callee(callee, site.cache);
+
+    // 调用名是否绑定到函数值（例如函数作为参数传入）
+    const Value* bound = nullptr;
+    const FrameArena& arena = interpreter.frame_arena;
+    if (site.slot >= 0 && arena.assigned[frame_base + site.slot]) {
+        bound = &arena.values[frame_base + site.slot];
+    } else if (target.may_be_variable) {
+        bound = interpreter.find_variable(callee);
+    }
+    if (bound && bound->is_string()) {
+        const auto& s = bound->get<std::string>();
+        if (s.compare(0, 11, "__function_") == 0) {
+            CallCache indirect;
+            target = interpreter.resolve_callee(s.substr(11), indirect);
+        }
+    }
+    return target;
+}
+
+Value VM::call_native(const CallCache& target, const CallSite& site) {
+    const size_t argc = static_cast<size_t>(site.argc);
+    const size_t first = stack.size() - argc;
+    const std::string& actual_callee = interpreter.symbol_name(target.name_id);
+
+    if (target.target == CallCache::Target::Builtin) {
+        interpreter.push_frame(target.name_id, SymbolTable::builtin_id, static_cast<int>(site.line));
+        Value result;
+        try {
+            FrameArena::Args args(interpreter.frame_arena, argc);
+            args->assign(std::make_move_iterator(stack.begin() + first), std::make_move_iterator(stack.end()));
+            stack.resize(first);
+            result = (*target.builtin)(*args);
+        } catch (...) {
+            interpreter.pop_frame();
+            throw;
+        }
+        interpreter.pop_frame();
+        return result;
+    }
+
+    if (target.target == CallCache::Target::Function) {
+        stack.resize(first);
+        std::cerr << "Error: Function object for '" << actual_callee << "' is null" << std::endl;
+        return Value("<func error>");
+    }
+
+    if (target.target == CallCache::Target::Module) {
+        FrameArena::Args args(interpreter.frame_arena, argc);
+        args->assign(std::make_move_iterator(stack.begin() + first), std::make_move_iterator(stack.end()));
+        stack.resize(first);
+        Value result = interpreter.call_module_function(actual_callee, *args);
+        if (result.to_string() != "null") {
+            return result;
+        }
+    } else {
+        stack.resize(first);
+    }
+
+    std::cerr << "Error: Call to undefined function '" << actual_callee << "'" << std::endl;
+    return Value("<undefined function>");
+}
+
+void VM::bind_call(Activation& activation, uint32_t name_id, const CompiledFunction& fn, const FuncDefStmt* func, size_t argc) {
+    const size_t first = stack.size() - argc;
+    const std::string& name = interpreter.symbol_name(name_id);
+    const size_t param_count = fn.param_slots.size();
+    if (argc > param_count) {
+        Interpreter::print_warning("Too many arguments provided to function '" + name +
+                                           "'. Expected " + std::to_string(param_count) +
+                                           ", got " + std::to_string(argc),
+                                   true);
+    }
+
+    FrameArena& arena = interpreter.frame_arena;
+    const size_t frame_base = arena.allocate(fn.slot_count);
+    for (size_t j = 0; j < param_count; ++j) {
+        const size_t slot = frame_base + fn.param_slots[j];
+        if (j < argc) {
+            arena.values[slot] = std::move(stack[first + j]);
+        } else {
+            Interpreter::print_warning("Missing argument '" + func->params[j] + "' in call to function '" + name + "'", true);
+            arena.values[slot] = Value("<undefined>");
+        }
+        arena.assigned[slot] = 1;
+    }
+    stack.resize(first);
+
+    activation.chunk = &fn.chunk;
+    activation.pc = 0;
+    activation.base = first;
+    activation.frame_base = frame_base;
+    activation.name_id = name_id;
+}
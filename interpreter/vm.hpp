@@ -0,0 +1,63 @@
+#pragma once
+#include "bytecode.hpp"
+#include "interpreter.hpp"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#ifdef LAMINA_CORE_EXPORTS
+#define LAMINA_API __declspec(dllexport)
+#else
+#define LAMINA_API __declspec(dllimport)
+#endif
+#else
+#define LAMINA_API
+#endif
+
+/*
+    栈式虚拟机：执行 Compiler 产出的字节码。
+    运算、内置函数、模块加载等仍复用 Interpreter，保证与树遍历解释器的 Value 语义一致；
+    变量按 Resolver 的绑定访问函数帧槽位或全局变量表；
+    调用时同步压入 Interpreter::frames，本帧之外的名字与树遍历解释器一样沿调用链按名查找
+ */
+class LAMINA_API VM {
+public:
+    explicit VM(Interpreter& interpreter) : interpreter(interpreter) {}
+
+    // 执行一段顶层字节码（对应一条顶层语句）
+    void run(const Chunk& chunk);
+
+    // 用户函数调用深度上限；调用帧分配在堆上，不占用原生栈，10^6 层约 120 MB。
+    // 树遍历解释器与闭包层的上限较低，见 Interpreter::max_recursion_depth
+    static constexpr size_t max_call_depth = 2000000;
+
+private:
+    // 一层调用的执行状态：用户函数调用只压入 Activation，不递归进入 execute
+    struct Activation {
+        const Chunk* chunk = nullptr;
+        size_t pc = 0;
+        // 本层在操作数栈上的起点
+        size_t base = 0;
+        // 局部变量在 Interpreter::frame_arena 中的起点
+        size_t frame_base = 0;
+        // 函数名在 Interpreter 符号表中的 ID
+        uint32_t name_id = 0;
+    };
+
+    Interpreter& interpreter;
+    std::vector<Value> stack;
+    // 只增不缩，弹出后的容量留给后续调用复用
+    std::vector<Activation> activations;
+    // FuncDefStmt 由 Interpreter 持有的 AST 保证存活，按指针缓存编译结果
+    std::unordered_map<const FuncDefStmt*, CompiledFunction> compiled_functions;
+
+    Value execute(const Chunk& chunk);
+    // 解析调用点的实际目标（含 "__function_" 间接调用）
+    CallCache resolve(const Chunk& chunk, const CallSite& site, size_t frame_base);
+    // 调用内置函数或模块函数，实参从操作数栈弹出
+    Value call_native(const CallCache& target, const CallSite& site);
+    // 在 frame_arena 中分配 fn 的局部变量，绑定栈顶 argc 个实参，并让 activation 从 fn 的开头执行
+    void bind_call(Activation& activation, uint32_t name_id, const CompiledFunction& fn, const FuncDefStmt* func, size_t argc);
+    const CompiledFunction& compiled(const FuncDefStmt* func);
+};
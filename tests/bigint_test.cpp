@@ -0,0 +1,150 @@
+/*
+    BigInt 乘除法的回归测试：在各算法的切换阈值两侧取随机操作数与全 1 操作数，
+    乘法与逐位相乘的参考实现比较；除法检查 |a| = |q|·|b| + |r|、|r| < |b| 及符号，并与 Knuth 算法 D 的结果比较。
+    ctest 分别以默认线程数和 LAMINA_THREADS=1 运行，两次都与同一参考实现比较。
+    用法：bigint_test，全部通过时返回 0
+ */
+#include "bigint.hpp"
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using limb = BigInt::limb;
+using limbs = std::vector<limb>;
+
+// 除数与商都达到该 limb 数时走牛顿法除法，与 BigInt::newton_threshold 一致
+constexpr size_t newton_threshold = 400;
+
+int failures = 0;
+std::mt19937_64 rng(20240611);
+
+void check(bool ok, const std::string& what) {
+    if (!ok) {
+        std::printf("FAIL: %s\n", what.c_str());
+        ++failures;
+    }
+}
+
+void trim(limbs& v) {
+    while (!v.empty() && v.back() == 0) v.pop_back();
+}
+
+// n 个 limb 的操作数，最高 limb 非零；all_ones 时每个 limb 都取最大值，进位最多
+BigInt operand(size_t n, bool all_ones, bool negative) {
+    BigInt x;
+    x.limbs.resize(n);
+    for (limb& l: x.limbs) l = all_ones ? ~limb{0} : rng();
+    if (x.limbs.back() == 0) x.limbs.back() = 1;
+    x.negative = negative;
+    return x;
+}
+
+// 参考实现：逐位相乘
+limbs ref_mul(const limbs& a, const limbs& b) {
+    limbs r(a.size() + b.size(), 0);
+    for (size_t i = 0; i < a.size(); ++i) {
+        limb carry = 0;
+        for (size_t j = 0; j < b.size(); ++j) {
+            limb hi;
+            limb lo = bigint_detail::mul_wide(a[i], b[j], hi);
+            lo += carry;
+            hi += lo < carry;
+            lo += r[i + j];
+            hi += lo < r[i + j];
+            r[i + j] = lo;
+            carry = hi;
+        }
+        r[i + b.size()] = carry;
+    }
+    trim(r);
+    return r;
+}
+
+limbs ref_add(limbs a, const limbs& b) {
+    if (a.size() < b.size()) a.resize(b.size(), 0);
+    limb carry = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        const limb x = i < b.size() ? b[i] : 0;
+        a[i] = bigint_detail::add_carry(a[i], x, carry);
+    }
+    if (carry) a.push_back(carry);
+    return a;
+}
+
+std::string describe(const char* what, size_t an, size_t bn, bool all_ones) {
+    return std::string(what) + " " + std::to_string(an) + "x" + std::to_string(bn) + (all_ones ? " (all ones)" : "");
+}
+
+void check_mul(size_t an, size_t bn, bool all_ones) {
+    const BigInt a = operand(an, all_ones, rng() & 1);
+    const BigInt b = operand(bn, all_ones, rng() & 1);
+    const BigInt p = a * b;
+    check(p.limbs == ref_mul(a.limbs, b.limbs) && p.negative == (a.negative != b.negative),
+          describe("mul", an, bn, all_ones));
+
+    // 自乘走同一个入口，但两个操作数是同一块内存
+    BigInt s = a;
+    s *= s;
+    check(s.limbs == ref_mul(a.limbs, a.limbs) && !s.negative, describe("square", an, an, all_ones));
+}
+
+void check_divmod(size_t an, size_t bn, bool all_ones) {
+    const BigInt a = operand(an, all_ones, rng() & 1);
+    BigInt b = operand(bn, false, rng() & 1);
+    // 全 1 的被除数配上最高 limb 很小的除数，规范化移位最大
+    if (all_ones) b.limbs.back() = 1;
+
+    BigInt q, r;
+    BigInt::divmod(a, b, q, r);
+    const std::string what = describe("divmod", an, bn, all_ones);
+
+    check(ref_add(ref_mul(q.limbs, b.limbs), r.limbs) == a.limbs, what + ": |a| = |q||b| + |r|");
+    check(BigInt::abs_compare(r, b) < 0, what + ": |r| < |b|");
+    check(q.limbs.empty() || q.negative == (a.negative != b.negative), what + ": sign of q");
+    check(r.limbs.empty() || r.negative == a.negative, what + ": sign of r");
+    check(a / b == q && a % b == r, what + ": / and % agree with divmod");
+
+    limbs kq(an - bn + 1), kr(bn);
+    bigint_detail::divmod_knuth(kq.data(), kr.data(), a.limbs.data(), an, b.limbs.data(), bn);
+    trim(kq);
+    trim(kr);
+    check(q.limbs == kq && r.limbs == kr, what + ": same as Knuth algorithm D");
+}
+
+}// namespace
+
+int main() {
+    std::printf("threads: %zu\n", bigint_detail::TaskPool::instance().threads());
+
+    // 逐位相乘 / Karatsuba / Toom-3 / 并行递归 / NTT 的切换点
+    for (size_t t: {bigint_detail::karatsuba_threshold, bigint_detail::toom3_threshold,
+                    bigint_detail::parallel_mul_threshold, bigint_detail::ntt_threshold}) {
+        for (size_t n: {t - 1, t, t + 1}) {
+            for (bool all_ones: {false, true}) {
+                check_mul(n, n, all_ones);
+                check_mul(3 * n + 5, n, all_ones);
+            }
+        }
+    }
+
+    // Knuth 算法 D 与牛顿法除法的切换点：除数与商的长度分别落在阈值两侧
+    for (size_t bn: {newton_threshold - 1, newton_threshold, newton_threshold + 1}) {
+        for (size_t qn: {newton_threshold - 1, newton_threshold, newton_threshold + 1}) {
+            check_divmod(bn + qn, bn, false);
+        }
+        check_divmod(bn + newton_threshold, bn, true);
+    }
+    check_divmod(2600, 1000, false);
+    check_divmod(2600, 1000, true);
+    check_divmod(50, 2, false);
+
+    if (failures) {
+        std::printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,228 @@
+/*
+    解析缓存的回归测试：把 .lmc 文件截断、逐字节改写或嵌套过深之后再加载，
+    ModuleCache::parse 必须回退到重新解析，得到与原始解析相同的 AST，且不能崩溃。
+    用法：module_cache_test [临时目录]，全部通过时返回 0
+ */
+#include "module_cache.hpp"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const std::string& what) {
+    if (!ok) {
+        std::printf("FAIL: %s\n", what.c_str());
+        ++failures;
+    }
+}
+
+// 把 AST 展开成文本，用于比较两次解析的结果
+void dump(const ASTNode* n, std::ostream& out) {
+    if (!n) {
+        out << "_ ";
+        return;
+    }
+    out << '(' << static_cast<int>(n->kind) << ' ';
+    if (n->kind <= NodeKind::ArrayExpr) {
+        const SourceSpan& span = static_cast<const Expression*>(n)->span;
+        out << span.offset << ':' << span.length << ':' << span.line << ' ';
+    }
+    auto list = [&](const auto& nodes) {
+        out << nodes.size() << ' ';
+        for (const auto& child: nodes) dump(child.get(), out);
+    };
+    switch (n->kind) {
+        case NodeKind::LiteralExpr: {
+            auto* lit = static_cast<const LiteralExpr*>(n);
+            out << static_cast<int>(lit->type) << ' ' << lit->value;
+            break;
+        }
+        case NodeKind::IdentifierExpr:
+            out << static_cast<const IdentifierExpr*>(n)->name;
+            break;
+        case NodeKind::VarExpr:
+            out << static_cast<const VarExpr*>(n)->name;
+            break;
+        case NodeKind::BinaryExpr: {
+            auto* bin = static_cast<const BinaryExpr*>(n);
+            out << static_cast<int>(bin->op) << ' ';
+            dump(bin->left.get(), out);
+            dump(bin->right.get(), out);
+            break;
+        }
+        case NodeKind::UnaryExpr: {
+            auto* unary = static_cast<const UnaryExpr*>(n);
+            out << static_cast<int>(unary->op) << ' ';
+            dump(unary->operand.get(), out);
+            break;
+        }
+        case NodeKind::CallExpr: {
+            auto* call = static_cast<const CallExpr*>(n);
+            out << call->callee << ' ';
+            list(call->args);
+            break;
+        }
+        case NodeKind::NamespaceCallExpr: {
+            auto* call = static_cast<const NamespaceCallExpr*>(n);
+            out << call->namespace_name << "::" << call->function_name << ' ';
+            list(call->args);
+            break;
+        }
+        case NodeKind::ArrayExpr:
+            list(static_cast<const ArrayExpr*>(n)->elements);
+            break;
+        case NodeKind::VarDeclStmt: {
+            auto* v = static_cast<const VarDeclStmt*>(n);
+            out << v->name << ' ';
+            dump(v->expr.get(), out);
+            break;
+        }
+        case NodeKind::AssignStmt: {
+            auto* a = static_cast<const AssignStmt*>(n);
+            out << a->name << ' ';
+            dump(a->expr.get(), out);
+            break;
+        }
+        case NodeKind::BlockStmt:
+            list(static_cast<const BlockStmt*>(n)->statements);
+            break;
+        case NodeKind::IfStmt: {
+            auto* ifs = static_cast<const IfStmt*>(n);
+            dump(ifs->condition.get(), out);
+            dump(ifs->thenBlock.get(), out);
+            dump(ifs->elseBlock.get(), out);
+            break;
+        }
+        case NodeKind::WhileStmt: {
+            auto* ws = static_cast<const WhileStmt*>(n);
+            dump(ws->condition.get(), out);
+            dump(ws->body.get(), out);
+            break;
+        }
+        case NodeKind::FuncDefStmt: {
+            auto* func = static_cast<const FuncDefStmt*>(n);
+            out << func->name << ' ';
+            for (const auto& p: func->params) out << p << ',';
+            dump(func->body.get(), out);
+            break;
+        }
+        case NodeKind::ReturnStmt:
+            dump(static_cast<const ReturnStmt*>(n)->expr.get(), out);
+            break;
+        case NodeKind::IncludeStmt:
+            out << static_cast<const IncludeStmt*>(n)->module;
+            break;
+        case NodeKind::NullStmt:
+        case NodeKind::BreakStmt:
+        case NodeKind::ContinueStmt:
+            break;
+        case NodeKind::ExprStmt:
+            dump(static_cast<const ExprStmt*>(n)->expr.get(), out);
+            break;
+        case NodeKind::StructDeclStmt: {
+            auto* s = static_cast<const StructDeclStmt*>(n);
+            out << s->name << ' ';
+            for (const auto& [name, expr]: s->init_vec) {
+                out << name << '=';
+                dump(expr.get(), out);
+            }
+            break;
+        }
+        case NodeKind::DefineStmt: {
+            auto* d = static_cast<const DefineStmt*>(n);
+            out << d->name << ' ';
+            dump(d->value.get(), out);
+            break;
+        }
+        case NodeKind::BigIntDeclStmt: {
+            auto* bi = static_cast<const BigIntDeclStmt*>(n);
+            out << bi->name << ' ';
+            dump(bi->init_value.get(), out);
+            break;
+        }
+    }
+    out << ") ";
+}
+
+std::string parse_and_dump(const std::string& path) {
+    SyntaxTree tree = ModuleCache::parse(path, std::make_shared<MappedFile>(path));
+    if (!tree.root) return "<null>";
+    std::ostringstream out;
+    dump(tree.root.get(), out);
+    return out.str();
+}
+
+std::string read_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+void write_file(const std::string& path, const std::string& data) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+// 先解析一次生成缓存，再逐一写入损坏的缓存，每次都应得到原来的 AST
+void check_corruptions(const std::string& path, const std::string& source) {
+    write_file(path, source);
+    const std::string cache = ModuleCache::cache_path(path);
+    std::filesystem::remove(cache);
+    const std::string expected = parse_and_dump(path);
+    check(expected != "<null>", path + ": source does not parse");
+    const std::string good = read_file(cache);
+    check(!good.empty(), path + ": no cache written");
+    check(parse_and_dump(path) == expected, path + ": cache hit differs from parse");
+
+    for (size_t len = 0; len < good.size(); ++len) {
+        write_file(cache, good.substr(0, len));
+        check(parse_and_dump(path) == expected, path + ": truncated to " + std::to_string(len));
+    }
+    for (size_t i = 0; i < good.size(); ++i) {
+        for (unsigned char mask: {0x01, 0x80, 0xFF}) {
+            std::string bad = good;
+            bad[i] = static_cast<char>(static_cast<unsigned char>(bad[i]) ^ mask);
+            write_file(cache, bad);
+            check(parse_and_dump(path) == expected, path + ": byte " + std::to_string(i) + " corrupted");
+        }
+    }
+    write_file(cache, good + std::string(16, '\xFF'));
+    check(parse_and_dump(path) == expected, path + ": trailing garbage");
+}
+
+}// namespace
+
+int main(int argc, char** argv) {
+    const std::filesystem::path dir = argc > 1 ? std::filesystem::path(argv[1])
+                                               : std::filesystem::temp_directory_path() / "lamina_cache_test";
+    std::filesystem::create_directories(dir);
+
+    check_corruptions((dir / "basic.lm").string(),
+                      "var a = [1, 2, 3];\n"
+                      "func f(x, y) {\n"
+                      "    if (x < y) { return -x; } else { return x! + y ^ 2; }\n"
+                      "}\n"
+                      "var i = 0;\n"
+                      "while (i != 3) { i = i + 1; if (i == 2) { continue; } print(f(i, 2)); }\n"
+                      "print(\"done\", a);\n");
+
+    // 嵌套超过读取上限的树：缓存可以写出，但读取时必须拒绝并重新解析
+    std::string deep = "var x = 1";
+    for (int i = 0; i < 6000; ++i) deep += " + 1";
+    deep += ";\nprint(x);\n";
+    const std::string deep_path = (dir / "deep.lm").string();
+    write_file(deep_path, deep);
+    std::filesystem::remove(ModuleCache::cache_path(deep_path));
+    const std::string expected = parse_and_dump(deep_path);
+    check(expected != "<null>", "deep.lm: source does not parse");
+    check(parse_and_dump(deep_path) == expected, "deep.lm: reload differs from parse");
+
+    std::filesystem::remove_all(dir);
+    if (failures == 0) std::printf("module cache test passed\n");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,32 @@
+# 用指定引擎运行一个 .lm 脚本，把标准输出（及可选的标准错误输出）与期望文件比较
+# cmake -DLAMINA=<解释器> -DENGINE=ast|closure|vm -DSCRIPT=<脚本> -DEXPECTED=<期望输出> -P run_script.cmake
+set(ENV{LAMINA_NO_CACHE} 1)
+execute_process(
+    COMMAND ${LAMINA} --engine=${ENGINE} ${SCRIPT}
+    OUTPUT_VARIABLE output
+    ERROR_VARIABLE errors
+    RESULT_VARIABLE result
+)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "${SCRIPT} (${ENGINE}) exited with ${result}\n${errors}")
+endif()
+
+# 去掉随路径变化的首行 "Executing file: ..."
+string(REGEX REPLACE "^Executing file: [^\n]*\n" "" output "${output}")
+string(REPLACE "\r\n" "\n" output "${output}")
+file(READ ${EXPECTED} expected)
+string(REPLACE "\r\n" "\n" expected "${expected}")
+if(NOT output STREQUAL expected)
+    message(FATAL_ERROR "${SCRIPT} (${ENGINE}) output differs\n--- expected\n${expected}--- actual\n${output}--- stderr\n${errors}")
+endif()
+
+# 同名 .stderr 文件存在时，标准错误输出（如错误回溯）也须一致
+string(REGEX REPLACE "\\.expected$" ".stderr" expected_stderr_file "${EXPECTED}")
+if(EXISTS ${expected_stderr_file})
+    string(REPLACE "\r\n" "\n" errors "${errors}")
+    file(READ ${expected_stderr_file} expected_stderr)
+    string(REPLACE "\r\n" "\n" expected_stderr "${expected_stderr}")
+    if(NOT errors STREQUAL expected_stderr)
+        message(FATAL_ERROR "${SCRIPT} (${ENGINE}) stderr differs\n--- expected\n${expected_stderr}--- actual\n${errors}")
+    endif()
+endif()
@@ -35,6 +35,8 @@ target("lamina_core")
     )
     if is_plat("windows") then
         add_links("imagehlp")
+    elseif is_plat("linux") then
+        add_syslinks("pthread", {public = true})
     end
     add_rules("utils.symbols.export_all")
     set_configdir("interpreter")
@@ -58,3 +60,57 @@ target("lamina")
         "interpreter/console_ui.cpp"
     )
     add_includedirs("interpreter")
+
+target("bigint_bench")
+    set_kind("binary")
+    set_default(false)
+    set_languages("c++20")
+    add_files("benchmarks/bigint_bench.cpp")
+    add_includedirs("interpreter", "benchmarks")
+    if is_plat("linux") then
+        add_syslinks("pthread")
+    end
+
+target("dispatch_bench")
+    set_kind("binary")
+    set_default(false)
+    set_languages("c++20")
+    add_deps("lamina_core")
+    add_files("benchmarks/dispatch_bench.cpp")
+    add_includedirs("interpreter")
+
+target("value_bench")
+    set_kind("binary")
+    set_default(false)
+    set_languages("c++20")
+    add_deps("lamina_core")
+    add_files("benchmarks/value_bench.cpp")
+    add_includedirs("interpreter", "benchmarks")
+
+target("lexer_bench")
+    set_kind("binary")
+    set_default(false)
+    set_languages("c++20")
+    add_deps("lamina_core")
+    add_files("benchmarks/lexer_bench.cpp")
+    add_includedirs("interpreter")
+
+-- 解析缓存的回归测试：xmake build module_cache_test && xmake run module_cache_test
+target("module_cache_test")
+    set_kind("binary")
+    set_default(false)
+    set_languages("c++20")
+    add_deps("lamina_core")
+    add_files("tests/module_cache_test.cpp")
+    add_includedirs("interpreter")
+
+-- 大数乘除法的回归测试：xmake build bigint_test && xmake run bigint_test
+target("bigint_test")
+    set_kind("binary")
+    set_default(false)
+    set_languages("c++20")
+    add_files("tests/bigint_test.cpp")
+    add_includedirs("interpreter")
+    if is_plat("linux") then
+        add_syslinks("pthread")
+    end